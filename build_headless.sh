@@ -0,0 +1,25 @@
+#!/bin/sh
+
+# Builds the headless frame benchmark (code/posix_textit.cpp) for POSIX systems.
+# Usage: ./build_headless.sh [release|debug|sanitize]
+
+CXX=${CXX:-clang++}
+
+SHARED_FLAGS="-std=c++17 -g -fno-rtti -fno-exceptions -ffast-math -Iexternal -D_CRT_SECURE_NO_WARNINGS"
+LLVM_FLAGS="-Wno-missing-field-initializers -Wno-unused-variable -Wno-unused-function -Wno-deprecated-declarations -Wno-writable-strings -Wno-write-strings -Wno-missing-braces -Wno-char-subscripts -Wno-invalid-offsetof -Wno-unknown-warning-option -DCOMPILER_LLVM=1 -maes -msse4.2"
+SANITIZE_FLAGS="-O0 -DTEXTIT_INTERNAL=1 -DTEXTIT_SLOW=1 -fsanitize=address"
+DEBUG_FLAGS="-O0 -DTEXTIT_INTERNAL=1 -DTEXTIT_SLOW=1"
+RELEASE_FLAGS="-O2 -DTEXTIT_INTERNAL=0 -DTEXTIT_SLOW=0"
+LINKER_LIBRARIES="-lpthread"
+
+case "$1" in
+    debug)    FLAGS="$SHARED_FLAGS $DEBUG_FLAGS";    NAME=textit_headless_debug ;;
+    sanitize) FLAGS="$SHARED_FLAGS $SANITIZE_FLAGS"; NAME=textit_headless_sanitize ;;
+    *)        FLAGS="$SHARED_FLAGS $RELEASE_FLAGS";  NAME=textit_headless ;;
+esac
+
+mkdir -p build
+
+echo "COMPILER: $CXX"
+$CXX code/posix_textit.cpp code/textit.cpp $FLAGS $LLVM_FLAGS -o build/$NAME $LINKER_LIBRARIES || exit $?
+echo "built build/$NAME"
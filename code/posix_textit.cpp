@@ -0,0 +1,1744 @@
+#include "posix_textit.hpp"
+#include "textit_string.cpp"
+#include "textit_image.cpp"
+#include "textit_jobs.cpp"
+
+//
+// NOTE: Headless platform layer. There is no window and no font rasterizer: the app renders into a plain
+// memory backbuffer, and all text is drawn from a single bitmap font. main() is a frame benchmark that
+// opens the files it is given, drives AppUpdateAndRender for a number of frames and reports timings.
+//
+
+static PosixState posix_state;
+static Platform platform_;
+
+static PlatformHighResTime
+Posix_GetTime(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    PlatformHighResTime result;
+    result.opaque = (uint64_t)time.tv_sec*1000000000ull + (uint64_t)time.tv_nsec;
+
+    return result;
+}
+
+static double
+Posix_SecondsElapsed(PlatformHighResTime start, PlatformHighResTime end)
+{
+    double result = (double)(end.opaque - start.opaque) / 1000000000.0;
+    return result;
+}
+
+function PlatformEventIterator
+Posix_IterateEvents(PlatformEventFilter filter)
+{
+    PlatformEventIterator result = {};
+    result.filter = filter;
+    result.index  = posix_state.event_read_index;
+    return result;
+}
+
+function bool
+Posix_NextEvent(PlatformEventIterator *it, PlatformEvent *out_event)
+{
+    bool result = false;
+
+    uint32_t write_index = posix_state.working_event_write_index;
+    while (it->index != write_index)
+    {
+        int event_index = it->index % ArrayCount(posix_state.events);
+        it->index += 1;
+
+        PlatformEvent *event = &posix_state.events[event_index];
+        if (!event->consumed_ && MatchFilter(event->type, it->filter))
+        {
+            result           = true;
+            event->consumed_ = true;
+            *out_event       = *event;
+
+            PlatformHighResTime time = Posix_GetTime();
+            double latency = Posix_SecondsElapsed(event->timestamp, time);
+
+            platform->event_latency_sample_count += 1;
+            platform->event_latency_accumulator  += latency;
+
+            break;
+        }
+    }
+
+    return result;
+}
+
+function void
+Posix_PushEvent(PlatformEvent *event)
+{
+    uint32_t read_index  = posix_state.event_read_index;
+    uint32_t write_index = posix_state.event_write_index;
+    uint32_t size = write_index - read_index;
+
+    if (size < ArrayCount(posix_state.events))
+    {
+        event->timestamp = Posix_GetTime();
+        posix_state.events[write_index % ArrayCount(posix_state.events)] = *event;
+
+        WRITE_BARRIER;
+
+        posix_state.event_write_index = write_index + 1;
+    }
+}
+
+function void
+Posix_CycleEvents()
+{
+    posix_state.event_read_index = posix_state.working_event_write_index;
+    posix_state.working_event_write_index = posix_state.event_write_index;
+}
+
+static void
+Posix_PushTickEvent(void)
+{
+    PlatformEvent event = {};
+    event.type = PlatformEvent_Tick;
+    Posix_PushEvent(&event);
+}
+
+static void *
+Posix_Reserve(size_t size, uint32_t flags, const char *tag)
+{
+    size_t page_size = platform->page_size;
+    size_t total_size = page_size + size;
+
+    void *memory = mmap(0, total_size, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    PosixAllocationHeader *header = (PosixAllocationHeader *)memory;
+    mprotect(header, page_size, PROT_READ|PROT_WRITE);
+
+    header->size = total_size;
+    header->base = (char *)header + page_size;
+    header->flags = flags;
+
+    // NOTE: The tag is copied because it may live in app code that gets hot reloaded away
+    snprintf(header->tag, sizeof(header->tag), "%s", tag);
+    header->stats.tag      = header->tag;
+    header->stats.reserved = size;
+
+    BeginTicketMutex(&posix_state.allocation_mutex);
+    header->next = &posix_state.allocation_sentinel;
+    header->prev = posix_state.allocation_sentinel.prev;
+    header->next->prev = header;
+    header->prev->next = header;
+    EndTicketMutex(&posix_state.allocation_mutex);
+
+    return header->base;
+}
+
+static void *
+Posix_Commit(void *pointer, size_t size)
+{
+    // NOTE: mprotect wants page aligned ranges, VirtualAlloc would round these for us
+    uintptr_t page_size = platform->page_size;
+    uintptr_t start = (uintptr_t)pointer & ~(page_size - 1);
+    uintptr_t end   = AlignPow2((uintptr_t)pointer + size, page_size);
+
+    void *result = nullptr;
+    if (mprotect((void *)start, end - start, PROT_READ|PROT_WRITE) == 0)
+    {
+        result = pointer;
+    }
+    return result;
+}
+
+static void *
+Posix_Allocate(size_t size, uint32_t flags, const char *tag)
+{
+    void *result = Posix_Reserve(size, flags, tag);
+    if (result)
+    {
+        result = Posix_Commit(result, size);
+
+        PosixAllocationHeader *header = (PosixAllocationHeader *)((char *)result - platform->page_size);
+        header->stats.committed = size;
+        header->stats.used      = size;
+    }
+    return result;
+}
+
+static void
+Posix_Decommit(void *pointer, size_t size)
+{
+    if (pointer)
+    {
+        uintptr_t page_size = platform->page_size;
+        uintptr_t start = (uintptr_t)pointer & ~(page_size - 1);
+        uintptr_t end   = AlignPow2((uintptr_t)pointer + size, page_size);
+
+        madvise((void *)start, end - start, MADV_DONTNEED);
+        mprotect((void *)start, end - start, PROT_NONE);
+    }
+}
+
+static void
+Posix_Deallocate(void *pointer)
+{
+    if (pointer)
+    {
+        PosixAllocationHeader *header = (PosixAllocationHeader *)((char *)pointer - platform->page_size);
+        BeginTicketMutex(&posix_state.allocation_mutex);
+        header->prev->next = header->next;
+        header->next->prev = header->prev;
+        EndTicketMutex(&posix_state.allocation_mutex);
+        munmap(header, header->size);
+    }
+}
+
+static PlatformMemoryStats *
+Posix_GetMemoryStats(void *pointer)
+{
+    PosixAllocationHeader *header = (PosixAllocationHeader *)((char *)pointer - platform->page_size);
+    return &header->stats;
+}
+
+static size_t
+Posix_GatherMemoryStats(size_t max_count, PlatformMemoryStats *out_stats)
+{
+    size_t count = 0;
+
+    BeginTicketMutex(&posix_state.allocation_mutex);
+
+    for (PosixAllocationHeader *header = posix_state.allocation_sentinel.next;
+         header != &posix_state.allocation_sentinel;
+         header = header->next)
+    {
+        if (count < max_count) out_stats[count] = header->stats;
+        count += 1;
+    }
+
+    for (PosixHeap *heap = posix_state.heap_sentinel.next;
+         heap != &posix_state.heap_sentinel;
+         heap = heap->next)
+    {
+        if (count < max_count) out_stats[count] = heap->stats;
+        count += 1;
+    }
+
+    EndTicketMutex(&posix_state.allocation_mutex);
+
+    return count;
+}
+
+function void
+Posix_DebugPrint(char *fmt, ...)
+{
+    if (posix_state.verbose)
+    {
+        va_list args;
+        va_start(args, fmt);
+        vfprintf(stderr, fmt, args);
+        va_end(args);
+    }
+}
+
+function void
+Posix_LogPrint(PlatformLogLevel level, char *fmt, ...)
+{
+    PosixState *state = &posix_state;
+
+    Arena *arena = platform->GetTempArena();
+    ScopedMemory temp(arena);
+
+    va_list args;
+    va_start(args, fmt);
+    char *formatted = (char *)PushStringFV(arena, fmt, args).data;
+    va_end(args);
+
+    Posix_DebugPrint("LOG MESSAGE: %s\n", formatted);
+
+    char *at = formatted;
+    while (*at)
+    {
+        char *line_start = at;
+        while (*at && at[0] != '\n' && !(at[0] == '\r' && at[1] == '\n'))
+        {
+            at += 1;
+        }
+        size_t line_length = at - line_start + 1;
+
+        if (line_length > PLATFORM_LOG_LINE_SIZE)
+        {
+            line_length = PLATFORM_LOG_LINE_SIZE;
+        }
+
+        BeginTicketMutex(&state->log_mutex);
+
+        PlatformLogLine *line = &state->log_lines[(state->log_line_first + state->log_line_count) % PLATFORM_MAX_LOG_LINES];
+        if (state->log_line_count < PLATFORM_MAX_LOG_LINES)
+        {
+            state->log_line_count += 1;
+        }
+        else
+        {
+            state->log_line_first += 1;
+        }
+
+        EndTicketMutex(&state->log_mutex);
+
+        CopySize(line_length, line_start, line->data_);
+        line->data_[line_length] = 0;
+
+        line->string.size = line_length;
+        line->string.data = line->data_;
+
+        line->level = level;
+
+        while (*at && (at[0] == '\n' || (at[0] == '\r' && at[1] == '\n')))
+        {
+            at += 1;
+        }
+    }
+}
+
+function PlatformLogLine *
+Posix_GetFirstLogLine(void)
+{
+    PlatformLogLine *result = &posix_state.log_lines[posix_state.log_line_first];
+    return result;
+}
+
+function PlatformLogLine *
+Posix_GetLatestLogLine(void)
+{
+    PlatformLogLine *result = &posix_state.log_lines[(posix_state.log_line_first + posix_state.log_line_count - 1) % PLATFORM_MAX_LOG_LINES];
+    return result;
+}
+
+function PlatformLogLine *
+Posix_GetNextLogLine(PlatformLogLine *line)
+{
+    Assert((line >= posix_state.log_lines) &&
+           (line < (posix_state.log_lines + PLATFORM_MAX_LOG_LINES)));
+
+    PlatformLogLine *next = line + 1;
+    if (next >= (posix_state.log_lines + PLATFORM_MAX_LOG_LINES))
+    {
+        next -= PLATFORM_MAX_LOG_LINES;
+    }
+
+    if (next == &posix_state.log_lines[(posix_state.log_line_first + posix_state.log_line_count) % PLATFORM_MAX_LOG_LINES])
+    {
+        return nullptr;
+    }
+
+    return next;
+}
+
+function PlatformLogLine *
+Posix_GetPrevLogLine(PlatformLogLine *line)
+{
+    Assert((line >= posix_state.log_lines) &&
+           (line < (posix_state.log_lines + PLATFORM_MAX_LOG_LINES)));
+
+    if (line == &posix_state.log_lines[posix_state.log_line_first])
+    {
+        return nullptr;
+    }
+
+    PlatformLogLine *prev = line - 1;
+    if (prev < posix_state.log_lines)
+    {
+        prev += PLATFORM_MAX_LOG_LINES;
+    }
+
+    return prev;
+}
+
+function void
+Posix_ReportError(PlatformErrorType type, char *error, ...)
+{
+    char formatted_error[4096];
+
+    va_list args;
+    va_start(args, error);
+    vsnprintf(formatted_error, sizeof(formatted_error), error, args);
+    va_end(args);
+
+    fprintf(stderr, "Error: %s\n", formatted_error);
+
+    if (type == PlatformError_Fatal)
+    {
+#if TEXTIT_INTERNAL
+        abort();
+#else
+        exit(1);
+#endif
+    }
+}
+
+//
+// Clipboard
+//
+
+// NOTE: There's no system clipboard to talk to, so yanks and pastes just stay inside the process
+
+function bool
+Posix_WriteClipboard(String text)
+{
+    free(posix_state.clipboard.data);
+
+    posix_state.clipboard.data = (uint8_t *)malloc(text.size + 1);
+    posix_state.clipboard.size = text.size;
+    CopySize(text.size, text.data, posix_state.clipboard.data);
+    posix_state.clipboard.data[text.size] = 0;
+
+    return true;
+}
+
+function String
+Posix_ReadClipboard(Arena *arena)
+{
+    String result = PushString(arena, posix_state.clipboard);
+    return result;
+}
+
+//
+// Files
+//
+
+function char *
+Posix_PushNullTerminatedPath(Arena *arena, String path)
+{
+    char *result = PushNullTerminatedString(arena, path);
+    return result;
+}
+
+static size_t
+Posix_GetFileSize(String filename)
+{
+    size_t result = 0;
+
+    ScopedMemory temp(platform->GetTempArena());
+    char *path = Posix_PushNullTerminatedPath(temp, filename);
+
+    struct stat info;
+    if (stat(path, &info) == 0)
+    {
+        result = (size_t)info.st_size;
+    }
+
+    return result;
+}
+
+static uint64_t
+Posix_GetLastFileWriteTime(String filename)
+{
+    uint64_t result = 0;
+
+    ScopedMemory temp(platform->GetTempArena());
+    char *path = Posix_PushNullTerminatedPath(temp, filename);
+
+    struct stat info;
+    if (stat(path, &info) == 0)
+    {
+        result = (uint64_t)info.st_mtim.tv_sec*1000000000ull + (uint64_t)info.st_mtim.tv_nsec;
+    }
+
+    return result;
+}
+
+static bool
+Posix_SetWorkingDirectory(String path)
+{
+    char *cpath = Posix_PushNullTerminatedPath(platform->GetTempArena(), path);
+    bool result = (chdir(cpath) == 0);
+    return result;
+}
+
+static String
+Posix_PushFullPath(Arena *arena, String filename)
+{
+    String result = {};
+
+    Arena *temp = platform->GetTempArena();
+    char *path = Posix_PushNullTerminatedPath(temp, filename);
+
+    char buffer[PATH_MAX];
+    if (realpath(path, buffer))
+    {
+        result = PushStringF(arena, "%s", buffer);
+    }
+    else if (filename.size && filename.data[0] == '/')
+    {
+        result = PushString(arena, filename);
+    }
+    else
+    {
+        // NOTE: realpath only resolves files that exist, so for new files just glue the working directory on
+        char cwd[PATH_MAX];
+        if (getcwd(cwd, sizeof(cwd)))
+        {
+            result = PushStringF(arena, "%s/%.*s", cwd, StringExpand(filename));
+        }
+        else
+        {
+            result = PushString(arena, filename);
+        }
+    }
+
+    return result;
+}
+
+function bool
+Posix_ReadAll(int fd, size_t size, void *buffer)
+{
+    uint8_t *at = (uint8_t *)buffer;
+    size_t left = size;
+    while (left > 0)
+    {
+        ssize_t bytes_read = read(fd, at, left);
+        if (bytes_read < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes_read <= 0)
+        {
+            break;
+        }
+        at   += bytes_read;
+        left -= (size_t)bytes_read;
+    }
+    return (left == 0);
+}
+
+static size_t
+Posix_ReadFileInto(size_t buffer_size, void *buffer, String filename)
+{
+    Assert((buffer_size == 0) || buffer);
+
+    size_t result = 0;
+
+    ScopedMemory temp(platform->GetTempArena());
+    char *path = Posix_PushNullTerminatedPath(temp, filename);
+
+    int fd = open(path, O_RDONLY);
+    if (fd != -1)
+    {
+        struct stat info;
+        if (fstat(fd, &info) == 0)
+        {
+            size_t bytes_to_read = (size_t)info.st_size;
+            if (bytes_to_read > buffer_size - 1)
+            {
+                bytes_to_read = buffer_size - 1;
+            }
+
+            if (Posix_ReadAll(fd, bytes_to_read, buffer))
+            {
+                result = bytes_to_read;
+                ((char *)buffer)[bytes_to_read] = 0; // null terminate, just for convenience.
+            }
+            else
+            {
+                Posix_DebugPrint("Did not read expected number of bytes from file '%s'\n", path);
+            }
+        }
+        close(fd);
+    }
+    else
+    {
+        Posix_DebugPrint("Could not open file '%s'\n", path);
+    }
+
+    return result;
+}
+
+static String
+Posix_ReadFile(Arena *arena, String filename)
+{
+    String result = {};
+
+    ScopedMemory temp(platform->GetTempArena());
+    char *path = Posix_PushNullTerminatedPath(temp, filename);
+
+    int fd = open(path, O_RDONLY);
+    if (fd != -1)
+    {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+        {
+            size_t file_size = (size_t)info.st_size;
+
+            ScopedMemory temp_memory(arena);
+
+            result.data = PushArrayNoClear(arena, file_size + 1, uint8_t);
+            if (Posix_ReadAll(fd, file_size, result.data))
+            {
+                result.size = file_size;
+                result.data[file_size] = 0; // null terminate, just for convenience.
+                CommitTemporaryMemory(temp_memory);
+            }
+            else
+            {
+                result.data = nullptr;
+                Posix_DebugPrint("Did not read expected number of bytes from file '%s'\n", path);
+            }
+        }
+        close(fd);
+    }
+    else
+    {
+        Posix_DebugPrint("Could not open file '%s'\n", path);
+    }
+
+    return result;
+}
+
+static bool
+Posix_WriteFile(size_t count, void *data, String filename)
+{
+    bool result = false;
+
+    ScopedMemory temp;
+    char *path      = PushNullTerminatedString(temp, filename);
+    char *temp_path = (char *)PushStringF(temp, "%s.temp", path).data;
+
+    int fd = open(temp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd != -1)
+    {
+        uint8_t *at = (uint8_t *)data;
+        size_t left = count;
+        while (left > 0)
+        {
+            ssize_t written = write(fd, at, left);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                break;
+            }
+            at   += written;
+            left -= (size_t)written;
+        }
+        close(fd);
+
+        // NOTE: rename replaces the old file atomically, same as ReplaceFileW on the win32 side
+        if (left == 0 && rename(temp_path, path) == 0)
+        {
+            result = true;
+        }
+        else
+        {
+            Posix_ReportError(PlatformError_Nonfatal, "Failed to write file '%s': %s", path, strerror(errno));
+            unlink(temp_path);
+        }
+    }
+    else
+    {
+        Posix_ReportError(PlatformError_Nonfatal, "Failed to open file '%s' for writing: %s", temp_path, strerror(errno));
+    }
+
+    return result;
+}
+
+static bool
+Posix_FileIteratorIsValid(PlatformFileIterator *it)
+{
+    PosixFileIterator *posix_it = (PosixFileIterator *)it;
+    return !!posix_it->entry;
+}
+
+static void
+Posix_FileIteratorNext(PlatformFileIterator *it)
+{
+    PosixFileIterator *posix_it = (PosixFileIterator *)it;
+    if (posix_it->entry)
+    {
+        posix_it->entry = posix_it->entry->next;
+        if (posix_it->entry)
+        {
+            it->info = posix_it->entry->info;
+        }
+    }
+}
+
+static PlatformFileIterator *
+Posix_FindFiles(Arena *arena, String query)
+{
+    PosixFileIterator *posix_it = PushStruct(arena, PosixFileIterator);
+
+    // NOTE: Queries are "directory/prefix", matching FindFirstFileW with a trailing '*'
+    size_t split = query.size;
+    while (split > 0 && !IsPathSeparator(query.data[split - 1]))
+    {
+        split -= 1;
+    }
+
+    String directory_path = Substring(query, 0, split);
+    String prefix         = Substring(query, split);
+
+    char *directory = (directory_path.size
+                       ? PushNullTerminatedString(platform->GetTempArena(), directory_path)
+                       : (char *)".");
+
+    // NOTE: The listing is read in one go, because callers are free to stop iterating whenever they
+    // like without telling us, and the directory would never get closed otherwise
+    DIR *dir = opendir(directory);
+    if (dir)
+    {
+        PosixFileEntry **tail = &posix_it->entry;
+        for (;;)
+        {
+            struct dirent *entry = readdir(dir);
+            if (!entry)
+            {
+                break;
+            }
+
+            String name = MakeString(strlen(entry->d_name), (uint8_t *)entry->d_name);
+            if (!MatchPrefix(name, prefix))
+            {
+                continue;
+            }
+
+            bool is_directory = (entry->d_type == DT_DIR);
+            if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK)
+            {
+                ScopedMemory temp(platform->GetTempArena());
+                char *path = (char *)PushStringF(temp, "%.*s%s", StringExpand(directory_path), entry->d_name).data;
+
+                struct stat info;
+                is_directory = (stat(path, &info) == 0) && S_ISDIR(info.st_mode);
+            }
+
+            PosixFileEntry *file = PushStruct(arena, PosixFileEntry);
+            file->info.name      = PushString(arena, name);
+            file->info.directory = is_directory;
+
+            *tail = file;
+            tail  = &file->next;
+        }
+        closedir(dir);
+    }
+
+    if (posix_it->entry)
+    {
+        posix_it->it.info = posix_it->entry->info;
+    }
+
+    return &posix_it->it;
+}
+
+//
+// Offscreen Buffers
+//
+
+function void
+Posix_CreateOffscreenBuffer(int32_t w, int32_t h, PlatformOffscreenBuffer *result)
+{
+    Bitmap *bitmap = &result->bitmap;
+    bitmap->w = w;
+    bitmap->h = h;
+    bitmap->pitch = w;
+    bitmap->data = (Color *)Posix_Allocate(sizeof(Color)*(size_t)w*(size_t)h, 0, LOCATION_STRING("Offscreen Buffer"));
+    result->opaque[0] = bitmap->data;
+    result->opaque[1] = nullptr;
+}
+
+function void
+Posix_DestroyOffscreenBuffer(PlatformOffscreenBuffer *buffer)
+{
+    if (buffer->opaque[0]) Posix_Deallocate(buffer->opaque[0]);
+    ZeroStruct(buffer);
+}
+
+//
+// Thread Local Storage
+//
+
+function void
+Posix_InitializeTLSForThread(ThreadLocalContext *context)
+{
+    if (pthread_setspecific(posix_state.thread_local_key, context) != 0)
+    {
+        Posix_ReportError(PlatformError_Fatal, "Failed to set up thread local storage");
+    }
+
+    context->temp_arena      = &context->temp_arena_1_;
+    context->prev_temp_arena = &context->temp_arena_2_;
+
+    SetCapacity(context->temp_arena, Megabytes(4));
+    SetCapacity(context->prev_temp_arena, Megabytes(4));
+    const char *temp_arena_tag = LOCATION_STRING("Thread Temp Arena");
+    SetTag(context->temp_arena, temp_arena_tag);
+    SetTag(context->prev_temp_arena, temp_arena_tag);
+}
+
+static ThreadLocalContext *
+Posix_GetThreadLocalContext(void)
+{
+    ThreadLocalContext *result = (ThreadLocalContext *)pthread_getspecific(posix_state.thread_local_key);
+    if (!result)
+    {
+        Posix_ReportError(PlatformError_Fatal, "Thread local storage was not initialized for this thread");
+    }
+    return result;
+}
+
+static void
+Posix_DestroyThreadLocalContext(void)
+{
+    ThreadLocalContext *context = Posix_GetThreadLocalContext();
+    if (context)
+    {
+        Release(context->temp_arena);
+        Release(context->prev_temp_arena);
+    }
+    else
+    {
+        INVALID_CODE_PATH;
+    }
+}
+
+function Arena *
+Posix_GetTempArena(void)
+{
+    ThreadLocalContext *context = Posix_GetThreadLocalContext();
+    Arena *result = context->temp_arena;
+    return result;
+}
+
+//
+// Jobs
+//
+
+struct PosixJobThreadParams
+{
+    ThreadLocalContext *context;
+    JobWorker *worker;
+};
+
+static void *
+Posix_JobThreadProc(void *userdata)
+{
+    PosixJobThreadParams *params = (PosixJobThreadParams *)userdata;
+
+    Posix_InitializeTLSForThread(params->context);
+    RunJobWorker(params->worker);
+    Posix_DestroyThreadLocalContext();
+
+    return nullptr;
+}
+
+static void
+Posix_InitializeJobScheduler(uint32_t thread_count)
+{
+    JobScheduler *scheduler = &posix_state.job_scheduler;
+    InitializeJobScheduler(scheduler, &posix_state.arena, thread_count);
+    AttachJobSchedulerThread(scheduler);
+
+    thread_count = scheduler->worker_count - 1;
+    posix_state.job_thread_count    = thread_count;
+    posix_state.job_threads         = PushArray(&posix_state.arena, thread_count, pthread_t);
+    posix_state.job_thread_contexts = PushArray(&posix_state.arena, thread_count, ThreadLocalContext);
+
+    PosixJobThreadParams *params = PushArray(&posix_state.arena, thread_count, PosixJobThreadParams);
+    for (uint32_t i = 0; i < thread_count; i += 1)
+    {
+        params[i].context = &posix_state.job_thread_contexts[i];
+        params[i].worker  = &scheduler->workers[i + 1];
+
+        pthread_create(&posix_state.job_threads[i], nullptr, Posix_JobThreadProc, &params[i]);
+    }
+
+    platform->high_priority_queue = &scheduler->queues[JobPriority_High];
+    platform->low_priority_queue  = &scheduler->queues[JobPriority_Low];
+}
+
+static void
+Posix_SleepThread(int milliseconds)
+{
+    struct timespec time;
+    time.tv_sec  = milliseconds / 1000;
+    time.tv_nsec = (long)(milliseconds % 1000)*1000000;
+    nanosleep(&time, nullptr);
+}
+
+static void
+Posix_CloseJobScheduler(void)
+{
+    JobScheduler *scheduler = &posix_state.job_scheduler;
+    StopJobScheduler(scheduler);
+
+    for (uint32_t i = 0; i < posix_state.job_thread_count; i += 1)
+    {
+        pthread_join(posix_state.job_threads[i], nullptr);
+    }
+
+    ReleaseJobScheduler(scheduler);
+}
+
+//
+// Fonts
+//
+
+// NOTE: Stand-in glyphs for when no bitmap font was given: every printable codepoint gets its own
+// stable blocky pattern, which is all the glyph cache and the blitters care about.
+function Font
+Posix_MakeFallbackFont(Arena *arena, int32_t glyph_w, int32_t glyph_h)
+{
+    Bitmap bitmap = {};
+    bitmap.w     = 16*glyph_w;
+    bitmap.h     = 16*glyph_h;
+    bitmap.pitch = bitmap.w;
+    bitmap.data  = PushArray(arena, bitmap.w*bitmap.h, Color);
+
+    for (uint32_t glyph = '!'; glyph < 256; glyph += 1)
+    {
+        uint32_t pattern = glyph*2654435761u;
+        pattern ^= pattern >> 15;
+
+        int32_t glyph_x = (glyph % 16)*glyph_w;
+        int32_t glyph_y = (glyph / 16)*glyph_h;
+        for (int32_t y = 1; y < glyph_h - 1; y += 1)
+        for (int32_t x = 1; x < glyph_w - 1; x += 1)
+        {
+            uint32_t bit = ((x / 2)*3 + (y / 2)*5) % 29;
+            if (pattern & (1u << bit))
+            {
+                bitmap.data[(glyph_y + y)*bitmap.pitch + glyph_x + x] = COLOR_WHITE;
+            }
+        }
+    }
+
+    Font result = MakeFont(bitmap, glyph_w, glyph_h);
+    return result;
+}
+
+function bool
+Posix_RegisterFontFile(String file_name)
+{
+    UNUSED_VARIABLE(file_name);
+    return false;
+}
+
+function String *
+Posix_EnumerateFonts(Arena *arena, uint32_t max, String filter, uint32_t *out_count)
+{
+    String *result = PushArray(arena, max, String);
+    uint32_t count = 0;
+
+    String name = "Headless"_str;
+    if (count < max && FindSubstring(name, filter, StringMatch_CaseInsensitive) != name.size)
+    {
+        result[count++] = PushString(arena, name);
+    }
+
+    *out_count = count;
+    return result;
+}
+
+function PlatformFontHandle
+Posix_CreateFont(String font_name, TextStyleFlags flags, PlatformFontQuality quality, int height)
+{
+    UNUSED_VARIABLE(font_name);
+    UNUSED_VARIABLE(quality);
+    UNUSED_VARIABLE(height);
+
+    // NOTE: Fonts come out of the platform arena, destroyed ones get reused
+    PosixFont *font = posix_state.first_free_font;
+    if (font)
+    {
+        posix_state.first_free_font = font->next_free;
+    }
+    else
+    {
+        font = PushStruct(&posix_state.arena, PosixFont);
+    }
+    font->next_free = nullptr;
+    font->flags     = flags;
+    font->font      = &posix_state.font;
+
+    PlatformFontHandle handle = font;
+    return handle;
+}
+
+function void
+Posix_DestroyFont(PlatformFontHandle handle)
+{
+    PosixFont *font = (PosixFont *)handle;
+    if (font)
+    {
+        font->next_free = posix_state.first_free_font;
+        posix_state.first_free_font = font;
+    }
+}
+
+function V2i
+Posix_GetFontMetrics(PlatformFontHandle handle)
+{
+    PosixFont *font = (PosixFont *)handle;
+    V2i result = MakeV2i(font->font->glyph_w, font->font->glyph_h);
+    return result;
+}
+
+function void
+Posix_SetTextClipRect(PlatformOffscreenBuffer *target, Rect2i rect)
+{
+    UNUSED_VARIABLE(target);
+    posix_state.text_clip_rect = rect;
+}
+
+function V2i
+Posix_GetTextExtent(PlatformFontHandle handle, PlatformOffscreenBuffer *target, String text)
+{
+    UNUSED_VARIABLE(target);
+
+    PosixFont *font = (PosixFont *)handle;
+
+    int64_t codepoint_count = 0;
+    for (size_t i = 0; i < text.size; i += 1)
+    {
+        codepoint_count += !IsTrailingUtf8Byte(text.data[i]);
+    }
+
+    V2i result = MakeV2i(codepoint_count*font->font->glyph_w, font->font->glyph_h);
+    return result;
+}
+
+function Color
+Posix_BlendText(Color background, Color foreground, uint32_t coverage)
+{
+    Color result;
+    result.r = (uint8_t)(background.r + (((int32_t)foreground.r - (int32_t)background.r)*(int32_t)coverage) / 255);
+    result.g = (uint8_t)(background.g + (((int32_t)foreground.g - (int32_t)background.g)*(int32_t)coverage) / 255);
+    result.b = (uint8_t)(background.b + (((int32_t)foreground.b - (int32_t)background.b)*(int32_t)coverage) / 255);
+    result.a = 255;
+    return result;
+}
+
+function V2i
+Posix_DrawText(PlatformFontHandle handle, PlatformOffscreenBuffer *target, String text, V2i p, Color foreground, Color background)
+{
+    PosixFont *posix_font = (PosixFont *)handle;
+    Font      *font       = posix_font->font;
+    Bitmap    *bitmap     = &target->bitmap;
+
+    Rect2i clip = Intersect(posix_state.text_clip_rect, MakeRect2iMinDim(0, 0, bitmap->w, bitmap->h));
+
+    V2i at = p;
+    for (size_t i = 0; i < text.size;)
+    {
+        ParseUtf8Result parse = ParseUtf8Codepoint(text.data + i);
+        i += (parse.advance ? parse.advance : 1);
+
+        uint32_t glyph = (parse.codepoint < font->glyph_count ? parse.codepoint : '?');
+        Color *glyph_row = font->data + (glyph / font->glyphs_per_row)*font->glyph_h*font->pitch
+                                      + (glyph % font->glyphs_per_row)*font->glyph_w;
+
+        Rect2i rect = Intersect(MakeRect2iMinDim(at.x, at.y, font->glyph_w, font->glyph_h), clip);
+        for (int64_t y = rect.min.y; y < rect.max.y; y += 1)
+        {
+            Color *src = glyph_row + (y - at.y)*font->pitch + (rect.min.x - at.x);
+            Color *dst = bitmap->data + y*bitmap->pitch + rect.min.x;
+            for (int64_t x = rect.min.x; x < rect.max.x; x += 1)
+            {
+                *dst++ = Posix_BlendText(background, foreground, (src++)->a);
+            }
+        }
+
+        at.x += font->glyph_w;
+    }
+
+    V2i result = MakeV2i(at.x - p.x, font->glyph_h);
+    return result;
+}
+
+function bool
+Posix_MakeAsciiFont(String font_name, Font *out_font, int font_size, PlatformFontQuality quality)
+{
+    UNUSED_VARIABLE(font_name);
+    UNUSED_VARIABLE(font_size);
+    UNUSED_VARIABLE(quality);
+
+    *out_font = posix_state.font;
+    return true;
+}
+
+static String
+Posix_GetExeDirectory()
+{
+    return posix_state.exe_folder_utf8;
+}
+
+//
+// Heaps
+//
+
+// NOTE: Heaps sit on top of malloc, with every allocation linked into its heap so DestroyHeap can
+// free them all at once the way HeapDestroy does.
+
+static Heap *
+Posix_CreateHeap(size_t initial_size, size_t max_size, const char *tag)
+{
+    UNUSED_VARIABLE(initial_size);
+    UNUSED_VARIABLE(max_size);
+
+    PosixHeap *heap = (PosixHeap *)calloc(1, sizeof(PosixHeap));
+    DllInit(&heap->sentinel);
+
+    snprintf(heap->tag, sizeof(heap->tag), "%s", tag);
+    heap->stats.tag     = heap->tag;
+    heap->stats.is_heap = true;
+
+    BeginTicketMutex(&posix_state.allocation_mutex);
+    DllInsertBack(&posix_state.heap_sentinel, heap);
+    EndTicketMutex(&posix_state.allocation_mutex);
+
+    Heap *result = (Heap *)heap;
+    return result;
+}
+
+static void
+Posix_DestroyHeap(Heap *heap_)
+{
+    PosixHeap *heap = (PosixHeap *)heap_;
+    while (DllHasNodes(&heap->sentinel))
+    {
+        PosixHeapHeader *header = heap->sentinel.next;
+        DllRemove(header);
+        free(header);
+    }
+
+    BeginTicketMutex(&posix_state.allocation_mutex);
+    DllRemove(heap);
+    EndTicketMutex(&posix_state.allocation_mutex);
+
+    free(heap);
+}
+
+static void *
+Posix_HeapAlloc(Heap *heap_, size_t size)
+{
+    PosixHeap *heap = (PosixHeap *)heap_;
+
+    PosixHeapHeader *header = (PosixHeapHeader *)malloc(sizeof(PosixHeapHeader) + size);
+    if (!header)
+    {
+        return nullptr;
+    }
+
+    header->size = size;
+    DllInsertBack(&heap->sentinel, header);
+
+    // NOTE: malloc doesn't tell us what it has committed, so heaps only report what's in use
+    heap->stats.used      += size;
+    heap->stats.committed  = heap->stats.used;
+
+    return header + 1;
+}
+
+static size_t
+Posix_HeapGetAllocSize(Heap *heap, void *data)
+{
+    UNUSED_VARIABLE(heap);
+
+    PosixHeapHeader *header = (PosixHeapHeader *)data - 1;
+    return header->size;
+}
+
+static void Posix_HeapFree(Heap *heap_, void *data);
+
+static void *
+Posix_HeapReAlloc(Heap *heap_, void *data, size_t size)
+{
+    if (!data)
+    {
+        return Posix_HeapAlloc(heap_, size);
+    }
+
+    if (!size)
+    {
+        // NOTE: realloc(p, 0) is allowed to free p, keep it simple and always free
+        Posix_HeapFree(heap_, data);
+        return nullptr;
+    }
+
+    PosixHeap *heap = (PosixHeap *)heap_;
+
+    PosixHeapHeader *header = (PosixHeapHeader *)data - 1;
+    size_t old_size = header->size;
+    DllRemove(header);
+
+    PosixHeapHeader *new_header = (PosixHeapHeader *)realloc(header, sizeof(PosixHeapHeader) + size);
+    if (!new_header)
+    {
+        DllInsertBack(&heap->sentinel, header);
+        return nullptr;
+    }
+
+    new_header->size = size;
+    DllInsertBack(&heap->sentinel, new_header);
+
+    heap->stats.used      += size - old_size;
+    heap->stats.committed  = heap->stats.used;
+
+    return new_header + 1;
+}
+
+static void
+Posix_HeapFree(Heap *heap_, void *data)
+{
+    PosixHeap *heap = (PosixHeap *)heap_;
+
+    if (data)
+    {
+        PosixHeapHeader *header = (PosixHeapHeader *)data - 1;
+
+        heap->stats.used      -= header->size;
+        heap->stats.committed  = heap->stats.used;
+
+        DllRemove(header);
+        free(header);
+    }
+}
+
+function String
+Posix_FindExeFolder(Arena *arena)
+{
+    String result = "."_str;
+
+    char buffer[PATH_MAX];
+    ssize_t size = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+    if (size > 0)
+    {
+        String exe_path = MakeString((size_t)size, (uint8_t *)buffer);
+        String folder   = SplitPath(exe_path);
+        if (folder.size > 1)
+        {
+            folder.size -= 1; // NOTE: Drop the trailing slash, win32 hands out the folder without one too
+        }
+        result = PushString(arena, folder);
+    }
+
+    return result;
+}
+
+//
+// Benchmark
+//
+
+struct PosixFrameSample
+{
+    double total;
+    double draw;
+    double sort;
+    double rasterize;
+};
+
+enum PosixScrollMode
+{
+    PosixScroll_None,
+    PosixScroll_Line,
+    PosixScroll_Page,
+};
+
+function int
+Posix_CompareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+function void
+Posix_PrintTimingRow(const char *name, int sample_count, double *samples)
+{
+    qsort(samples, (size_t)sample_count, sizeof(double), Posix_CompareDoubles);
+
+    double sum = 0.0;
+    for (int i = 0; i < sample_count; i += 1)
+    {
+        sum += samples[i];
+    }
+
+    double avg = sum / (double)sample_count;
+    double p50 = samples[(sample_count - 1)*50 / 100];
+    double p99 = samples[(sample_count - 1)*99 / 100];
+
+    printf("  %-10s %9.3f %9.3f %9.3f %9.3f %9.3f\n", name,
+           1000.0*samples[0], 1000.0*avg, 1000.0*p50, 1000.0*p99, 1000.0*samples[sample_count - 1]);
+}
+
+function void
+Posix_PushScrollEvent(PosixScrollMode mode, bool down)
+{
+    PlatformEvent event = {};
+    event.type    = PlatformEvent_KeyDown;
+    event.pressed = true;
+
+    if (mode == PosixScroll_Line)
+    {
+        event.input_code = (down ? PlatformInputCode_Down : PlatformInputCode_Up);
+    }
+    else
+    {
+        event.ctrl_down  = true;
+        event.input_code = (down ? PlatformInputCode_F : PlatformInputCode_B);
+    }
+
+    Posix_PushEvent(&event);
+
+    event.type     = PlatformEvent_KeyUp;
+    event.pressed  = false;
+    event.released = true;
+    Posix_PushEvent(&event);
+}
+
+//
+// Job benchmark
+//
+
+// NOTE: Fans out empty jobs in a few different shapes, so the time per job is all scheduling overhead
+#define POSIX_JOB_BENCHMARK_BATCH  512
+#define POSIX_JOB_BENCHMARK_NESTED 64
+#define POSIX_JOB_BENCHMARK_CHAIN  256
+
+static volatile uint32_t posix_job_benchmark_sink;
+
+function
+PLATFORM_JOB(Posix_EmptyJob)
+{
+    (void)userdata;
+    AtomicIncrement(&posix_job_benchmark_sink);
+}
+
+function
+PLATFORM_JOB(Posix_FanOutJob)
+{
+    (void)userdata;
+
+    PlatformJobGroup group = {};
+    for (int i = 0; i < POSIX_JOB_BENCHMARK_NESTED; i += 1)
+    {
+        platform->AddJobToGroup(platform->high_priority_queue, &group, nullptr, Posix_EmptyJob);
+    }
+    platform->WaitForJobGroup(&group);
+}
+
+enum PosixJobBenchmark
+{
+    PosixJobBenchmark_Inline, // calling the job directly, for reference
+    PosixJobBenchmark_Flat,   // AddJob + WaitForJobs from the app thread
+    PosixJobBenchmark_Group,  // AddJobToGroup + WaitForJobGroup from the app thread
+    PosixJobBenchmark_Nested, // jobs that fan out into more jobs and wait on them
+    PosixJobBenchmark_Chain,  // every job comes after the one before it
+    PosixJobBenchmark_COUNT,
+};
+
+function uint32_t
+Posix_RunJobBenchmarkRound(PosixJobBenchmark benchmark)
+{
+    uint32_t result = 0;
+
+    switch (benchmark)
+    {
+        case PosixJobBenchmark_Inline:
+        {
+            for (int i = 0; i < POSIX_JOB_BENCHMARK_BATCH; i += 1)
+            {
+                Posix_EmptyJob(nullptr);
+            }
+            result = POSIX_JOB_BENCHMARK_BATCH;
+        } break;
+
+        case PosixJobBenchmark_Flat:
+        {
+            for (int i = 0; i < POSIX_JOB_BENCHMARK_BATCH; i += 1)
+            {
+                platform->AddJob(platform->high_priority_queue, nullptr, Posix_EmptyJob);
+            }
+            platform->WaitForJobs(platform->high_priority_queue);
+            result = POSIX_JOB_BENCHMARK_BATCH;
+        } break;
+
+        case PosixJobBenchmark_Group:
+        {
+            PlatformJobGroup group = {};
+            for (int i = 0; i < POSIX_JOB_BENCHMARK_BATCH; i += 1)
+            {
+                platform->AddJobToGroup(platform->high_priority_queue, &group, nullptr, Posix_EmptyJob);
+            }
+            platform->WaitForJobGroup(&group);
+            result = POSIX_JOB_BENCHMARK_BATCH;
+        } break;
+
+        case PosixJobBenchmark_Nested:
+        {
+            PlatformJobGroup group = {};
+            for (int i = 0; i < POSIX_JOB_BENCHMARK_NESTED; i += 1)
+            {
+                platform->AddJobToGroup(platform->high_priority_queue, &group, nullptr, Posix_FanOutJob);
+            }
+            platform->WaitForJobGroup(&group);
+            result = POSIX_JOB_BENCHMARK_NESTED*(POSIX_JOB_BENCHMARK_NESTED + 1);
+        } break;
+
+        case PosixJobBenchmark_Chain:
+        {
+            PlatformJobGroup groups[POSIX_JOB_BENCHMARK_CHAIN] = {};
+            for (int i = 0; i < POSIX_JOB_BENCHMARK_CHAIN; i += 1)
+            {
+                platform->AddJobAfter(platform->high_priority_queue, (i > 0 ? &groups[i - 1] : nullptr), &groups[i],
+                                      nullptr, Posix_EmptyJob);
+            }
+            platform->WaitForJobGroup(&groups[POSIX_JOB_BENCHMARK_CHAIN - 1]);
+            result = POSIX_JOB_BENCHMARK_CHAIN;
+        } break;
+
+        INVALID_DEFAULT_CASE;
+    }
+
+    return result;
+}
+
+function void
+Posix_RunJobBenchmark(int round_count)
+{
+    static const char *names[] = { "inline", "flat", "group", "nested", "chain" };
+    StaticAssert(ArrayCount(names) == PosixJobBenchmark_COUNT, "Benchmark names must match PosixJobBenchmark");
+
+    double *column = PushArray(&posix_state.arena, round_count, double);
+
+    printf("%d rounds on %u workers, nanoseconds per job:\n", round_count, posix_state.job_scheduler.worker_count);
+    printf("  %-10s %9s %9s %9s %9s %9s\n", "", "min", "avg", "p50", "p99", "max");
+
+    for (int benchmark = 0; benchmark < PosixJobBenchmark_COUNT; benchmark += 1)
+    {
+        for (int round = 0; round < round_count; round += 1)
+        {
+            PlatformHighResTime start = Posix_GetTime();
+            uint32_t job_count = Posix_RunJobBenchmarkRound((PosixJobBenchmark)benchmark);
+            PlatformHighResTime end = Posix_GetTime();
+
+            // NOTE: Posix_PrintTimingRow prints milliseconds, scaling by a million more gets nanoseconds
+            column[round] = 1000000.0*Posix_SecondsElapsed(start, end) / (double)job_count;
+        }
+        Posix_PrintTimingRow(names[benchmark], round_count, column);
+    }
+
+    JobSchedulerStats stats = GetJobSchedulerStats(&posix_state.job_scheduler);
+    printf("  %llu jobs run by workers, %llu stolen, %llu run while waiting, %llu sleeps\n",
+           (unsigned long long)stats.jobs_run, (unsigned long long)stats.jobs_stolen,
+           (unsigned long long)stats.jobs_helped, (unsigned long long)stats.sleeps);
+}
+
+function void
+Posix_PrintUsage(void)
+{
+    fprintf(stderr,
+            "usage: textit_headless [options] [files...]\n"
+            "  --frames N          frames to measure (default 300)\n"
+            "  --warmup N          frames to run before measuring (default 10)\n"
+            "  --size WxH          backbuffer size in pixels (default 1280x960)\n"
+            "  --font FILE WxH     bitmap font to draw text with (default: built in stand-in glyphs)\n"
+            "  --scroll MODE       none, line or page; scrolls down and back up every --sweep frames (default line)\n"
+            "  --sweep N           frames per scroll direction (default 200)\n"
+            "  --verbose           print debug output to stderr\n"
+            "  --job-benchmark N   measure job scheduling overhead over N rounds instead of running frames\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    platform = &platform_;
+
+    posix_state.allocation_sentinel.next = &posix_state.allocation_sentinel;
+    posix_state.allocation_sentinel.prev = &posix_state.allocation_sentinel;
+    DllInit(&posix_state.heap_sentinel);
+
+    platform->IterateEvents          = Posix_IterateEvents;
+    platform->NextEvent              = Posix_NextEvent;
+    platform->PushTickEvent          = Posix_PushTickEvent;
+
+    platform->DebugPrint             = Posix_DebugPrint;
+    platform->LogPrint               = Posix_LogPrint;
+    platform->GetFirstLogLine        = Posix_GetFirstLogLine;
+    platform->GetLatestLogLine       = Posix_GetLatestLogLine;
+    platform->GetNextLogLine         = Posix_GetNextLogLine;
+    platform->GetPrevLogLine         = Posix_GetPrevLogLine;
+
+    platform->page_size              = (size_t)sysconf(_SC_PAGESIZE);
+    platform->allocation_granularity = platform->page_size;
+    platform->ReportError            = Posix_ReportError;
+    platform->AllocateMemory         = Posix_Allocate;
+    platform->ReserveMemory          = Posix_Reserve;
+    platform->CommitMemory           = Posix_Commit;
+    platform->DecommitMemory         = Posix_Decommit;
+    platform->DeallocateMemory       = Posix_Deallocate;
+    platform->GetMemoryStats         = Posix_GetMemoryStats;
+    platform->GatherMemoryStats      = Posix_GatherMemoryStats;
+
+    platform->CreateHeap             = Posix_CreateHeap;
+    platform->DestroyHeap            = Posix_DestroyHeap;
+    platform->HeapAlloc              = Posix_HeapAlloc;
+    platform->HeapGetAllocSize       = Posix_HeapGetAllocSize;
+    platform->HeapReAlloc            = Posix_HeapReAlloc;
+    platform->HeapFree               = Posix_HeapFree;
+
+    platform->RegisterFontFile       = Posix_RegisterFontFile;
+    platform->MakeAsciiFont          = Posix_MakeAsciiFont;
+
+    platform->CreateOffscreenBuffer  = Posix_CreateOffscreenBuffer;
+    platform->DestroyOffscreenBuffer = Posix_DestroyOffscreenBuffer;
+
+    platform->EnumerateFonts         = Posix_EnumerateFonts;
+    platform->CreateFont             = Posix_CreateFont;
+    platform->DestroyFont            = Posix_DestroyFont;
+    platform->GetFontMetrics         = Posix_GetFontMetrics;
+    platform->GetTextExtent          = Posix_GetTextExtent;
+    platform->SetTextClipRect        = Posix_SetTextClipRect;
+    platform->DrawText               = Posix_DrawText;
+
+    platform->GetThreadLocalContext  = Posix_GetThreadLocalContext;
+    platform->GetTempArena           = Posix_GetTempArena;
+
+    platform->AddJob                 = Jobs_AddJob;
+    platform->WaitForJobs            = Jobs_WaitForJobs;
+    platform->AddJobToGroup          = Jobs_AddJobToGroup;
+    platform->AddJobAfter            = Jobs_AddJobAfter;
+    platform->WaitForJobGroup        = Jobs_WaitForJobGroup;
+
+    platform->GetExeDirectory        = Posix_GetExeDirectory;
+    platform->SetWorkingDirectory    = Posix_SetWorkingDirectory;
+    platform->PushFullPath           = Posix_PushFullPath;
+    platform->ReadFile               = Posix_ReadFile;
+    platform->ReadFileInto           = Posix_ReadFileInto;
+    platform->WriteFile              = Posix_WriteFile;
+    platform->GetFileSize            = Posix_GetFileSize;
+    platform->GetLastFileWriteTime   = Posix_GetLastFileWriteTime;
+
+    platform->FindFiles              = Posix_FindFiles;
+    platform->FileIteratorIsValid    = Posix_FileIteratorIsValid;
+    platform->FileIteratorNext       = Posix_FileIteratorNext;
+
+    platform->GetTime                = Posix_GetTime;
+    platform->SecondsElapsed         = Posix_SecondsElapsed;
+
+    platform->WriteClipboard         = Posix_WriteClipboard;
+    platform->ReadClipboard          = Posix_ReadClipboard;
+
+    platform->SleepThread            = Posix_SleepThread;
+
+    //
+
+    if (pthread_key_create(&posix_state.thread_local_key, nullptr) != 0)
+    {
+        Posix_ReportError(PlatformError_Fatal, "Failed to allocate a thread local storage key");
+    }
+
+    ThreadLocalContext tls_context = {};
+    Posix_InitializeTLSForThread(&tls_context);
+
+    //
+
+    int frame_count  = 300;
+    int warmup_count = 10;
+    int sweep_frames = 200;
+    int32_t render_w = 1280;
+    int32_t render_h = 960;
+    PosixScrollMode scroll_mode = PosixScroll_Line;
+    int job_benchmark_rounds = 0;
+
+    char *font_path = nullptr;
+    int32_t font_glyph_w = 8;
+    int32_t font_glyph_h = 16;
+
+    String *files = PushArray(&posix_state.arena, argc, String);
+    int file_count = 0;
+
+    for (int i = 1; i < argc; i += 1)
+    {
+        char *arg = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        if (!strcmp(arg, "--frames") && has_value)
+        {
+            frame_count = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--warmup") && has_value)
+        {
+            warmup_count = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--sweep") && has_value)
+        {
+            sweep_frames = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--size") && has_value)
+        {
+            if (sscanf(argv[++i], "%dx%d", &render_w, &render_h) != 2)
+            {
+                Posix_PrintUsage();
+                return 1;
+            }
+        }
+        else if (!strcmp(arg, "--font") && (i + 2 < argc))
+        {
+            font_path = argv[++i];
+            if (sscanf(argv[++i], "%dx%d", &font_glyph_w, &font_glyph_h) != 2)
+            {
+                Posix_PrintUsage();
+                return 1;
+            }
+        }
+        else if (!strcmp(arg, "--scroll") && has_value)
+        {
+            char *mode = argv[++i];
+            if      (!strcmp(mode, "none")) scroll_mode = PosixScroll_None;
+            else if (!strcmp(mode, "line")) scroll_mode = PosixScroll_Line;
+            else if (!strcmp(mode, "page")) scroll_mode = PosixScroll_Page;
+            else
+            {
+                Posix_PrintUsage();
+                return 1;
+            }
+        }
+        else if (!strcmp(arg, "--job-benchmark") && has_value)
+        {
+            job_benchmark_rounds = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--verbose"))
+        {
+            posix_state.verbose = true;
+        }
+        else if (arg[0] == '-')
+        {
+            Posix_PrintUsage();
+            return 1;
+        }
+        else
+        {
+            files[file_count++] = MakeString(strlen(arg), (uint8_t *)arg);
+        }
+    }
+
+    if (frame_count < 1 || warmup_count < 0 || sweep_frames < 1 || render_w < 1 || render_h < 1)
+    {
+        Posix_PrintUsage();
+        return 1;
+    }
+
+    posix_state.exe_folder_utf8 = Posix_FindExeFolder(&posix_state.arena);
+
+    if (font_path)
+    {
+        posix_state.font = LoadFontFromDisk(&posix_state.arena, MakeString(strlen(font_path), (uint8_t *)font_path),
+                                            font_glyph_w, font_glyph_h);
+        if (!posix_state.font.data)
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        posix_state.font = Posix_MakeFallbackFont(&posix_state.arena, font_glyph_w, font_glyph_h);
+    }
+
+    // NOTE: One worker per core, the app thread being workers[0] and the job threads the rest
+    long core_count = sysconf(_SC_NPROCESSORS_ONLN);
+    Posix_InitializeJobScheduler((uint32_t)(core_count > 3 ? core_count - 1 : 2));
+
+    if (job_benchmark_rounds > 0)
+    {
+        Posix_RunJobBenchmark(job_benchmark_rounds);
+        Posix_CloseJobScheduler();
+        return 0;
+    }
+
+    platform->window_resize_snap_w = 1;
+    platform->window_resize_snap_h = 1;
+
+    platform->startup_file_count = file_count;
+    platform->startup_files      = files;
+
+    platform->render_w = render_w;
+    platform->render_h = render_h;
+    Posix_CreateOffscreenBuffer(render_w, render_h, &platform->backbuffer);
+
+    platform->exe_reloaded = true;
+    platform->dt = 1.0f / 60.0f;
+
+    int total_frames = warmup_count + frame_count;
+    PosixFrameSample *samples = PushArray(&posix_state.arena, frame_count, PosixFrameSample);
+
+    for (int frame = 0; frame < total_frames; frame += 1)
+    {
+        ThreadLocalContext *context = &tls_context;
+        Swap(context->temp_arena, context->prev_temp_arena);
+        Clear(context->temp_arena);
+
+        if (scroll_mode != PosixScroll_None && frame > 0)
+        {
+            bool down = ((frame / sweep_frames) % 2) == 0;
+            Posix_PushScrollEvent(scroll_mode, down);
+        }
+
+        PlatformHighResTime start = Posix_GetTime();
+
+        Posix_CycleEvents();
+        AppUpdateAndRender(platform);
+        platform->exe_reloaded = false;
+
+        // NOTE: The startup files get opened in the background by the first frame, and the point is to measure
+        // drawing them rather than drawing the placeholder shown while they load
+        if (frame == 0)
+        {
+            Jobs_WaitForJobs(platform->high_priority_queue);
+        }
+
+        // NOTE: There is nothing to present to, so the frame counts as presented once it's rendered
+        PlatformHighResTime end = Posix_GetTime();
+        platform->present_time = end;
+
+        if (frame >= warmup_count)
+        {
+            PosixFrameSample *sample = &samples[frame - warmup_count];
+            sample->total     = Posix_SecondsElapsed(start, end);
+            sample->draw      = platform->frame_timings.draw;
+            sample->sort      = platform->frame_timings.sort;
+            sample->rasterize = platform->frame_timings.rasterize;
+        }
+    }
+
+    double *column = PushArray(&posix_state.arena, frame_count, double);
+
+    printf("%d frames at %dx%d (%d warmup), glyphs %dx%d, times in ms:\n",
+           frame_count, render_w, render_h, warmup_count, posix_state.font.glyph_w, posix_state.font.glyph_h);
+    printf("  %-10s %9s %9s %9s %9s %9s\n", "", "min", "avg", "p50", "p99", "max");
+
+    for (int i = 0; i < frame_count; i += 1) column[i] = samples[i].total;
+    Posix_PrintTimingRow("frame", frame_count, column);
+
+    for (int i = 0; i < frame_count; i += 1) column[i] = samples[i].draw;
+    Posix_PrintTimingRow("draw", frame_count, column);
+
+    for (int i = 0; i < frame_count; i += 1) column[i] = samples[i].sort;
+    Posix_PrintTimingRow("sort", frame_count, column);
+
+    for (int i = 0; i < frame_count; i += 1) column[i] = samples[i].rasterize;
+    Posix_PrintTimingRow("rasterize", frame_count, column);
+
+    // NOTE: One last frame with exit_requested set so the app gets to flush what it saves on the way out
+    platform->exit_requested = true;
+    Posix_CycleEvents();
+    AppUpdateAndRender(platform);
+
+    Posix_CloseJobScheduler();
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#ifndef POSIX_TEXTIT_HPP
+#define POSIX_TEXTIT_HPP
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "textit_platform.hpp"
+#include "textit_shared.hpp"
+#include "textit_memory.hpp"
+#include "textit_string.hpp"
+#include "textit_math.hpp"
+#include "textit_image.hpp"
+#include "textit_jobs.hpp"
+
+struct PosixAllocationHeader
+{
+    PosixAllocationHeader *next, *prev;
+    size_t size;
+    char *base;
+    uint32_t flags;
+    PlatformMemoryStats stats;
+    char tag[PLATFORM_MEMORY_TAG_SIZE];
+};
+
+struct PosixHeapHeader
+{
+    PosixHeapHeader *next, *prev;
+    size_t size;
+    size_t pad_;
+};
+
+struct PosixHeap
+{
+    PosixHeap *next, *prev;
+    PosixHeapHeader sentinel;
+    PlatformMemoryStats stats;
+    char tag[PLATFORM_MEMORY_TAG_SIZE];
+};
+
+struct ThreadLocalContext
+{
+    ThreadLocalContext *next;
+
+    Arena *temp_arena;
+    Arena *prev_temp_arena;
+
+    Arena temp_arena_1_;
+    Arena temp_arena_2_;
+};
+
+struct PosixFont
+{
+    PosixFont *next_free;
+    TextStyleFlags flags;
+    Font *font;
+};
+
+struct PosixFileEntry
+{
+    PosixFileEntry *next;
+    PlatformFileInfo info;
+};
+
+struct PosixFileIterator
+{
+    PlatformFileIterator it;
+    PosixFileEntry *entry;
+};
+
+struct PosixState
+{
+    Arena arena;
+
+    bool verbose;
+
+    String exe_folder_utf8;
+
+    pthread_key_t thread_local_key;
+
+    JobScheduler job_scheduler;
+    uint32_t job_thread_count;
+    pthread_t *job_threads;
+    ThreadLocalContext *job_thread_contexts;
+
+    TicketMutex allocation_mutex;
+    PosixAllocationHeader allocation_sentinel;
+    PosixHeap heap_sentinel;
+
+    // NOTE: There is no font rasterizer, every font handle draws from this one bitmap font
+    Font font;
+    PosixFont *first_free_font;
+
+    Rect2i text_clip_rect;
+
+    String clipboard;
+
+    TicketMutex log_mutex;
+    int log_line_count;
+    int log_line_first;
+    PlatformLogLine log_lines[PLATFORM_MAX_LOG_LINES];
+
+    uint32_t event_read_index;
+    uint32_t event_write_index;
+    uint32_t working_event_write_index;
+    PlatformEvent null_event;
+    PlatformEvent events[4096];
+};
+
+#endif /* POSIX_TEXTIT_HPP */
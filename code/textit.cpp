@@ -6,6 +6,7 @@
 #include "textit_config.cpp"
 #include "textit_image.cpp"
 #include "textit_glyph_cache.cpp"
+#include "textit_blit.cpp"
 #include "textit_render.cpp"
 #include "textit_text_storage.cpp"
 #include "textit_tokens.cpp"
@@ -13,6 +14,8 @@
 #include "textit_buffer.cpp"
 #include "textit_tokenizer.cpp"
 #include "textit_tags.cpp"
+#include "textit_file_walker.cpp"
+#include "textit_directory_cache.cpp"
 #include "textit_project.cpp"
 #include "textit_view.cpp"
 #include "textit_window.cpp"
@@ -23,6 +26,9 @@
 #include "textit_snippet.cpp"
 #include "textit_base_commands.cpp"
 #include "textit_draw.cpp"
+#include "textit_profiler.cpp"
+#include "textit_latency.cpp"
+#include "textit_memory_stats.cpp"
 #include "textit_command_line.cpp"
 #include "textit_completion_menu.cpp"
 
@@ -71,55 +77,6 @@ SetDebugDelay(int milliseconds, int frame_count)
     editor->debug.delay_frame_count = frame_count;
 }
 
-static Font
-MakeFont(Bitmap bitmap, int32_t glyph_w, int32_t glyph_h)
-{
-    Font font = {};
-
-    font.w       = bitmap.w;
-    font.h       = bitmap.h;
-    font.pitch   = bitmap.pitch;
-    font.glyph_w = glyph_w;
-    font.glyph_h = glyph_h;
-
-    // you probably got it wrong if there's slop
-    Assert(font.w % glyph_w == 0);
-    Assert(font.h % glyph_h == 0);
-
-    font.glyphs_per_row = font.w / glyph_w;
-    font.glyphs_per_col = font.h / glyph_h;
-    font.glyph_count = font.glyphs_per_col*font.glyphs_per_row;
-
-    font.data = bitmap.data;
-
-    return font;
-}
-
-function Font
-LoadFontFromDisk(Arena *arena, String filename, int glyph_w, int glyph_h)
-{
-    Font result = {};
-
-    String file = platform->ReadFile(platform->GetTempArena(), filename);
-    if (!file.size)
-    {
-        platform->ReportError(PlatformError_Nonfatal,
-                              "Could not open file '%.*s' while loading font.", StringExpand(filename));
-        return result;
-    }
-
-    Bitmap bitmap = ParseBitmap(arena, file);
-    if (!bitmap.data)
-    {
-        platform->ReportError(PlatformError_Nonfatal,
-                              "Failed to parse bitmap '%.*s' while loading font.", StringExpand(filename));
-        return result;
-    }
-
-    result = MakeFont(bitmap, glyph_w, glyph_h);
-    return result;
-}
-
 function Bitmap
 GetGlyphBitmap(Font *font, Glyph glyph)
 {
@@ -248,7 +205,7 @@ HandleViewEvent(ViewID view_id, PlatformEvent *event)
     ScopedMemory temp;
     Cursors cursors = GetCursors(temp, view, buffer);
 
-    if ((event->type == PlatformEvent_Text) && bindings->text_command)
+    if ((event->type == PlatformEvent_Text) && bindings->text_command && IsBufferLoaded(buffer))
     {
         String text = GetText(event);
         bindings->text_command->text(cursors, text);
@@ -298,6 +255,17 @@ HandleViewEvent(ViewID view_id, PlatformEvent *event)
                 command = binding->by_modifiers[modifiers];
             }
 
+            // NOTE: Buffers that are still loading can't be edited, and can't be moved around in until they're tokenized
+            if (command && !IsBufferLoaded(buffer))
+            {
+                if ((command->kind == Command_Change) ||
+                    (command->kind == Command_Movement && !IsBufferLoaded(buffer, BufferLoad_Tokenized)) ||
+                    AreEqual(command->name, "RepeatLastCommand"_str))
+                {
+                    command = nullptr;
+                }
+            }
+
             if (command)
             {
                 if (modifiers & Modifier_Shift)
@@ -346,7 +314,7 @@ HandleViewEvent(ViewID view_id, PlatformEvent *event)
             }
         }
     }
-    else if (MatchFilter(event->type, PlatformEventFilter_Mouse))
+    else if (MatchFilter(event->type, PlatformEventFilter_Mouse) && IsBufferLoaded(buffer, BufferLoad_Tokenized))
     {
         if (event->input_code == PlatformInputCode_LButton)
         {
@@ -418,6 +386,9 @@ FontQualityFromString(String font_quality)
 function void
 SetEditorFont(String name, int size, PlatformFontQuality quality)
 {
+    // NOTE: Keep what the old font has rasterized so far, the key still describes the old font here
+    SaveGlyphCacheFile();
+
     V2i max_metrics = MakeV2i(0, 0);
     V2i min_metrics = MakeV2i(INT_MAX, INT_MAX);
     editor->font_metrics = {};
@@ -485,16 +456,24 @@ AppUpdateAndRender(Platform *platform_)
     {
         editor = BootstrapPushStruct(EditorState, permanent_arena);
         platform->persistent_app_data = editor;
+
+        SetTag(&editor->transient_arena, LOCATION_STRING("Transient Arena"));
+        SetTag(&editor->undo_scratch, LOCATION_STRING("Undo Scratch"));
+        SetTag(&editor->command_arena, LOCATION_STRING("Command Line Arena"));
     }
 
     if (platform->exe_reloaded)
     {
         RestoreGlobalState(&editor->global_state, &editor->transient_arena);
+        CompileThemePalette();
     }
 
+    BeginProfilerFrame();
+    BeginLatencyFrame();
+
     if (!platform->app_initialized)
     {
-        editor->heap = platform->CreateHeap(Kilobytes(4), 0);
+        editor->heap = CreateSizeClassHeap(LOCATION_STRING("Editor Heap"));
 
         LoadDefaultThemes();
         LoadDefaultBindings();
@@ -515,10 +494,21 @@ AppUpdateAndRender(Platform *platform_)
 
         DllInit(&editor->project_sentinel);
 
-        Buffer *scratch_buffer = OpenBufferFromFile("code/textit.cpp"_str);
-        View   *scratch_view   = OpenNewView(scratch_buffer->id);
+        View *first_view = nullptr;
+        for (int i = 0; i < platform->startup_file_count; i += 1)
+        {
+            Buffer *buffer = OpenBufferFromFileAsync(platform->high_priority_queue, platform->startup_files[i]);
+            View   *view   = OpenNewView(buffer->id);
+            if (!first_view) first_view = view;
+        }
 
-        editor->root_window.view = scratch_view->id;
+        if (!first_view)
+        {
+            Buffer *scratch_buffer = OpenBufferFromFileAsync(platform->high_priority_queue, "code/textit.cpp"_str);
+            first_view = OpenNewView(scratch_buffer->id);
+        }
+
+        editor->root_window.view = first_view->id;
         editor->active_window = &editor->root_window;
 
         editor->search = MakeStringContainer(ArrayCount(editor->search_storage), editor->search_storage);
@@ -590,6 +580,8 @@ AppUpdateAndRender(Platform *platform_)
 
         events_handled += 1;
 
+        TimedBlock("HandleEvent");
+
         bool handled_ui = HandleUiEvent(&event);
         handled_any_events |= handled_ui;
 
@@ -600,9 +592,11 @@ AppUpdateAndRender(Platform *platform_)
             {
                 // if we began a command line, it needs to be warmed up to not show a frame of lag for the predictions
                 CommandLine *cl = editor->command_lines[editor->command_line_count - 1];
-                if (cl->GatherPredictions) cl->GatherPredictions(cl);
+                UpdatePredictions(cl);
             }
         }
+
+        RecordEventHandled(&event);
     }
 
     // Reset(&editor->completion);
@@ -623,6 +617,8 @@ AppUpdateAndRender(Platform *platform_)
         // FindCompletionCandidatesAt(buffer, cursor->pos);
     }
 
+    UpdateLoadingBuffers();
+
     for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
     {
         Buffer *buffer = it.buffer;
@@ -646,12 +642,16 @@ AppUpdateAndRender(Platform *platform_)
         }
     }
 
+    PlatformHighResTime draw_start = platform->GetTime();
+
     {
+        TimedBlock("DrawWindows");
+
         View   *view   = GetActiveView();
         Buffer *buffer = GetBuffer(view);
 
         if ((editor->next_edit_mode == EditMode_Text) &&
-            (buffer->flags & Buffer_ReadOnly))
+            ((buffer->flags & Buffer_ReadOnly) || !IsBufferLoaded(buffer)))
         {
             editor->next_edit_mode = EditMode_Command;
         }
@@ -668,12 +668,52 @@ AppUpdateAndRender(Platform *platform_)
 
     if (core_config->debug_show_glyph_cache)
     {
-        int backbuffer_w = platform->backbuffer.bitmap.w;
-        int glyph_tex_w = render_state->glyph_texture.bitmap.w;
-        PushBitmap(&render_state->glyph_texture.bitmap, MakeV2i(backbuffer_w - glyph_tex_w, 0));
+        GlyphCache      *cache = &render_state->glyph_cache;
+        GlyphCacheStats *stats = &cache->last_stats;
+
+        String text = PushTempStringF("glyph cache: %u/%u filled, %u/%u pages | last frame: %u hits, %u misses, %u evictions, %u pages added",
+                                      GetEntryCount(cache, GlyphState_Filled), cache->max_size - 1,
+                                      GetGlyphCachePageCount(cache), cache->max_size / cache->entries_per_page,
+                                      stats->hits, stats->misses, stats->evictions, stats->pages_added);
+        Rect2i viewport = render_state->viewport;
+        DrawText(MakeV2i(viewport.max.x - (int64_t)text.size, 0), text,
+                 GetThemeColor("text_foreground"_id), GetThemeColor("text_background_popup"_id));
+
+        // NOTE: Pages go right to left for as long as they fit
+        int page_x = platform->backbuffer.bitmap.w;
+        for (uint32_t page = 0; page < GetGlyphCachePageCount(cache); page += 1)
+        {
+            Bitmap *bitmap = &GetGlyphCachePage(page*cache->entries_per_page)->bitmap;
+            page_x -= bitmap->w;
+            if (page_x < 0)
+            {
+                break;
+            }
+            PushBitmap(bitmap, MakeV2i(page_x, (int)editor->font_metrics.y));
+        }
+    }
+
+    if (core_config->debug_show_memory)
+    {
+        DrawMemoryStats();
     }
 
+    if (core_config->debug_show_profiler)
+    {
+        DrawProfiler();
+    }
+
+    platform->frame_timings.draw = platform->SecondsElapsed(draw_start, platform->GetTime());
+
     EndRender();
+    RecordFrameRendered();
+
+    // NOTE: The file can be tens of megabytes, so it's only written on the way out (and on a font change,
+    // see SetEditorFont) rather than every so often while typing
+    if (platform->exit_requested)
+    {
+        SaveGlyphCacheFile();
+    }
 
 #if 0
     for (ViewIterator it = IterateViews(); IsValid(&it); Next(&it))
@@ -691,29 +731,16 @@ AppUpdateAndRender(Platform *platform_)
     }
 #endif
 
-    if (handled_any_events) 
-    {
-#if 0
-        platform->DebugPrint("Line index insert time: %fms, lookup time: %fms, lookup count: %lld, recursions per lookup: %lld\n",
-                             1000.0*editor->debug.line_index_insert_timing,
-                             1000.0*editor->debug.line_index_lookup_timing,
-                             editor->debug.line_index_lookup_count,
-                             editor->debug.line_index_lookup_recursion_count / editor->debug.line_index_lookup_count);
-        platform->DebugPrint("Buffer move time: %fms\n", 1000.0*editor->debug.buffer_edit_timing);
-#endif
-    }
-    editor->debug.line_index_insert_timing          = 0.0;
-    editor->debug.line_index_lookup_timing          = 0.0;
-    editor->debug.line_index_lookup_count           = 0;
-    editor->debug.line_index_lookup_recursion_count = 0;
-    editor->debug.buffer_edit_timing                = 0.0;
-
     for (ProjectIterator it = IterateProjects(); IsValid(&it); Next(&it))
     {
         if (it.project->associated_buffer_count <= 0)
         {
             DestroyCurrent(&it);
         }
+        else
+        {
+            SyncOpenIndexedFiles(it.project);
+        }
     }
 
     {
@@ -724,6 +751,7 @@ AppUpdateAndRender(Platform *platform_)
         {
             editor->active_project = project;
             platform->SetWorkingDirectory(SplitPath(active_buffer->full_path));
+            FlushDirectoryCache();
         }
 
         String leaf;
@@ -739,4 +767,6 @@ AppUpdateAndRender(Platform *platform_)
         platform->SleepThread(editor->debug.delay);
         editor->debug.delay_frame_count -= 1;
     }
+
+    EndProfilerFrame();
 }
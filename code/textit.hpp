@@ -9,11 +9,14 @@
 #include "textit_platform.hpp"
 #include "textit_intrinsics.hpp"
 #include "textit_shared.hpp"
-#include "textit_introspection_macros.hpp"
 #include "textit_memory.hpp"
 #include "textit_sort.hpp"
 #include "textit_string.hpp"
+#include "textit_introspection_macros.hpp"
 #include "textit_global_state.hpp"
+#include "textit_profiler.hpp"
+#include "textit_latency.hpp"
+#include "textit_memory_stats.hpp"
 #include "textit_math.hpp"
 #include "textit_random.hpp"
 #include "textit_resources.hpp"
@@ -22,6 +25,7 @@
 #include "textit_command.hpp"
 #include "textit_theme.hpp"
 #include "textit_glyph_cache.hpp"
+#include "textit_blit.hpp"
 #include "textit_render.hpp"
 #include "textit_tokens.hpp"
 #include "textit_language.hpp"
@@ -29,6 +33,8 @@
 #include "textit_buffer.hpp"
 #include "textit_tokenizer.hpp"
 #include "textit_tags.hpp"
+#include "textit_file_walker.hpp"
+#include "textit_directory_cache.hpp"
 #include "textit_project.hpp"
 #include "textit_view.hpp"
 #include "textit_window.hpp"
@@ -64,8 +70,14 @@ enum EditMode
     X(_, int,    indent_width,                    4)                  \
     X(_, bool,   syntax_highlighting,             true)               \
     X(_, bool,   debug_show_glyph_cache,          false)              \
+    X(_, int,    glyph_cache_max_megabytes,       32)                 \
     X(_, bool,   debug_show_line_index,           false)              \
     X(_, bool,   debug_show_jump_history,         false)              \
+    X(_, bool,   debug_show_profiler,             false)              \
+    X(_, bool,   debug_show_memory,               false)              \
+    X(_, int,    profiler_frames,                 8)                  \
+    X(_, int,    slow_frame_budget_ms,            32)                 \
+    X(_, int,    directory_cache_ttl_ms,          2000)               \
     X(_, String, font_name,                       "Consolas"_str)     \
     X(_, int,    font_size,                       15)                 \
     X(_, bool,   use_cached_cleartype_blend,      true)               \
@@ -84,13 +96,14 @@ struct EditorState
     Arena transient_arena;
     Arena undo_scratch;
 
-    Heap *heap;
+    SizeClassHeap *heap;
 
     Arena command_arena;
 
     Theme *first_theme;
     Theme *last_theme;
     Theme *theme;
+    ThemePalette theme_palette;
 
     InputMode input_mode;
     bool suppress_text_event;
@@ -170,13 +183,6 @@ struct EditorState
         int delay;
         int delay_frame_count;
         int allocated_window_count;
-
-        double line_index_insert_timing;
-        double line_index_lookup_timing;
-        int64_t line_index_lookup_count;
-        int64_t line_index_lookup_recursion_count;
-
-        double buffer_edit_timing;
     } debug;
 };
 static EditorState *editor;
@@ -45,116 +45,178 @@ struct IndentationResult
     Range old_range;
 };
 
-function void
-GetIndentationForLine(Buffer *buffer, int64_t line, IndentationResult *result)
+function IndentRule
+GetAnchorRule(IndentRules *rules, Token anchor, Token override_anchor)
 {
-    ZeroStruct(result);
-    if (!LineIsInBuffer(buffer, line))
-    {
-        return;
-    }
-
-    IndentRules *rules = buffer->indent_rules;
-
-    LineInfo info;
-    FindLineInfoByLine(buffer, line, &info);
-
-    int64_t line_start           = info.range.start;
-    int64_t line_end             = info.range.end;
-    int64_t first_non_whitespace = FindFirstNonHorzWhitespace(buffer, line_start);
-
-    TokenIterator it = IterateTokens(buffer, first_non_whitespace);
-
-    bool force_left = false;
-
-    Token first_token = it.token;
-    if (first_token.pos < line_end)
-    {
-        force_left = !!(rules->table[first_token.kind] & IndentRule_ForceLeft);
-    }
-    else
+    IndentRule result = rules->table[anchor.kind];
+    if (override_anchor.kind)
     {
-        first_token.kind = Token_None;
+        result = rules->unfinished_statement;
     }
+    return result;
+}
 
-    Arena *arena = platform->GetTempArena();
-    ScopedMemory temp(arena);
+function void
+FindIndentContext(Buffer *buffer, int64_t line_start, IndentContext *context)
+{
+    ZeroStruct(context);
 
-    int nest_stack_at = 0;
-    TokenKind *nest_stack = PushArrayNoClear(arena, 257, TokenKind) + 1;
+    IndentRules *rules = buffer->indent_rules;
 
+    // NOTE: The anchor is the innermost nest that is still open at the start of the line,
+    // which the nest index in the line index can tell us without walking back over every token
     Token anchor = {};
-    Token t      = Prev(&it);
-
-    while (t.kind)
+    for (int kind = 0; kind < NestKind_COUNT; kind += 1)
     {
-        if (t.pos >= line_end) goto next;
-        if (t.pos >= line_start) goto next;
-        if (t.flags & TokenFlag_IsComment) goto next;
-
-        IndentRule rule = rules->table[t.kind];
-        if (rule & IndentRule_PopIndent)
+        int64_t opener_pos = FindEnclosingNestOpener(buffer, line_start, (NestKind)kind);
+        if (opener_pos >= 0 && (!anchor.kind || opener_pos > anchor.pos))
         {
-            if (nest_stack_at < 256)
+            Token opener = GetTokenAt(buffer, opener_pos);
+            if (rules->table[opener.kind] & IndentRule_PushIndent)
             {
-                nest_stack[nest_stack_at++] = GetOtherNestTokenKind(t.kind);
-            }
-            else
-            {
-                INVALID_CODE_PATH;
+                anchor = opener;
             }
         }
-        else if (rule & IndentRule_PushIndent)
+    }
+
+    Token override_anchor = {};
+
+    // look back for an unfinished statement between the anchor and this line, which is the first
+    // token that ends a line without ending the statement since the last statement end
+    if (!(rules->table[anchor.kind] & IndentRule_Hanging))
+    {
+        TokenIterator it = IterateTokens(buffer, FindFirstNonHorzWhitespace(buffer, line_start));
+
+        int64_t anchor_end = (anchor.kind ? anchor.pos + anchor.length : 0);
+        for (Token t = Prev(&it); t.kind && t.pos >= anchor_end; t = Prev(&it))
         {
-            if (nest_stack[nest_stack_at - 1] == t.kind)
+            if (t.pos >= line_start) continue;
+
+            IndentRule rule = rules->table[t.kind];
+            if (rule & IndentRule_StatementEnd)
             {
-                nest_stack_at -= 1;
+                break;
             }
-            else
+
+            if ((t.flags & TokenFlag_LastInLine) &&
+                !(t.flags & TokenFlag_IsComment) &&
+                !(rule & IndentRule_AffectsIndent))
             {
-                anchor = t;
-                break;
+                override_anchor = t;
             }
         }
-
-next:
-        t = Prev(&it);
     }
 
-    Token override_anchor = {};
-    IndentRule override_rule = 0;
+    context->anchor      = (override_anchor.kind ? override_anchor : anchor);
+    context->anchor_rule = GetAnchorRule(rules, anchor, override_anchor);
+}
 
-    IndentRule anchor_rule = rules->table[anchor.kind];
+function void
+InvalidateIndentCache(Buffer *buffer)
+{
+    buffer->indent_cache_generation += 1;
+    buffer->indent_cache_oldest_generation = buffer->indent_cache_generation;
+    buffer->indent_cache_edit_count = 0;
+}
+
+function void
+InvalidateIndentCacheFromLine(Buffer *buffer, int64_t line)
+{
+    buffer->indent_cache_generation += 1;
 
-    // now we have the anchor to start with, do a forward pass for finding unfinished statements,
-    // I am too stupid to do this logic in the reverse pass (or it's actually just not practical)
-    for (;;)
+    // NOTE: Earlier edits below this one can't invalidate anything this one doesn't
+    while (buffer->indent_cache_edit_count > 0 &&
+           buffer->indent_cache_edits[buffer->indent_cache_edit_count - 1].line >= line)
     {
-        t = Next(&it);
-        if (!t.kind) break;
+        buffer->indent_cache_edit_count -= 1;
+    }
 
-        if (t.pos >= line_start) break;
+    if (buffer->indent_cache_edit_count == INDENT_CACHE_EDIT_COUNT)
+    {
+        // NOTE: Out of room, so anything cached before the oldest edit we're forgetting about is thrown out
+        buffer->indent_cache_oldest_generation = buffer->indent_cache_edits[0].generation;
+        MoveArray(&buffer->indent_cache_edits[1], &buffer->indent_cache_edits[INDENT_CACHE_EDIT_COUNT], &buffer->indent_cache_edits[0]);
+        buffer->indent_cache_edit_count -= 1;
+    }
 
-        IndentRule rule = rules->table[t.kind];
-        // Super whacky unfinished statement detection
-        if (!(anchor_rule & IndentRule_Hanging) &&
-            !override_anchor.kind &&
-            (t.flags & TokenFlag_LastInLine) &&
-            !(t.flags & TokenFlag_IsComment) &&
-            !(rule & IndentRule_StatementEnd) &&
-            !(rule & IndentRule_AffectsIndent))
-        {
-            override_anchor = t;
-            override_rule   = rules->unfinished_statement;
-        }
+    IndentCacheEdit *edit = &buffer->indent_cache_edits[buffer->indent_cache_edit_count++];
+    edit->generation = buffer->indent_cache_generation;
+    edit->line       = line;
+}
+
+// NOTE: A line's context only depends on what comes before it, so it stays good until
+// there's an edit on or above the line
+function bool
+IsIndentContextCached(Buffer *buffer, int64_t line, LineData *data)
+{
+    uint32_t generation = data->indent_generation;
+    if (generation < buffer->indent_cache_oldest_generation)
+    {
+        return false;
+    }
 
-        if (rule & IndentRule_StatementEnd)
+    // NOTE: The first edit made since the context was cached is the one highest up
+    for (int i = 0; i < buffer->indent_cache_edit_count; i += 1)
+    {
+        IndentCacheEdit *edit = &buffer->indent_cache_edits[i];
+        if (edit->generation > generation)
         {
-            override_anchor.kind = Token_None;
+            return line < edit->line;
         }
     }
 
-    if (override_anchor.kind) anchor = override_anchor;
+    return true;
+}
+
+function void
+StoreIndentContext(Buffer *buffer, LineData *data, IndentContext *context)
+{
+    data->indent_anchor      = context->anchor;
+    data->indent_anchor_rule = context->anchor_rule;
+    data->indent_generation  = buffer->indent_cache_generation;
+}
+
+function void
+GetIndentContext(Buffer *buffer, LineInfo *info, IndentContext *context)
+{
+    LineData *data = info->data;
+    if (IsIndentContextCached(buffer, info->line, data))
+    {
+        context->anchor      = data->indent_anchor;
+        context->anchor_rule = data->indent_anchor_rule;
+    }
+    else
+    {
+        FindIndentContext(buffer, info->range.start, context);
+        StoreIndentContext(buffer, data, context);
+    }
+}
+
+function void
+ComputeIndentation(Buffer *buffer, Range line_range, IndentContext *context, IndentationResult *result)
+{
+    ZeroStruct(result);
+
+    IndentRules *rules = buffer->indent_rules;
+
+    int64_t line_start           = line_range.start;
+    int64_t line_end             = line_range.end;
+    int64_t first_non_whitespace = FindFirstNonHorzWhitespace(buffer, line_start);
+
+    bool force_left = false;
+
+    Token first_token = GetTokenAt(buffer, first_non_whitespace);
+    if (first_token.kind && first_token.pos < line_end)
+    {
+        force_left = !!(rules->table[first_token.kind] & IndentRule_ForceLeft);
+    }
+    else
+    {
+        first_token.kind = Token_None;
+    }
+
+    Token      anchor      = context->anchor;
+    IndentRule anchor_rule = context->anchor_rule;
 
     int64_t indent_width = core_config->indent_width;
     int64_t indent       = 0;
@@ -199,12 +261,6 @@ next:
 
         indent = indent_depth;
 
-        anchor_rule = rules->table[anchor.kind];
-        if (override_anchor.kind)
-        {
-            anchor_rule = override_rule;
-        }
-
         if (anchor_rule & IndentRule_PushIndent)
         {
             if (anchor_rule & IndentRule_Hanging)
@@ -269,6 +325,426 @@ next:
     result->old_range = MakeRange(line_start, first_non_whitespace);
 }
 
+function void
+GetIndentationForLine(Buffer *buffer, int64_t line, IndentationResult *result)
+{
+    ZeroStruct(result);
+    if (!LineIsInBuffer(buffer, line))
+    {
+        return;
+    }
+
+    LineInfo info;
+    FindLineInfoByLine(buffer, line, &info);
+
+    IndentContext context;
+    GetIndentContext(buffer, &info, &context);
+
+    ComputeIndentation(buffer, info.range, &context, result);
+}
+
+function String
+PushIndentationString(Arena *arena, IndentationResult *indentation)
+{
+    String result = PushStringSpace(arena, indentation->tabs + indentation->spaces);
+
+    size_t at = 0;
+    for (int64_t i = 0; i < indentation->tabs; i += 1)
+    {
+        result.data[at++] = '\t';
+    }
+    for (int64_t i = 0; i < indentation->spaces; i += 1)
+    {
+        result.data[at++] = ' ';
+    }
+    Assert(at == result.size);
+
+    return result;
+}
+
+//
+// Reindent Range
+//
+
+#define INDENT_PASS_MAX_DEPTH 256
+
+struct IndentPassNests
+{
+    int   depth;
+    Token stack[INDENT_PASS_MAX_DEPTH];
+};
+
+struct ReindentedLine
+{
+    Range   range;
+    int64_t first_non_whitespace;
+    int64_t new_start;
+    String  indentation;
+};
+
+function int64_t
+RemapReindentedPosition(Slice<ReindentedLine> lines, Range span, int64_t delta, int64_t pos)
+{
+    if (pos <  span.start) return pos;
+    if (pos >= span.end)   return pos + delta;
+
+    size_t lo = 0;
+    size_t hi = lines.count;
+    while (hi - lo > 1)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (lines[mid].range.start <= pos)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    ReindentedLine *line = &lines[lo];
+
+    int64_t result;
+    if (pos < line->first_non_whitespace)
+    {
+        result = line->new_start + Min(pos - line->range.start, (int64_t)line->indentation.size);
+    }
+    else
+    {
+        result = line->new_start + (int64_t)line->indentation.size + (pos - line->first_non_whitespace);
+    }
+    return result;
+}
+
+struct RemappedCursor
+{
+    Cursor   *cursor;
+    int64_t   pos;
+    Selection selection;
+};
+
+// NOTE: Re-indents lines line_range.start up to and including line_range.end. Instead of finding
+// the anchor for every line from scratch, the nest stack and unfinished statement state are carried
+// forward through the range in one pass, and all the changes go in as a single edit.
+function void
+ReindentRange(Buffer *buffer, Range line_range)
+{
+    int64_t first_line = line_range.start;
+    int64_t last_line  = Min(line_range.end, GetLineCount(buffer) - 1);
+    if (first_line < 0) first_line = 0;
+    if (first_line > last_line)
+    {
+        return;
+    }
+
+    IndentRules *rules = buffer->indent_rules;
+
+    ScopedMemory temp;
+
+    LineIndexIterator line_it = IterateLineIndexFromLine(buffer, first_line);
+    int64_t pass_start = line_it.range.start;
+
+    //
+    // Seed the nest stacks with every nest that's open at the start of the range
+    //
+
+    IndentPassNests *nests = PushArray(temp, NestKind_COUNT, IndentPassNests);
+    for (int kind = 0; kind < NestKind_COUNT; kind += 1)
+    {
+        IndentPassNests *nest = &nests[kind];
+
+        int64_t pos = pass_start;
+        while (nest->depth < INDENT_PASS_MAX_DEPTH)
+        {
+            int64_t opener_pos = FindEnclosingNestOpener(buffer, pos, (NestKind)kind);
+            if (opener_pos < 0) break;
+
+            nest->stack[nest->depth++] = GetTokenAt(buffer, opener_pos);
+            pos = opener_pos;
+        }
+
+        // we found them innermost first
+        for (int i = 0; i < nest->depth / 2; i += 1)
+        {
+            Swap(nest->stack[i], nest->stack[nest->depth - i - 1]);
+        }
+    }
+
+    //
+    // Seed the line ending tokens that might make for an unfinished statement
+    //
+
+    // NOTE: Like FindIndentContext, this only looks back as far as the anchor of the first line. The
+    // tokens before that are only known about once a statement end has been passed in the range.
+    Token seed_anchor = {};
+    for (int kind = 0; kind < NestKind_COUNT; kind += 1)
+    {
+        IndentPassNests *nest = &nests[kind];
+        if (nest->depth > 0)
+        {
+            Token opener = nest->stack[nest->depth - 1];
+            if ((!seed_anchor.kind || opener.pos > seed_anchor.pos) &&
+                (rules->table[opener.kind] & IndentRule_PushIndent))
+            {
+                seed_anchor = opener;
+            }
+        }
+    }
+
+    int64_t unfinished_known_from = (seed_anchor.kind ? seed_anchor.pos + seed_anchor.length : 0);
+
+    size_t seed_count = 0;
+    {
+        TokenIterator it = IterateTokens(buffer, FindFirstNonHorzWhitespace(buffer, pass_start));
+        for (Token t = Prev(&it); t.kind && t.pos >= unfinished_known_from; t = Prev(&it))
+        {
+            if (t.pos >= pass_start) continue;
+
+            IndentRule rule = rules->table[t.kind];
+            if (rule & IndentRule_StatementEnd)
+            {
+                unfinished_known_from = 0;
+                break;
+            }
+
+            if ((t.flags & TokenFlag_LastInLine) &&
+                !(t.flags & TokenFlag_IsComment) &&
+                !(rule & IndentRule_AffectsIndent))
+            {
+                seed_count += 1;
+            }
+        }
+    }
+
+    // NOTE: Every line adds at most one token
+    size_t unfinished_capacity = seed_count + (size_t)(last_line - first_line + 1);
+    Token *unfinished = PushArrayNoClear(temp, unfinished_capacity, Token);
+    size_t unfinished_count = seed_count;
+
+    {
+        size_t at = seed_count;
+
+        TokenIterator it = IterateTokens(buffer, FindFirstNonHorzWhitespace(buffer, pass_start));
+        for (Token t = Prev(&it); t.kind && at > 0; t = Prev(&it))
+        {
+            if (t.pos >= pass_start) continue;
+
+            IndentRule rule = rules->table[t.kind];
+            if ((t.flags & TokenFlag_LastInLine) &&
+                !(t.flags & TokenFlag_IsComment) &&
+                !(rule & IndentRule_AffectsIndent))
+            {
+                unfinished[--at] = t;
+            }
+        }
+    }
+
+    //
+    // Forward pass
+    //
+
+    Slice<ReindentedLine> lines = PushSlice(temp, (size_t)(last_line - first_line + 1), ReindentedLine);
+
+    int64_t first_changed = -1;
+    int64_t last_changed  = -1;
+
+    TokenIterator it = IterateTokens(buffer, pass_start);
+    for (int64_t line = first_line; line <= last_line; line += 1, Next(&line_it))
+    {
+        Range range = line_it.range;
+
+        IndentContext context = {};
+
+        bool anchor_known = true;
+
+        Token anchor = {};
+        for (int kind = 0; kind < NestKind_COUNT; kind += 1)
+        {
+            IndentPassNests *nest = &nests[kind];
+            if (nest->depth > INDENT_PASS_MAX_DEPTH)
+            {
+                anchor_known = false;
+            }
+            else if (nest->depth > 0)
+            {
+                Token opener = nest->stack[nest->depth - 1];
+                if ((!anchor.kind || opener.pos > anchor.pos) &&
+                    (rules->table[opener.kind] & IndentRule_PushIndent))
+                {
+                    anchor = opener;
+                }
+            }
+        }
+
+        int64_t anchor_end = (anchor.kind ? anchor.pos + anchor.length : 0);
+        bool    hanging    = !!(rules->table[anchor.kind] & IndentRule_Hanging);
+
+        // NOTE: The anchor moved out past where the unfinished tokens were seeded from
+        if (!hanging && anchor_end < unfinished_known_from)
+        {
+            anchor_known = false;
+        }
+
+        if (anchor_known)
+        {
+            Token override_anchor = {};
+            if (!hanging)
+            {
+                // first line ending token after both the anchor and the last statement end
+                size_t lo = 0;
+                size_t hi = unfinished_count;
+                while (lo < hi)
+                {
+                    size_t mid = lo + (hi - lo) / 2;
+                    if (unfinished[mid].pos < anchor_end)
+                    {
+                        lo = mid + 1;
+                    }
+                    else
+                    {
+                        hi = mid;
+                    }
+                }
+
+                if (lo < unfinished_count)
+                {
+                    override_anchor = unfinished[lo];
+                }
+            }
+
+            context.anchor      = (override_anchor.kind ? override_anchor : anchor);
+            context.anchor_rule = GetAnchorRule(rules, anchor, override_anchor);
+        }
+        else
+        {
+            FindIndentContext(buffer, range.start, &context);
+        }
+
+        StoreIndentContext(buffer, &line_it.record->data, &context);
+
+        IndentationResult indentation;
+        ComputeIndentation(buffer, range, &context, &indentation);
+
+        ReindentedLine *reindented = &lines[line - first_line];
+        reindented->range                = range;
+        reindented->first_non_whitespace = indentation.old_range.end;
+        reindented->indentation          = PushIndentationString(temp, &indentation);
+
+        String old_indentation = MakeString(RangeSize(indentation.old_range), buffer->text + indentation.old_range.start);
+        if (!AreEqual(old_indentation, reindented->indentation))
+        {
+            if (first_changed < 0) first_changed = line;
+            last_changed = line;
+        }
+
+        // carry the state over this line's tokens
+        for (; IsValid(&it) && it.token.pos < range.end; Next(&it))
+        {
+            Token t = it.token;
+
+            IndentRule rule = rules->table[t.kind];
+            if (rule & IndentRule_StatementEnd)
+            {
+                unfinished_count      = 0;
+                unfinished_known_from = 0;
+            }
+            else if ((t.flags & TokenFlag_LastInLine) &&
+                     !(t.flags & TokenFlag_IsComment) &&
+                     !(rule & IndentRule_AffectsIndent))
+            {
+                Assert(unfinished_count < unfinished_capacity);
+                unfinished[unfinished_count++] = t;
+            }
+
+            NestKind kind = GetNestKind(t.kind);
+            if (kind != NestKind_None)
+            {
+                IndentPassNests *nest = &nests[kind];
+
+                int delta = GetNestDelta(&t, kind);
+                if (delta > 0)
+                {
+                    if (nest->depth < INDENT_PASS_MAX_DEPTH)
+                    {
+                        nest->stack[nest->depth] = t;
+                    }
+                    nest->depth += 1;
+                }
+                else if (delta < 0 && nest->depth > 0)
+                {
+                    nest->depth -= 1;
+                }
+            }
+        }
+    }
+
+    if (first_changed < 0)
+    {
+        return;
+    }
+
+    //
+    // Build the replacement text for the lines that changed
+    //
+
+    Slice<ReindentedLine> changed = MakeSlice((size_t)(last_changed - first_changed + 1), &lines[first_changed - first_line]);
+
+    Range span = MakeRange(changed[0].range.start, changed[changed.count - 1].range.end);
+
+    StringList text = MakeStringList(temp);
+
+    int64_t new_pos = span.start;
+    for (ReindentedLine &line: changed)
+    {
+        String rest = MakeString(line.range.end - line.first_non_whitespace, buffer->text + line.first_non_whitespace);
+        PushNoCopy(&text, line.indentation);
+        PushNoCopy(&text, rest);
+
+        line.new_start = new_pos;
+        new_pos += (int64_t)(line.indentation.size + rest.size);
+    }
+
+    int64_t delta = new_pos - span.end;
+
+    // NOTE: Replacing the whole span would drag every cursor inside it to the start, so they
+    // get moved to where they belong in the reindented lines instead
+    size_t cursor_count = 0;
+    for (ViewIterator view_it = IterateViews(); IsValid(&view_it); Next(&view_it))
+    {
+        for (Cursor *cursor = IterateCursors(view_it.view->id, buffer->id); cursor; cursor = cursor->next)
+        {
+            cursor_count += 1;
+        }
+    }
+
+    RemappedCursor *remapped = PushArray(temp, cursor_count, RemappedCursor);
+
+    size_t remapped_count = 0;
+    for (ViewIterator view_it = IterateViews(); IsValid(&view_it); Next(&view_it))
+    {
+        for (Cursor *cursor = IterateCursors(view_it.view->id, buffer->id); cursor; cursor = cursor->next)
+        {
+            RemappedCursor *entry = &remapped[remapped_count++];
+            entry->cursor                = cursor;
+            entry->pos                   = RemapReindentedPosition(changed, span, delta, cursor->pos);
+            entry->selection.inner.start = RemapReindentedPosition(changed, span, delta, cursor->selection.inner.start);
+            entry->selection.inner.end   = RemapReindentedPosition(changed, span, delta, cursor->selection.inner.end);
+            entry->selection.outer.start = RemapReindentedPosition(changed, span, delta, cursor->selection.outer.start);
+            entry->selection.outer.end   = RemapReindentedPosition(changed, span, delta, cursor->selection.outer.end);
+        }
+    }
+
+    BufferReplaceRange(buffer, span, FlattenStringOnArena(&text, temp));
+
+    for (size_t i = 0; i < remapped_count; i += 1)
+    {
+        RemappedCursor *entry = &remapped[i];
+        entry->cursor->pos       = entry->pos;
+        entry->cursor->selection = entry->selection;
+    }
+}
+
 function int64_t
 AutoIndentLineAt(Buffer *buffer, int64_t pos)
 {
@@ -280,18 +756,7 @@ AutoIndentLineAt(Buffer *buffer, int64_t pos)
     IndentationResult indentation;
     GetIndentationForLine(buffer, loc.line, &indentation);
 
-    String string = PushStringSpace(platform->GetTempArena(), indentation.tabs + indentation.spaces);
-
-    size_t at = 0;
-    for (int64_t i = 0; i < indentation.tabs; i += 1)
-    {
-        string.data[at++] = '\t';
-    }
-    for (int64_t i = 0; i < indentation.spaces; i += 1)
-    {
-        string.data[at++] = ' ';
-    }
-    Assert(at == string.size);
+    String string = PushIndentationString(platform->GetTempArena(), &indentation);
 
     int64_t result = BufferReplaceRange(buffer, indentation.old_range, string);
     return result;
@@ -21,4 +21,15 @@ struct IndentRules
     IndentRule table[Token_COUNT];
 };
 
+// NOTE: What the indentation of a line hangs off of, this only depends on the text before the line
+struct IndentContext
+{
+    Token      anchor;
+    IndentRule anchor_rule;
+};
+
+function void InvalidateIndentCache(Buffer *buffer);
+function void InvalidateIndentCacheFromLine(Buffer *buffer, int64_t line);
+function void ReindentRange(Buffer *buffer, Range line_range);
+
 #endif /* TEXTIT_AUTO_INDENT_HPP */
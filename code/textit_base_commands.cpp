@@ -2,6 +2,8 @@ COMMAND_PROC(ReportMetrics,
              "Report some metrics relevant to development"_str)
 {
     Buffer *buffer = GetActiveBuffer();
+    if (!IsBufferLoaded(buffer)) return;
+
     size_t buffer_bytes = buffer->count;
 
     Project *project = buffer->project;
@@ -44,6 +46,7 @@ COMMAND_PROC(ReportMetrics,
     for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
     {
         if (it.buffer->project != project) continue;
+        if (!IsBufferLoaded(it.buffer)) continue;
 
         Tags *tags = it.buffer->tags;
         for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
@@ -65,9 +68,13 @@ COMMAND_PROC(ReportMetrics,
 COMMAND_PROC(ResetGlyphCache,
              "Reset the glyph cache"_str)
 {
-    ClearBitmap(&render_state->glyph_texture.bitmap);
-    uint32_t size = render_state->glyph_cache.size;
-    ResizeGlyphCache(&render_state->glyph_cache, size);
+    ResetGlyphCache();
+}
+
+COMMAND_PROC(BenchmarkBlitKernels,
+             "Benchmark the blit kernels on a full screen of cached glyphs, results go to the log"_str)
+{
+    RunBlitBenchmark(16);
 }
 
 COMMAND_PROC(ValidateLineIndex,
@@ -80,12 +87,22 @@ COMMAND_PROC(LoadDefaultIndentRules,
              "Load the default indent rules for the current buffer"_str)
 {
     LoadDefaultIndentRules(&editor->default_indent_rules);
+
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        InvalidateIndentCache(it.buffer);
+    }
 }
 
 COMMAND_PROC(LoadOtherIndentRules,
              "Load the other indent rules for the current buffer"_str)
 {
     LoadOtherIndentRules(&editor->default_indent_rules);
+
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        InvalidateIndentCache(it.buffer);
+    }
 }
 
 COMMAND_PROC(EnterCommandLineMode)
@@ -93,21 +110,15 @@ COMMAND_PROC(EnterCommandLineMode)
     CommandLine *cl = BeginCommandLine();
     cl->name = "Command"_str;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
         for (size_t i = 0; i < command_list->command_count; i += 1)
         {
             Command *command = &command_list->commands[i];
             if ((command->kind == Command_Basic) &&
-                (command->flags & Command_Visible) &&
-                (FindSubstring(command->name, string, StringMatch_CaseInsensitive) != command->name.size))
+                (command->flags & Command_Visible))
             {
-                if (!AddPrediction(cl, MakePrediction(command->name)))
-                {
-                    break;
-                }
+                AddCandidate(cl, MakePrediction(command->name));
             }
         }
     };
@@ -150,74 +161,67 @@ COMMAND_PROC(OpenBuffer,
         }
 
         String leaf;
-        String path = SplitPath(string, &leaf);
-
-        String ext;
-        String name = SplitExtension(leaf, &ext);
-
-        // FindSubstring implementation is limited to patterns smaller than bit count of size_t
-        // so for now I'll just do this, but this should be handled by the function instead.
-        size_t size_bits = 8*sizeof(size_t);
-        if (ext.size  >= size_bits) ext.size  = size_bits - 1;
-        if (name.size >= size_bits) name.size = size_bits - 1;
+        SplitPath(string, &leaf);
 
         for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
         {
             Buffer *buffer = it.buffer;
             if (!show_hidden && buffer->project != active_project) continue;
 
-            String test_ext = {};
-            String test_name = buffer->name;
-            if (ext.size)
+            int score = FuzzyMatch(buffer->name, leaf);
+            if (score > 0)
             {
-                test_name = SplitExtension(test_name, &test_ext);
-            }
-
-            if (string.size == 0 ||
-                (FindSubstring(test_name, name, StringMatch_CaseInsensitive) != test_name.size &&
-                 (!ext.size || FindSubstring(test_ext, ext, StringMatch_CaseInsensitive) != test_ext.size)))
-            {
-                bool non_standard_language = (buffer->language != buffer->inferred_language);
-
                 Prediction prediction = {};
-                prediction.text = buffer->name;
+                prediction.text     = buffer->name;
 				prediction.userdata = buffer;
-                // TODO: Undumb
                 if (buffer->project != active_project)
                 {
-                    if (non_standard_language)
-                    {
-                        prediction.preview_text = PushTempStringF("%-32.*s (language: %.*s) - (%.*s)", 
-                                                                  StringExpand(buffer->name), 
-                                                                  StringExpand(buffer->language->name), 
-                                                                  StringExpand(buffer->project->root));
-                    }
-                    else
-                    {
-                        prediction.preview_text = PushTempStringF("%-32.*s - (%.*s)", 
-                                                                  StringExpand(buffer->name), 
-                                                                  StringExpand(buffer->project->root));
-                    }
                     prediction.color = "command_line_option_directory"_id;
                 }
-                else if (non_standard_language)
-                {
-                    prediction.preview_text = PushTempStringF("%.*s (language: %.*s)", 
-                                                              StringExpand(buffer->name), 
-                                                              StringExpand(buffer->language->name));
-                }
+                AddPrediction(cl, prediction, FuzzyMatchSortKey(score));
+            }
+        }
+    };
 
-                if (!AddPrediction(cl, prediction))
-                {
-                    break;
-                }
+    cl->FormatPreviewText = [](CommandLine *cl, Prediction *prediction)
+    {
+        Buffer *buffer = (Buffer *)prediction->userdata;
+        Project *active_project = GetActiveBuffer()->project;
+
+        bool non_standard_language = (buffer->language != buffer->inferred_language);
+
+        String result = prediction->text;
+        // TODO: Undumb
+        if (buffer->project != active_project)
+        {
+            if (non_standard_language)
+            {
+                result = PushTempStringF("%-32.*s (language: %.*s) - (%.*s)", 
+                                         StringExpand(buffer->name), 
+                                         StringExpand(buffer->language->name), 
+                                         StringExpand(buffer->project->root));
             }
+            else
+            {
+                result = PushTempStringF("%-32.*s - (%.*s)", 
+                                         StringExpand(buffer->name), 
+                                         StringExpand(buffer->project->root));
+            }
+        }
+        else if (non_standard_language)
+        {
+            result = PushTempStringF("%.*s (language: %.*s)", 
+                                     StringExpand(buffer->name), 
+                                     StringExpand(buffer->language->name));
         }
+        return result;
     };
 
     cl->AcceptEntry = [](CommandLine *cl)
     {
 		Prediction *prediction = GetPrediction(cl);
+		if (!prediction) return false;
+
 		Buffer *buffer = (Buffer *)prediction->userdata;
         View *view = GetActiveView();
         view->next_buffer = buffer->id;
@@ -240,52 +244,63 @@ COMMAND_PROC(OpenFile,
         String leaf;
         String path = SplitPath(string, &leaf);
 
-        String ext;
-        String name = SplitExtension(leaf, &ext);
-
-        // FindSubstring implementation is limited to patterns smaller than bit count of size_t
-        // so for now I'll just do this
-        size_t size_bits = 8*sizeof(size_t);
-        if (ext.size  >= size_bits) ext.size  = size_bits - 1;
-        if (name.size >= size_bits) name.size = size_bits - 1;
-
         char *separator = "/";
         if (PeekEnd(path) == '\\') separator = "\\";
 
-        for (PlatformFileIterator *it = platform->FindFiles(platform->GetTempArena(), path);
-             platform->FileIteratorIsValid(it);
-             platform->FileIteratorNext(it))
+        // NOTE: The directories that match best are where the user is most likely headed next, so their
+        // listings get prefetched to be ready by the time the separator is typed
+        const int prefetch_count = 4;
+        DirectoryEntry *prefetch[prefetch_count] = {};
+        int prefetch_scores[prefetch_count] = {};
+
+        DirectoryListing *listing = GetDirectoryListing(path);
+        for (size_t i = 0; i < listing->entry_count; i += 1)
         {
-            if (AreEqual(it->info.name, "."_str) ||
-                AreEqual(it->info.name, ".."_str))
-            {
-                continue;
-            }
+            DirectoryEntry *entry = &listing->entries[i];
 
-            String test_ext = {};
-            String test_name = it->info.name;
-            if (ext.size)
+            int score = FuzzyMatch(entry->name, leaf);
+            if (score > 0)
             {
-                test_name = SplitExtension(test_name, &test_ext);
-            }
+                if (entry->directory)
+                {
+                    DirectoryEntry *insert_entry = entry;
+                    int insert_score = score;
+                    for (int j = 0; j < prefetch_count; j += 1)
+                    {
+                        if (insert_score > prefetch_scores[j])
+                        {
+                            Swap(prefetch[j], insert_entry);
+                            Swap(prefetch_scores[j], insert_score);
+                        }
+                    }
+                }
 
-            if (FindSubstring(test_name, name, StringMatch_CaseInsensitive) != test_name.size &&
-                (!ext.size || FindSubstring(test_ext, ext, StringMatch_CaseInsensitive) != test_ext.size))
-            {
                 Prediction prediction = {};
-                prediction.text         = PushTempStringF("%.*s%.*s%s", StringExpand(path), StringExpand(it->info.name), it->info.directory ? separator : "");
-                prediction.preview_text = PushTempStringF("%.*s%s", StringExpand(it->info.name), it->info.directory ? separator : "");
-                if (it->info.directory)
+                prediction.text = PushTempStringF("%.*s%.*s%s", StringExpand(path), StringExpand(entry->name), entry->directory ? separator : "");
+                if (entry->directory)
                 {
                     prediction.incomplete = true;
                     prediction.color      = "command_line_option_directory"_id;
                 }
-                if (!AddPrediction(cl, prediction))
-                {
-                    break;
-                }
+                AddPrediction(cl, prediction, FuzzyMatchSortKey(score));
             }
         }
+
+        // NOTE: Every prediction starts with the same path, the preview text leaves it off
+        cl->userdata = IntToPointer(path.size);
+
+        for (int i = 0; i < prefetch_count; i += 1)
+        {
+            if (prefetch[i])
+            {
+                PrefetchDirectoryListing(PushTempStringF("%.*s%.*s%s", StringExpand(path), StringExpand(prefetch[i]->name), separator));
+            }
+        }
+    };
+
+    cl->FormatPreviewText = [](CommandLine *cl, Prediction *prediction)
+    {
+        return Advance(prediction->text, (size_t)PointerToInt(cl->userdata));
     };
 
     cl->AcceptEntry = [](CommandLine *cl)
@@ -328,26 +343,37 @@ COMMAND_PROC(ToggleProjectVisibility,
                 (FindSubstring(project->root, string, StringMatch_CaseInsensitive) != project->root.size))
             {
                 Prediction prediction = {};
-                prediction.text = project->root;
+                prediction.text     = project->root;
+                prediction.userdata = project;
                 if (HasFlag(project->flags, Project_Hidden))
                 {
-                    prediction.preview_text = PushTempStringF("(hidden)  %.*s", StringExpand(project->root));
-                    prediction.color        = "command_line_option_inactive"_id;
+                    prediction.color = "command_line_option_inactive"_id;
                 }
                 else
                 {
-                    prediction.preview_text = PushTempStringF("(visible) %.*s", StringExpand(project->root));
-                    prediction.color        = "command_line_option_active"_id;
-                }
-
-                if (!AddPrediction(cl, prediction))
-                {
-                    break;
+                    prediction.color = "command_line_option_active"_id;
                 }
+                AddPrediction(cl, prediction);
             }
         }
     };
 
+    cl->FormatPreviewText = [](CommandLine *cl, Prediction *prediction)
+    {
+        Project *project = (Project *)prediction->userdata;
+
+        String result = {};
+        if (HasFlag(project->flags, Project_Hidden))
+        {
+            result = PushTempStringF("(hidden)  %.*s", StringExpand(project->root));
+        }
+        else
+        {
+            result = PushTempStringF("(visible) %.*s", StringExpand(project->root));
+        }
+        return result;
+    };
+
     cl->AcceptEntry = [](CommandLine *cl)
     {
         String string = GetCommandString(cl);
@@ -385,31 +411,24 @@ COMMAND_PROC(ChangeWorkingDirectory,
     {
         String string = GetCommandString(cl);
 
-        String path = SplitPath(string);
+        String leaf;
+        String path = SplitPath(string, &leaf);
 
         char *separator = "/";
         if (PeekEnd(path) == '\\') separator = "\\";
 
-        for (PlatformFileIterator *it = platform->FindFiles(platform->GetTempArena(), string);
-             platform->FileIteratorIsValid(it);
-             platform->FileIteratorNext(it))
+        DirectoryListing *listing = GetDirectoryListing(path);
+        for (size_t i = 0; i < listing->entry_count; i += 1)
         {
-            if (AreEqual(it->info.name, "."_str) ||
-                AreEqual(it->info.name, ".."_str))
-            {
-                continue;
-            }
+            DirectoryEntry *entry = &listing->entries[i];
 
-            if (it->info.directory)
+            if (entry->directory && MatchPrefix(entry->name, leaf, StringMatch_CaseInsensitive))
             {
                 Prediction prediction = {};
-                prediction.text         = PushTempStringF("%.*s%.*s%s", StringExpand(path), StringExpand(it->info.name), separator);
-                prediction.preview_text = it->info.name;
+                prediction.text         = PushTempStringF("%.*s%.*s%s", StringExpand(path), StringExpand(entry->name), separator);
+                prediction.preview_text = entry->name;
                 prediction.color        = "command_line_option_directory"_id;
-                if (!AddPrediction(cl, prediction))
-                {
-                    break;
-                }
+                AddPrediction(cl, prediction);
             }
         }
     };
@@ -419,6 +438,7 @@ COMMAND_PROC(ChangeWorkingDirectory,
         String string = GetCommandString(cl);
 
         platform->SetWorkingDirectory(string);
+        FlushDirectoryCache();
         return true;
     };
 }
@@ -429,30 +449,27 @@ COMMAND_PROC(Set,
     CommandLine *cl = BeginCommandLine();
     cl->name = "Set"_str;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
         for (size_t i = 0; i < Introspection<CoreConfig>::member_count; i += 1)
         {
             const MemberInfo *member = &Introspection<CoreConfig>::members[i];
 
-            String name = SplitWord(member->name);
-            if (FindSubstring(name, string, StringMatch_CaseInsensitive) != name.size)
-            {
-                Prediction prediction = {};
-                prediction.text = name;
-
-                String formatted_value = FormatMember(member, GetMemberPointer(core_config, member));
-                prediction.preview_text = PushTempStringF("%-32.*s %.*s", StringExpand(name), StringExpand(formatted_value));
-                if (!AddPrediction(cl, prediction))
-                {
-                    break;
-                }
-            }
+            Prediction prediction = {};
+            prediction.text     = SplitWord(member->name);
+            prediction.userdata = (void *)member;
+            AddCandidate(cl, prediction);
         }
     };
 
+    cl->FormatPreviewText = [](CommandLine *cl, Prediction *prediction)
+    {
+        const MemberInfo *member = (const MemberInfo *)prediction->userdata;
+
+        String formatted_value = FormatMember(member, GetMemberPointer(core_config, member));
+        return PushTempStringF("%-32.*s %.*s", StringExpand(prediction->text), StringExpand(formatted_value));
+    };
+
     cl->AcceptEntry = [](CommandLine *cl)
     {
         String string = GetCommandString(cl);
@@ -511,23 +528,15 @@ COMMAND_PROC(SetLanguage,
     CommandLine *cl = BeginCommandLine();
     cl->name = "Set"_str;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
         for (LanguageSpec *language = language_registry->first_language;
              language;
              language = language->next)
         {
-            if (FindSubstring(language->name, string, StringMatch_CaseInsensitive) != language->name.size)
-            {
-                Prediction prediction = {};
-                prediction.text = language->name;
-                if (!AddPrediction(cl, prediction))
-                {
-                    break;
-                }
-            }
+            Prediction prediction = {};
+            prediction.text = language->name;
+            AddCandidate(cl, prediction);
         }
     };
 
@@ -560,23 +569,19 @@ COMMAND_PROC(SetFont,
     cl->name = "SetFont"_str;
     cl->no_quickselect = true;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
-        ScopedMemory temp;
+        // NOTE: The platform wants a limit up front, this is far more fonts than anyone has installed
+        const uint32_t max_font_count = 16384;
 
         uint32_t font_count;
-        String *filtered_fonts = platform->EnumerateFonts(temp, ArrayCount(cl->predictions) + 1, string, &font_count);
+        String *fonts = platform->EnumerateFonts(&cl->cache_arena, max_font_count, ""_str, &font_count);
 
         for (size_t i = 0; i < font_count; i += 1)
         {
             Prediction prediction = {};
-            prediction.text = filtered_fonts[i];
-            if (!AddPrediction(cl, prediction))
-            {
-                break;
-            }
+            prediction.text = fonts[i];
+            AddCandidate(cl, prediction);
         }
     };
 
@@ -595,23 +600,11 @@ COMMAND_PROC(SetFontQuality,
     CommandLine *cl = BeginCommandLine();
     cl->name = "Font Quality"_str;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
-        String options[] =
-        {
-            "Subpixel"_str,
-            "Greyscale"_str,
-            "Raster"_str,
-        };
-        for (size_t i = 0; i < ArrayCount(options); i += 1)
-        {
-            if (FindSubstring(options[i], string, StringMatch_CaseInsensitive) != options[i].size)
-            {
-                AddPrediction(cl, MakePrediction(options[i]));
-            }
-        }
+        AddCandidate(cl, MakePrediction("Subpixel"_str));
+        AddCandidate(cl, MakePrediction("Greyscale"_str));
+        AddCandidate(cl, MakePrediction("Raster"_str));
     };
 
     cl->AcceptEntry = [](CommandLine *cl)
@@ -659,20 +652,15 @@ COMMAND_PROC(FilesMenu,
     CommandLine *cl = BeginCommandLine();
     cl->name = "Files"_str;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
-        auto AddOption = [string, cl](String option_name, uint8_t quickselect_char, String command_name)
+        auto AddOption = [cl](String option_name, uint8_t quickselect_char, String command_name)
         {
-            if (FindSubstring(option_name, string, StringMatch_CaseInsensitive) != option_name.size)
-            {
-                Prediction pred = {};
-                pred.text             = option_name;
-                pred.quickselect_char = quickselect_char;
-                pred.userdata         = FindCommand(command_name);
-                AddPrediction(cl, pred);
-            }
+            Prediction pred = {};
+            pred.text             = option_name;
+            pred.quickselect_char = quickselect_char;
+            pred.userdata         = FindCommand(command_name);
+            AddCandidate(cl, pred);
         };
 
         AddOption("Close Window"_str, 'Q', "DestroyWindow"_str);
@@ -685,6 +673,8 @@ COMMAND_PROC(FilesMenu,
     {
         String string = GetCommandString(cl);
         Prediction *pred = GetPrediction(cl);
+        if (!pred) return false;
+
         Command *command = (Command *)pred->userdata;
         ExecuteCommand(GetActiveView(), command);
         return true;
@@ -696,29 +686,27 @@ COMMAND_PROC(TagsMenu)
     CommandLine *cl = BeginCommandLine();
     cl->name = "Tags"_str;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
-        auto AddOption = [string, cl](String option_name, uint8_t quickselect_char, String command_name)
+        auto AddOption = [cl](String option_name, uint8_t quickselect_char, String command_name)
         {
-            if (FindSubstring(option_name, string, StringMatch_CaseInsensitive) != option_name.size)
-            {
-                Prediction pred = {};
-                pred.text             = option_name;
-                pred.quickselect_char = quickselect_char;
-                pred.userdata         = FindCommand(command_name);
-                AddPrediction(cl, pred);
-            }
+            Prediction pred = {};
+            pred.text             = option_name;
+            pred.quickselect_char = quickselect_char;
+            pred.userdata         = FindCommand(command_name);
+            AddCandidate(cl, pred);
         };
 
         AddOption("Tag Browser"_str, 'A', "Tags"_str);
+        AddOption("Find References"_str, 'R', "FindReferences"_str);
     };
 
     cl->AcceptEntry = [](CommandLine *cl)
     {
         String string = GetCommandString(cl);
         Prediction *pred = GetPrediction(cl);
+        if (!pred) return false;
+
         Command *command = (Command *)pred->userdata;
         ExecuteCommand(GetActiveView(), command);
         return true;
@@ -731,20 +719,15 @@ COMMAND_PROC(QuickActionMenu,
     CommandLine *cl = BeginCommandLine();
     cl->name = "Quick Action"_str;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
-        auto AddOption = [string, cl](String option_name, uint8_t quickselect_char, String command_name)
+        auto AddOption = [cl](String option_name, uint8_t quickselect_char, String command_name)
         {
-            if (FindSubstring(option_name, string, StringMatch_CaseInsensitive) != option_name.size)
-            {
-                Prediction pred = {};
-                pred.text             = option_name;
-                pred.quickselect_char = quickselect_char;
-                pred.userdata         = FindCommand(command_name);
-                AddPrediction(cl, pred);
-            }
+            Prediction pred = {};
+            pred.text             = option_name;
+            pred.quickselect_char = quickselect_char;
+            pred.userdata         = FindCommand(command_name);
+            AddCandidate(cl, pred);
         };
 
         AddOption("Files"_str, 'F', "FilesMenu"_str);
@@ -755,6 +738,8 @@ COMMAND_PROC(QuickActionMenu,
     {
         String string = GetCommandString(cl);
         Prediction *pred = GetPrediction(cl);
+        if (!pred) return false;
+
         Command *command = (Command *)pred->userdata;
         ExecuteCommand(GetActiveView(), command);
         return true;
@@ -787,74 +772,334 @@ COMMAND_PROC(GoToFileUnderCursor,
     }
 }
 
-COMMAND_PROC(Tags,
-             "Browse tags for all buffers"_str)
+struct TagBrowserEntry
 {
-    CommandLine *cl = BeginCommandLine();
-    cl->name                  = "Tags"_str;
-    cl->sort_by_edit_distance = true;
-    cl->no_quickselect        = true;
+    String name;
+    Tag *tag;
+    IndexedTag *indexed_tag;
+};
 
-    cl->GatherPredictions = [](CommandLine *cl)
+struct TagBrowserCache
+{
+    HashResult key;
+
+    size_t entry_count;
+    TagBrowserEntry *entries;
+};
+
+// NOTE: The entries point at the tags of loaded buffers and hold on to names copied out of them, so the key
+// has to change whenever tags get added, freed or linked into a project, whenever a buffer finishes loading
+// or goes away, and whenever the project index grows
+function HashResult
+GetTagBrowserKey()
+{
+    HashResult result = {};
+    for (ProjectIterator it = IterateProjects(); IsValid(&it); Next(&it))
     {
-        String string = GetCommandString(cl);
+        Project *project = it.project;
+        result = HashIntegers(result, (uint64_t)project->tag_generation, (uint64_t)project->index.file_count);
+    }
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        Buffer *buffer = it.buffer;
+        if (!IsBufferLoaded(buffer)) continue;
+
+        result = HashIntegers(result, (uint32_t)buffer->id.index, (uint32_t)buffer->id.generation, buffer->tags->generation);
+    }
+    return result;
+}
+
+function void
+GatherAllTagBrowserEntries(CommandLine *cl, TagBrowserCache *cache)
+{
+    Arena *arena = &cl->cache_arena;
+    Clear(arena);
+
+    // NOTE: Taken before looking at anything, so if the index grows while we're gathering the key is already
+    // out of date and the next check gathers again
+    cache->key = GetTagBrowserKey();
+
+    size_t entry_count = 0;
+
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        // NOTE: Tags of buffers that are still loading are being parsed, they show up once the buffer is done
+        if (!IsBufferLoaded(it.buffer)) continue;
 
-        // Project *active_project = GetActiveBuffer()->project;
+        Tags *tags = it.buffer->tags;
+        for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
+        {
+            entry_count += 1;
+        }
+    }
 
-        for (BufferIterator it = IterateBuffers();
-             IsValid(&it);
-             Next(&it))
+    for (ProjectIterator it = IterateProjects(); IsValid(&it); Next(&it))
+    {
+        IndexedFile *first_file = it.project->index.first_file;
+        READ_BARRIER;
+
+        for (IndexedFile *file = first_file; file; file = file->next)
         {
-            Buffer *buffer = it.buffer;
-            // TODO: What should da policy be for showing tags from other projects?
-            // if (buffer->project != active_project) continue;
+            if (IsIndexedFileOpen(file)) continue;
+            entry_count += file->tag_count;
+        }
+    }
+
+    cache->entries     = PushArrayNoClear(arena, entry_count, TagBrowserEntry);
+    cache->entry_count = 0;
+
+    // TODO: What should da policy be for showing tags from other projects?
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        Buffer *buffer = it.buffer;
+        if (!IsBufferLoaded(buffer)) continue;
+
+        Tags *tags = buffer->tags;
+        for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
+        {
+            TagBrowserEntry *entry = &cache->entries[cache->entry_count++];
+            entry->name        = PushBufferRange(arena, buffer, MakeRangeStartLength(tag->pos, tag->length));
+            entry->tag         = tag;
+            entry->indexed_tag = nullptr;
+        }
+    }
+
+    for (ProjectIterator it = IterateProjects(); IsValid(&it); Next(&it))
+    {
+        IndexedFile *first_file = it.project->index.first_file;
+        READ_BARRIER;
+
+        for (IndexedFile *file = first_file; file; file = file->next)
+        {
+            if (IsIndexedFileOpen(file)) continue;
 
-            Tags *tags = buffer->tags;
-            for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
+            for (size_t i = 0; i < file->tag_count && cache->entry_count < entry_count; i += 1)
             {
-                ScopedMemory temp;
-                String name = PushBufferRange(temp, buffer, MakeRangeStartLength(tag->pos, tag->length));
-                if (FindSubstring(name, string, StringMatch_CaseInsensitive) != name.size)
-                {
-                    int64_t line = GetLineNumber(buffer, tag->pos);
-                    String kind_name     = GetTagBaseKindName(tag);
-                    String sub_kind_name = GetTagSubKindName(buffer->language, tag);
-                    Prediction prediction = {};
-                    prediction.text         = name;
-                    prediction.preview_text = PushTempStringF("%-48.*s %.*s %.*s -- %.*s (line: %lld)", 
-                                                              StringExpand(name), 
-                                                              StringExpand(sub_kind_name), 
-                                                              StringExpand(kind_name), 
-                                                              StringExpand(buffer->name),
-                                                              line + 1);
-                    prediction.userdata = tag;
-                    if (!AddPrediction(cl, prediction))
-                    {
-                        break;
-                    }
-                }
+                IndexedTag *indexed = &file->tags[i];
+
+                TagBrowserEntry *entry = &cache->entries[cache->entry_count++];
+                entry->name        = indexed->name;
+                entry->tag         = nullptr;
+                entry->indexed_tag = indexed;
             }
         }
+    }
+
+}
+
+COMMAND_PROC(Tags,
+             "Browse tags for all buffers, and the project index"_str)
+{
+    CommandLine *cl = BeginCommandLine();
+    cl->name           = "Tags"_str;
+    cl->no_quickselect = true;
+    cl->userdata       = PushStruct(&editor->command_arena, TagBrowserCache);
+
+    cl->GatherCandidates = [](CommandLine *cl)
+    {
+        TagBrowserCache *cache = (TagBrowserCache *)cl->userdata;
+        GatherAllTagBrowserEntries(cl, cache);
+
+        for (size_t i = 0; i < cache->entry_count; i += 1)
+        {
+            TagBrowserEntry *entry = &cache->entries[i];
+
+            Prediction prediction = {};
+            prediction.text     = entry->name;
+            prediction.userdata = entry;
+            AddCandidate(cl, prediction);
+        }
     };
 
-    cl->AcceptEntry = [](CommandLine *cl)
+    cl->ScoreCandidate = ScoreCandidateFuzzy;
+
+    // NOTE: The project index fills in, buffers finish loading and tags get reparsed while the browser is open
+    cl->CandidatesChanged = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
+        TagBrowserCache *cache = (TagBrowserCache *)cl->userdata;
+        return !(cache->key == GetTagBrowserKey());
+    };
 
+    cl->FormatPreviewText = [](CommandLine *cl, Prediction *prediction)
+    {
+        TagBrowserEntry *entry = (TagBrowserEntry *)prediction->userdata;
+
+        String result = {};
+        if (Tag *tag = entry->tag)
+        {
+            Buffer *buffer = GetBuffer(tag->buffer);
+
+            int64_t line = GetLineNumber(buffer, tag->pos);
+            String kind_name     = GetTagBaseKindName(tag);
+            String sub_kind_name = GetTagSubKindName(buffer->language, tag);
+            result = PushTempStringF("%-48.*s %.*s %.*s -- %.*s (line: %lld)", 
+                                     StringExpand(entry->name), 
+                                     StringExpand(sub_kind_name), 
+                                     StringExpand(kind_name), 
+                                     StringExpand(buffer->name),
+                                     line + 1);
+        }
+        else
+        {
+            IndexedTag *indexed = entry->indexed_tag;
+            IndexedFile *file = indexed->file;
+
+            Tag indexed_tag = MakeTag(indexed);
+            String kind_name     = GetTagBaseKindName(&indexed_tag);
+            String sub_kind_name = GetTagSubKindName(file->language, &indexed_tag);
+            result = PushTempStringF("%-48.*s %.*s %.*s -- %.*s (not open)", 
+                                     StringExpand(entry->name), 
+                                     StringExpand(sub_kind_name), 
+                                     StringExpand(kind_name), 
+                                     StringExpand(file->name));
+        }
+        return result;
+    };
+
+    cl->AcceptEntry = [](CommandLine *cl)
+    {
         View *view = GetActiveView();
 
         Prediction *pred = GetPrediction(cl);
-        Tag *tag = (Tag *)pred->userdata;
+        if (!pred) return false;
 
-        Buffer *buffer = GetBuffer(tag->buffer);
+        TagBrowserEntry *entry = (TagBrowserEntry *)pred->userdata;
 
-        ScopedMemory temp;
+        SaveJump(view, view->buffer, GetCursor(view)->pos, entry->name);
+
+        if (Tag *tag = entry->tag)
+        {
+            JumpToLocation(view, tag->buffer, tag->pos);
+        }
+        else
+        {
+            IndexedTag *indexed = entry->indexed_tag;
 
-        String name = PushBufferRange(temp, buffer, MakeRangeStartLength(tag->pos, tag->length));
+            Buffer *buffer = OpenIndexedTag(indexed);
+            JumpToLocation(view, buffer->id, ClampToBufferRange(buffer, indexed->pos));
+        }
+        view->center_view_next_time_we_calculate_scroll = true; // this is terrible
 
-        SaveJump(view, view->buffer, GetCursor(view)->pos, name);
+        return true;
+    };
+}
 
-        JumpToLocation(view, tag->buffer, tag->pos);
+struct ReferenceBrowser
+{
+    String name;
+
+    size_t count;
+    ReferenceLocation *locations;
+};
+
+COMMAND_PROC(FindReferences,
+             "List all references to the identifier under the cursor, in open buffers and the project index"_str)
+{
+    View *view = GetActiveView();
+    Buffer *buffer = GetBuffer(view);
+    Cursor *cursor = GetCursor(view);
+
+    if (!buffer->project)
+    {
+        return;
+    }
+
+    Token token = GetTokenAt(buffer, cursor->pos);
+    if (token.kind != Token_Identifier &&
+        token.kind != Token_Function)
+    {
+        return;
+    }
+
+    CommandLine *cl = BeginCommandLine();
+    cl->name           = "References"_str;
+    cl->no_quickselect = true;
+
+    ReferenceBrowser *browser = PushStruct(&cl->cache_arena, ReferenceBrowser);
+    browser->name = PushBufferRange(&cl->cache_arena, buffer, MakeRangeStartLength(token.pos, token.length));
+
+    size_t count = 0;
+    ReferenceLocation *first = PushReferences(&cl->cache_arena, buffer->project, browser->name, &count);
+
+    browser->locations = PushArrayNoClear(&cl->cache_arena, count, ReferenceLocation);
+    for (ReferenceLocation *location = first; location; location = location->next)
+    {
+        browser->locations[browser->count++] = *location;
+    }
+
+    // NOTE: References in open buffers come out in whatever order the lines were indexed in. There can be
+    // more of them than fit in the temp arena, so the sort gets its scratch from the cache arena instead
+    Sort(&cl->cache_arena, browser->count, browser->locations, +[](const ReferenceLocation &a, const ReferenceLocation &b)
+    {
+        if (a.file         != b.file)         return (uintptr_t)a.file < (uintptr_t)b.file;
+        if (a.buffer.index != b.buffer.index) return a.buffer.index < b.buffer.index;
+        return a.pos <= b.pos;
+    });
+
+    cl->userdata = browser;
+
+    cl->GatherCandidates = [](CommandLine *cl)
+    {
+        ReferenceBrowser *browser = (ReferenceBrowser *)cl->userdata;
+
+        for (size_t i = 0; i < browser->count; i += 1)
+        {
+            ReferenceLocation *location = &browser->locations[i];
+
+            Prediction prediction = {};
+            prediction.text     = (location->file ? location->file->name : GetBuffer(location->buffer)->name);
+            prediction.userdata = location;
+            AddCandidate(cl, prediction);
+        }
+    };
+
+    cl->FormatPreviewText = [](CommandLine *cl, Prediction *prediction)
+    {
+        ReferenceLocation *location = (ReferenceLocation *)prediction->userdata;
+
+        String result = {};
+        if (location->file)
+        {
+            result = PushTempStringF("%.*s (line: %lld, not open)", 
+                                     StringExpand(location->file->name), 
+                                     location->line + 1);
+        }
+        else
+        {
+            Buffer *buffer = GetBuffer(location->buffer);
+
+            Range line_range = GetInnerLineRange(buffer, location->line);
+            String line_text = TrimSpaces(PushBufferRange(platform->GetTempArena(), buffer, line_range));
+            result = PushTempStringF("%-32.*s (line: %lld) %.*s", 
+                                     StringExpand(buffer->name), 
+                                     location->line + 1,
+                                     StringExpand(line_text));
+        }
+        return result;
+    };
+
+    cl->AcceptEntry = [](CommandLine *cl)
+    {
+        View *view = GetActiveView();
+
+        ReferenceBrowser *browser = (ReferenceBrowser *)cl->userdata;
+
+        Prediction *pred = GetPrediction(cl);
+        if (!pred) return false;
+
+        ReferenceLocation *location = (ReferenceLocation *)pred->userdata;
+
+        SaveJump(view, view->buffer, GetCursor(view)->pos, browser->name);
+
+        if (IndexedFile *file = location->file)
+        {
+            Buffer *buffer = OpenBufferFromFile(file->full_path);
+            JumpToLocation(view, buffer->id, ClampToBufferRange(buffer, location->pos));
+        }
+        else
+        {
+            JumpToLocation(view, location->buffer, location->pos);
+        }
         view->center_view_next_time_we_calculate_scroll = true; // this is terrible
 
         return true;
@@ -868,21 +1113,13 @@ COMMAND_PROC(SetTheme,
     cl->name = "SetTheme"_str;
     cl->no_quickselect = true;
 
-    cl->GatherPredictions = [](CommandLine *cl)
+    cl->GatherCandidates = [](CommandLine *cl)
     {
-        String string = GetCommandString(cl);
-
         for (Theme *theme = editor->first_theme; theme; theme = theme->next)
         {
-            if (FindSubstring(theme->name, string, StringMatch_CaseInsensitive) != theme->name.size)
-            {
-                Prediction prediction = {};
-                prediction.text = theme->name;
-                if (!AddPrediction(cl, prediction))
-                {
-                    break;
-                }
-            }
+            Prediction prediction = {};
+            prediction.text = theme->name;
+            AddCandidate(cl, prediction);
         }
     };
 
@@ -1012,7 +1249,7 @@ COMMAND_PROC(Search,
     Cursor *first_cursor = nullptr, *last_cursor = nullptr;
     for (Cursor *cursor = IterateCursors(view); cursor; cursor = cursor->next)
     {
-        Cursor *backup_cursor = PushStruct(cl->arena, Cursor);
+        Cursor *backup_cursor = PushStruct(&cl->cache_arena, Cursor);
         CopyStruct(cursor, backup_cursor);
         SllQueuePush(first_cursor, last_cursor, backup_cursor);
     }
@@ -1024,8 +1261,8 @@ COMMAND_PROC(Search,
         int64_t scroll;
     };
 
-    SearchData *data = PushStruct(cl->arena, SearchData);
-    data->original_search = PushString(cl->arena, editor->search.as_string);
+    SearchData *data = PushStruct(&cl->cache_arena, SearchData);
+    data->original_search = PushString(&cl->cache_arena, editor->search.as_string);
     data->backup_cursors  = first_cursor;
     data->scroll          = view->scroll_at;
     cl->userdata = data;
@@ -1045,6 +1282,12 @@ COMMAND_PROC(Search,
         editor->show_search_highlight = true;
         editor->search_flags = StringMatch_CaseInsensitive;
 
+        // NOTE: Searching only needs the text, so it doesn't have to wait for the rest of the buffer to load
+        if (!IsBufferLoaded(buffer, BufferLoad_Indexed))
+        {
+            return text;
+        }
+
         for (Cursor *cursor = IterateCursors(view), *backup_cursor = backup_cursors; 
              cursor; 
              cursor = cursor->next, backup_cursor = backup_cursor->next)
@@ -1168,6 +1411,25 @@ COMMAND_PROC(GoToDefinitionUnderCursor,
             SaveJump(view, buffer->id, cursor->pos, tag_name);
             JumpToLocation(view, best_tag->buffer, best_tag->pos);
 
+            view->center_view_next_time_we_calculate_scroll = true; // this is terrible
+        }
+        else if (IndexedTag *indexed_tags = PushIndexedTagsWithName(temp, buffer->project, string))
+        {
+            IndexedTag *best_tag = indexed_tags;
+            for (IndexedTag *tag = indexed_tags; tag; tag = tag->next)
+            {
+                if ((tag->related_token_kind == token.kind) &&
+                    (tag->kind > best_tag->kind))
+                {
+                    best_tag = tag;
+                }
+            }
+
+            SaveJump(view, buffer->id, cursor->pos, best_tag->name);
+
+            Buffer *target = OpenIndexedTag(best_tag);
+            JumpToLocation(view, target->id, ClampToBufferRange(target, best_tag->pos));
+
             view->center_view_next_time_we_calculate_scroll = true; // this is terrible
         }
     }
@@ -1326,6 +1588,36 @@ COMMAND_PROC(ToggleLineNumbers, "Toggle the line number display"_str)
     core_config->show_line_numbers = !core_config->show_line_numbers;
 }
 
+COMMAND_PROC(ToggleProfiler, "Toggle the profiler flame chart"_str)
+{
+    core_config->debug_show_profiler = !core_config->debug_show_profiler;
+}
+
+COMMAND_PROC(DumpProfilerTrace, "Write the recorded profiler zones to textit_trace.json in the executable directory, for chrome://tracing"_str)
+{
+    WriteProfilerTrace(CombinePath(platform->GetTempArena(), platform->GetExeDirectory(), "textit_trace.json"_str));
+}
+
+COMMAND_PROC(ToggleMemoryStats, "Toggle the memory usage overlay"_str)
+{
+    core_config->debug_show_memory = !core_config->debug_show_memory;
+}
+
+COMMAND_PROC(DumpMemoryStats, "Log reserved, committed and used memory by subsystem and by allocation tag"_str)
+{
+    DumpMemoryReport();
+}
+
+COMMAND_PROC(LogEventLatency, "Log the p50/p95/p99/max latency from event arrival to handled, rendered and presented, per event type"_str)
+{
+    LogEventLatencies();
+}
+
+COMMAND_PROC(ResetEventLatency, "Clear the event latency histograms"_str)
+{
+    ResetEventLatencies();
+}
+
 COMMAND_PROC(EnterTextMode,
              "Enter Text Input Mode"_str)
 {
@@ -1542,10 +1834,6 @@ MOVEMENT_PROC(EncloseNextScope)
 
         TokenIterator it = IterateTokens(buffer, pos);
 
-        TokenKind opening_kind = Token_None;
-        TokenKind closing_kind = Token_None;
-        bool seek_forward = true;
-        int depth = 0;
         while (IsValid(&it))
         {
             Token t = Next(&it);
@@ -1554,34 +1842,20 @@ MOVEMENT_PROC(EncloseNextScope)
                 (t.kind == Token_RightParen) ||
                 (t.kind == Token_RightScope))
             {
-                opening_kind = t.kind;
-                if (opening_kind == Token_LeftParen)  { seek_forward = true;  closing_kind = Token_RightParen; }
-                if (opening_kind == Token_LeftScope)  { seek_forward = true;  closing_kind = Token_RightScope; }
-                if (opening_kind == Token_RightParen) { seek_forward = false; closing_kind = Token_LeftParen; Prev(&it); }
-                if (opening_kind == Token_RightScope) { seek_forward = false; closing_kind = Token_LeftScope; Prev(&it); }
-
-                depth = 1;
-                break;
-            }
-        }
-        if (opening_kind)
-        {
-            while (IsValid(&it))
-            {
-                Token t = (seek_forward ? Next(&it) : Prev(&it));
-                if (t.kind == opening_kind)
-                {
-                    depth += 1;
-                }
-                else if (t.kind == closing_kind)
+                int64_t match_pos = FindMatchingNest(buffer, t.pos);
+                if (match_pos >= 0)
                 {
-                    depth -= 1;
-                    if (depth <= 0)
+                    if (IsNestOpener(t.kind))
                     {
-                        result.end = (seek_forward ? t.pos + t.length : t.pos);
-                        break;
+                        Token match = GetTokenAt(buffer, match_pos);
+                        result.end = match.pos + match.length;
+                    }
+                    else
+                    {
+                        result.end = match_pos;
                     }
                 }
+                break;
             }
         }
 
@@ -1602,83 +1876,46 @@ SelectSurroundingNest(View *view, Cursor *cursor,
     
     int64_t pos = cursor->pos;
 
-    int64_t start_pos       = -1;
-    int64_t inner_start_pos = -1;
-
-    TokenIterator it = IterateTokens(buffer, pos);
-
-    int depth = 0;
-    while (IsValid(&it))
-    {
-        Token t = Prev(&it);
-        if (!t.kind) break;
+    NestKind kind = GetNestKind(open_nest);
+    Assert(kind == GetNestKind(close_nest));
 
-        if (t.kind == close_nest)
-        {
-            depth += 1;
-        }
-        if (t.kind == open_nest)
-        {
-            depth -= 1;
-            if (depth < 0)
-            {
-                start_pos = t.pos;
-                inner_start_pos = t.pos + t.length;
-                break;
-            }
-        }
-    }
+    int64_t start_pos = FindEnclosingNestOpener(buffer, pos, kind);
+    int64_t close_pos = (start_pos >= 0 ? FindEnclosingNestCloser(buffer, pos, kind) : -1);
 
-    depth = 0;
-    if (start_pos >= 0)
+    if (close_pos >= 0)
     {
-        while (IsValid(&it))
-        {
-            Token t = Next(&it);
-            if (!t.kind) break;
-
-            if (t.kind == open_nest)
-            {
-                depth += 1;
-            }
-            else if (t.kind == close_nest)
-            {
-                depth -= 1;
-                if (depth < 0)
-                {
-                    int64_t end_pos       = t.pos + t.length;
-                    int64_t inner_end_pos = t.pos;
-
-                    result.selection.inner.start = inner_start_pos;
-                    result.selection.inner.end   = inner_end_pos;
-                    result.selection.outer.start = start_pos;
-                    result.selection.outer.end   = end_pos;
+        Token open  = GetTokenAt(buffer, start_pos);
+        Token close = GetTokenAt(buffer, close_pos);
 
-                    if (line_selection)
-                    {
-                        int64_t start_line = GetLineNumber(buffer, result.selection.outer.start);
-                        int64_t end_line   = GetLineNumber(buffer, result.selection.outer.end);
+        int64_t inner_start_pos = open.pos + open.length;
+        int64_t end_pos         = close.pos + close.length;
+        int64_t inner_end_pos   = close.pos;
 
-                        int64_t inner_start_line = start_line + 1;
-                        int64_t inner_end_line   = Max(start_line, end_line - 1);
+        result.selection.inner.start = inner_start_pos;
+        result.selection.inner.end   = inner_end_pos;
+        result.selection.outer.start = start_pos;
+        result.selection.outer.end   = end_pos;
 
-                        if (start_line != end_line)
-                        {
-                            result.selection.outer.start = GetLineRange(buffer, start_line).start;
-                            result.selection.outer.end   = GetLineRange(buffer, end_line).end;
-
-                            result.selection.inner.start = GetInnerLineRange(buffer, inner_start_line).start;
-                            result.selection.inner.end   = GetInnerLineRange(buffer, inner_end_line).end;
-                        }
+        if (line_selection)
+        {
+            int64_t start_line = GetLineNumber(buffer, result.selection.outer.start);
+            int64_t end_line   = GetLineNumber(buffer, result.selection.outer.end);
 
-                    }
+            int64_t inner_start_line = start_line + 1;
+            int64_t inner_end_line   = Max(start_line, end_line - 1);
 
-                    result.pos = result.selection.outer.start;
+            if (start_line != end_line)
+            {
+                result.selection.outer.start = GetLineRange(buffer, start_line).start;
+                result.selection.outer.end   = GetLineRange(buffer, end_line).end;
 
-                    break;
-                }
+                result.selection.inner.start = GetInnerLineRange(buffer, inner_start_line).start;
+                result.selection.inner.end   = GetInnerLineRange(buffer, inner_end_line).end;
             }
+
         }
+
+        result.pos = result.selection.outer.start;
     }
 
     return result;
@@ -2323,6 +2560,21 @@ CHANGE_PROC(ToUppercase)
     DoBulkEdit(buffer, edits);
 }
 
+CHANGE_PROC(Reindent)
+{
+    Buffer *buffer = GetActiveBuffer();
+
+    BeginUndoBatch(buffer);
+
+    for (size_t i = 0; i < cursors.count; i++)
+    {
+        Cursor *cursor = cursors[i];
+        ReindentRange(buffer, GetLineRange(buffer, cursor->selection.outer));
+    }
+
+    EndUndoBatch(buffer);
+}
+
 COMMAND_PROC(RepeatLastCommand)
 {
     // dummy command do not implement
@@ -0,0 +1,316 @@
+//
+// Scalar
+//
+
+function void
+FillRow_Scalar(Color *dest, int64_t count, Color color)
+{
+    for (int64_t x = 0; x < count; x += 1)
+    {
+        dest[x] = color;
+    }
+}
+
+function void
+CopyRow_Scalar(Color *dest, Color *source, int64_t count)
+{
+    for (int64_t x = 0; x < count; x += 1)
+    {
+        dest[x] = source[x];
+    }
+}
+
+function void
+AlphaMaskedRow_Scalar(Color *dest, Color *source, int64_t count)
+{
+    for (int64_t x = 0; x < count; x += 1)
+    {
+        Color source_color = source[x];
+        if (source_color.a)
+        {
+            dest[x] = source_color;
+        }
+    }
+}
+
+function void
+SubpixelBlendRow_Scalar(Color *dest, Color *source, int64_t count, Color blend_color)
+{
+    float blend_r = (1.0f / 255.0f)*blend_color.r;
+    float blend_g = (1.0f / 255.0f)*blend_color.g;
+    float blend_b = (1.0f / 255.0f)*blend_color.b;
+
+    for (int64_t x = 0; x < count; x += 1)
+    {
+        Color source_color = source[x];
+        Color dest_color   = dest[x];
+
+        float source_r = 1.0f - (1.0f / 255.0f)*source_color.r;
+        float source_g = 1.0f - (1.0f / 255.0f)*source_color.g;
+        float source_b = 1.0f - (1.0f / 255.0f)*source_color.b;
+
+        float dest_r = (1.0f / 255.0f)*dest_color.r;
+        float dest_g = (1.0f / 255.0f)*dest_color.g;
+        float dest_b = (1.0f / 255.0f)*dest_color.b;
+
+        Color blend = {};
+        blend.r = (uint8_t)(255.0f*((1.0f - source_r)*dest_r + source_r*blend_r));
+        blend.g = (uint8_t)(255.0f*((1.0f - source_g)*dest_g + source_g*blend_g));
+        blend.b = (uint8_t)(255.0f*((1.0f - source_b)*dest_b + source_b*blend_b));
+
+        dest[x] = blend;
+    }
+}
+
+function void
+MaskRow_Scalar(Color *dest, Color *source, int64_t count, Color foreground, Color background)
+{
+    for (int64_t x = 0; x < count; x += 1)
+    {
+        dest[x] = (source[x].a ? foreground : background);
+    }
+}
+
+//
+// SSE2
+//
+
+// NOTE: The SIMD subpixel blend works on 8 bit channels widened to 16 bits:
+//     (source*dest + (255 - source)*blend) / 255
+// which is the scalar float version with the division done as (x + 1 + (x >> 8)) >> 8, which is
+// exact for every value that can come up here. Alpha comes out as 0, like the scalar version.
+
+#define BLIT_ALPHA_MASK 0xFF000000
+#define BLIT_COLOR_MASK 0x00FFFFFF
+
+function __m128i
+SubpixelBlend16_SSE2(__m128i source, __m128i dest, __m128i blend)
+{
+    __m128i inv_source = _mm_sub_epi16(_mm_set1_epi16(255), source);
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(source, dest), _mm_mullo_epi16(inv_source, blend));
+    x = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+    return x;
+}
+
+function void
+FillRow_SSE2(Color *dest, int64_t count, Color color)
+{
+    __m128i color4 = _mm_set1_epi32((int)color.u32);
+
+    int64_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        _mm_storeu_si128((__m128i *)(dest + x), color4);
+    }
+    FillRow_Scalar(dest + x, count - x, color);
+}
+
+function void
+CopyRow_SSE2(Color *dest, Color *source, int64_t count)
+{
+    int64_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        _mm_storeu_si128((__m128i *)(dest + x), _mm_loadu_si128((__m128i *)(source + x)));
+    }
+    CopyRow_Scalar(dest + x, source + x, count - x);
+}
+
+function void
+AlphaMaskedRow_SSE2(Color *dest, Color *source, int64_t count)
+{
+    __m128i alpha_mask = _mm_set1_epi32((int)BLIT_ALPHA_MASK);
+    __m128i zero       = _mm_setzero_si128();
+
+    int64_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128i s = _mm_loadu_si128((__m128i *)(source + x));
+        __m128i d = _mm_loadu_si128((__m128i *)(dest + x));
+
+        __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(s, alpha_mask), zero);
+        __m128i result = _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, s));
+
+        _mm_storeu_si128((__m128i *)(dest + x), result);
+    }
+    AlphaMaskedRow_Scalar(dest + x, source + x, count - x);
+}
+
+function void
+SubpixelBlendRow_SSE2(Color *dest, Color *source, int64_t count, Color blend_color)
+{
+    __m128i zero       = _mm_setzero_si128();
+    __m128i color_mask = _mm_set1_epi32((int)BLIT_COLOR_MASK);
+    __m128i blend      = _mm_unpacklo_epi8(_mm_set1_epi32((int)blend_color.u32), zero);
+
+    int64_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128i s = _mm_loadu_si128((__m128i *)(source + x));
+        __m128i d = _mm_loadu_si128((__m128i *)(dest + x));
+
+        __m128i lo = SubpixelBlend16_SSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), blend);
+        __m128i hi = SubpixelBlend16_SSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), blend);
+
+        __m128i result = _mm_and_si128(_mm_packus_epi16(lo, hi), color_mask);
+        _mm_storeu_si128((__m128i *)(dest + x), result);
+    }
+    SubpixelBlendRow_Scalar(dest + x, source + x, count - x, blend_color);
+}
+
+function void
+MaskRow_SSE2(Color *dest, Color *source, int64_t count, Color foreground, Color background)
+{
+    __m128i alpha_mask  = _mm_set1_epi32((int)BLIT_ALPHA_MASK);
+    __m128i zero        = _mm_setzero_si128();
+    __m128i foreground4 = _mm_set1_epi32((int)foreground.u32);
+    __m128i background4 = _mm_set1_epi32((int)background.u32);
+
+    int64_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128i s = _mm_loadu_si128((__m128i *)(source + x));
+
+        __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(s, alpha_mask), zero);
+        __m128i result = _mm_or_si128(_mm_and_si128(transparent, background4), _mm_andnot_si128(transparent, foreground4));
+
+        _mm_storeu_si128((__m128i *)(dest + x), result);
+    }
+    MaskRow_Scalar(dest + x, source + x, count - x, foreground, background);
+}
+
+//
+// AVX2
+//
+
+function TARGET_AVX2 __m256i
+SubpixelBlend16_AVX2(__m256i source, __m256i dest, __m256i blend)
+{
+    __m256i inv_source = _mm256_sub_epi16(_mm256_set1_epi16(255), source);
+    __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(source, dest), _mm256_mullo_epi16(inv_source, blend));
+    x = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+    return x;
+}
+
+function TARGET_AVX2 void
+FillRow_AVX2(Color *dest, int64_t count, Color color)
+{
+    __m256i color8 = _mm256_set1_epi32((int)color.u32);
+
+    int64_t x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        _mm256_storeu_si256((__m256i *)(dest + x), color8);
+    }
+    FillRow_SSE2(dest + x, count - x, color);
+}
+
+function TARGET_AVX2 void
+CopyRow_AVX2(Color *dest, Color *source, int64_t count)
+{
+    int64_t x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        _mm256_storeu_si256((__m256i *)(dest + x), _mm256_loadu_si256((__m256i *)(source + x)));
+    }
+    CopyRow_SSE2(dest + x, source + x, count - x);
+}
+
+function TARGET_AVX2 void
+AlphaMaskedRow_AVX2(Color *dest, Color *source, int64_t count)
+{
+    __m256i alpha_mask = _mm256_set1_epi32((int)BLIT_ALPHA_MASK);
+    __m256i zero       = _mm256_setzero_si256();
+
+    int64_t x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m256i s = _mm256_loadu_si256((__m256i *)(source + x));
+        __m256i d = _mm256_loadu_si256((__m256i *)(dest + x));
+
+        __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(s, alpha_mask), zero);
+        __m256i result = _mm256_blendv_epi8(s, d, transparent);
+
+        _mm256_storeu_si256((__m256i *)(dest + x), result);
+    }
+    AlphaMaskedRow_SSE2(dest + x, source + x, count - x);
+}
+
+function TARGET_AVX2 void
+SubpixelBlendRow_AVX2(Color *dest, Color *source, int64_t count, Color blend_color)
+{
+    __m256i zero       = _mm256_setzero_si256();
+    __m256i color_mask = _mm256_set1_epi32((int)BLIT_COLOR_MASK);
+    __m256i blend      = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)blend_color.u32), zero);
+
+    int64_t x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m256i s = _mm256_loadu_si256((__m256i *)(source + x));
+        __m256i d = _mm256_loadu_si256((__m256i *)(dest + x));
+
+        // NOTE: unpack and pack both work per 128 bit lane, so the pixels end up back where they started
+        __m256i lo = SubpixelBlend16_AVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), blend);
+        __m256i hi = SubpixelBlend16_AVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), blend);
+
+        __m256i result = _mm256_and_si256(_mm256_packus_epi16(lo, hi), color_mask);
+        _mm256_storeu_si256((__m256i *)(dest + x), result);
+    }
+    SubpixelBlendRow_SSE2(dest + x, source + x, count - x, blend_color);
+}
+
+function TARGET_AVX2 void
+MaskRow_AVX2(Color *dest, Color *source, int64_t count, Color foreground, Color background)
+{
+    __m256i alpha_mask  = _mm256_set1_epi32((int)BLIT_ALPHA_MASK);
+    __m256i zero        = _mm256_setzero_si256();
+    __m256i foreground8 = _mm256_set1_epi32((int)foreground.u32);
+    __m256i background8 = _mm256_set1_epi32((int)background.u32);
+
+    int64_t x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m256i s = _mm256_loadu_si256((__m256i *)(source + x));
+
+        __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(s, alpha_mask), zero);
+        __m256i result = _mm256_blendv_epi8(foreground8, background8, transparent);
+
+        _mm256_storeu_si256((__m256i *)(dest + x), result);
+    }
+    MaskRow_SSE2(dest + x, source + x, count - x, foreground, background);
+}
+
+//
+// Dispatch
+//
+
+static BlitKernels blit_kernels[BlitKernelSet_COUNT] =
+{
+    { "Scalar"_str, FillRow_Scalar, CopyRow_Scalar, AlphaMaskedRow_Scalar, SubpixelBlendRow_Scalar, MaskRow_Scalar },
+    { "SSE2"_str,   FillRow_SSE2,   CopyRow_SSE2,   AlphaMaskedRow_SSE2,   SubpixelBlendRow_SSE2,   MaskRow_SSE2   },
+    { "AVX2"_str,   FillRow_AVX2,   CopyRow_AVX2,   AlphaMaskedRow_AVX2,   SubpixelBlendRow_AVX2,   MaskRow_AVX2   },
+};
+
+function BlitKernelSet
+GetBestBlitKernelSet(void)
+{
+    CpuFeatures features = GetCpuFeatures();
+
+    BlitKernelSet result = BlitKernelSet_Scalar;
+    if (features.avx2)
+    {
+        result = BlitKernelSet_AVX2;
+    }
+    else if (features.sse2)
+    {
+        result = BlitKernelSet_SSE2;
+    }
+    return result;
+}
+
+function BlitKernels *
+GetBlitKernels(BlitKernelSet set)
+{
+    Assert(set >= 0 && set < BlitKernelSet_COUNT);
+    return &blit_kernels[set];
+}
@@ -0,0 +1,34 @@
+#ifndef TEXTIT_BLIT_HPP
+#define TEXTIT_BLIT_HPP
+
+enum BlitKernelSet
+{
+    BlitKernelSet_Scalar,
+    BlitKernelSet_SSE2,
+    BlitKernelSet_AVX2,
+    BlitKernelSet_COUNT,
+};
+
+// NOTE: The per-row inner loops of the blit functions in textit_render.cpp. Clipping happens
+// before these get called, so they just stream count pixels.
+typedef void BlitFillRowProc(Color *dest, int64_t count, Color color);
+typedef void BlitCopyRowProc(Color *dest, Color *source, int64_t count);
+typedef void BlitAlphaMaskedRowProc(Color *dest, Color *source, int64_t count);
+typedef void BlitSubpixelBlendRowProc(Color *dest, Color *source, int64_t count, Color blend_color);
+typedef void BlitMaskRowProc(Color *dest, Color *source, int64_t count, Color foreground, Color background);
+
+struct BlitKernels
+{
+    String name;
+
+    BlitFillRowProc          *FillRow;
+    BlitCopyRowProc          *CopyRow;
+    BlitAlphaMaskedRowProc   *AlphaMaskedRow;
+    BlitSubpixelBlendRowProc *SubpixelBlendRow;
+    BlitMaskRowProc          *MaskRow;
+};
+
+function BlitKernelSet GetBestBlitKernelSet(void);
+function BlitKernels  *GetBlitKernels(BlitKernelSet set);
+
+#endif /* TEXTIT_BLIT_HPP */
@@ -14,6 +14,7 @@ OpenNewBuffer(String buffer_name, BufferFlags flags)
     Buffer *result = BootstrapPushStruct(Buffer, arena);
     result->id                   = id;
     result->flags                = flags;
+    result->load_state           = BufferLoad_Loaded;
     result->name                 = PushString(&result->arena, buffer_name);
     result->undo.at              = &result->undo.root;
     result->undo.run_pos         = -1;
@@ -22,11 +23,13 @@ OpenNewBuffer(String buffer_name, BufferFlags flags)
     result->indent_rules         = &editor->default_indent_rules;
     result->language             = &language_registry->null_language;
     result->tags                 = PushStruct(&result->arena, Tags);
-    result->heap                 = platform->CreateHeap(Kilobytes(4), 0);
+    result->heap                 = CreateSizeClassHeap(LOCATION_STRING("Buffer Heap"));
     DllInit(&result->tags->sentinel);
 
     result->last_save_undo_ordinal = result->undo.current_ordinal;
 
+    InvalidateIndentCache(result);
+
     AllocateTextStorage(result, TEXTIT_BUFFER_SIZE);
 
     editor->buffers[result->id.index] = result;
@@ -48,6 +51,11 @@ DestroyBuffer(BufferID id)
         return false;
     }
 
+    // NOTE: Stages that haven't started yet bail out, the one that's running gets to finish
+    buffer->load_cancelled = true;
+    platform->WaitForJobGroup(&buffer->load_jobs);
+
+    RemoveBufferReferences(buffer);
     RemoveProjectAssociation(buffer);
     FreeAllTags(buffer);
 
@@ -72,8 +80,12 @@ DestroyBuffer(BufferID id)
 
     editor->buffers[id.index] = nullptr;
 
+    Release(&buffer->style_cache_arena);
+    DestroySizeClassHeap(buffer->heap);
+    platform->DeallocateMemory(buffer->text);
+
+    // NOTE: The buffer itself lives in its arena, so that goes last
     Release(&buffer->arena);
-    platform->DestroyHeap(buffer->heap);
 
     return true;
 }
@@ -101,7 +113,8 @@ BeginOpenBufferFromFile(String filename, BufferFlags flags, bool *already_exists
 
     Buffer *buffer = OpenNewBuffer(leaf);
 
-    buffer->full_path = PushString(&buffer->arena, full_path);
+    buffer->load_state = BufferLoad_Reading;
+    buffer->full_path  = PushString(&buffer->arena, full_path);
     buffer->flags |= flags;
 
     AssociateProject(buffer);
@@ -110,22 +123,19 @@ BeginOpenBufferFromFile(String filename, BufferFlags flags, bool *already_exists
 }
 
 function void
-FinalizeOpenBufferFromFile(Buffer *buffer)
+LoadBufferText(Buffer *buffer)
 {
-    //
-    // All work done in this function must be threadsafe, as of writing
-    // it just concerns itself with the provided buffer and therefore
-    // doesn't need any synchronization. All the memory for it is allocated
-    // from the buffer's arena. -06/09/2021
-    //
-
     size_t file_size = platform->GetFileSize(buffer->full_path);
     EnsureSpace(buffer, file_size + 1); // + 1 for null terminator but this is fucking jank I want this code to die
     if (platform->ReadFileInto(TEXTIT_BUFFER_SIZE, buffer->text, buffer->full_path) != file_size)
     {
-        INVALID_CODE_PATH;
+        // NOTE: The file went away or changed size under us, better an empty buffer than half a file
+        platform->LogPrint(PlatformLogLevel_Error, "Failed to read '%.*s'", StringExpand(buffer->full_path));
+        file_size = 0;
     }
     buffer->count = (int64_t)file_size;
+    UpdateMemoryStats(buffer);
+
     buffer->line_end = GuessLineEndKind(MakeString(buffer->count, (uint8_t *)buffer->text));
 
     String ext;
@@ -143,16 +153,101 @@ FinalizeOpenBufferFromFile(Buffer *buffer)
             }
         }
     }
+}
+
+function void
+AdvanceBufferLoad(Buffer *buffer)
+{
+    //
+    // All work done in this function must be threadsafe, as of writing
+    // it just concerns itself with the provided buffer and therefore
+    // doesn't need any synchronization. All the memory for it is allocated
+    // from the buffer's arena. -06/09/2021
+    //
+
+    switch (buffer->load_state)
+    {
+        INCOMPLETE_SWITCH;
+
+        case BufferLoad_Reading:   LoadBufferText(buffer); break;
+        case BufferLoad_Indexed:   TokenizeBuffer(buffer); break;
+        case BufferLoad_Tokenized: ParseTags(buffer);      break;
+    }
 
-    TokenizeBuffer(buffer);
-    ParseTags(buffer);
+    // NOTE: Everything the stage produced has to be visible before the app thread is told it can use it
+    WRITE_BARRIER;
+    buffer->load_state = (BufferLoadState)(buffer->load_state + 1);
+}
+
+function void
+FinishLoadingBuffer(Buffer *buffer)
+{
+    Assert(buffer->load_state == BufferLoad_Tagged);
+
+    buffer->load_state = BufferLoad_Loaded;
+    AddBufferTagsToProject(buffer);
+    IndexBufferReferences(buffer);
 }
 
 function
-PLATFORM_JOB(FinalizeOpenBufferFromFileJob)
+PLATFORM_JOB(LoadBufferJob)
 {
     Buffer *buffer = (Buffer *)userdata;
-    FinalizeOpenBufferFromFile(buffer);
+    if (buffer->load_cancelled)
+    {
+        return;
+    }
+
+    AdvanceBufferLoad(buffer);
+
+    // NOTE: The next stage joins the group before this job leaves it, so the group only runs dry once
+    // the buffer is tagged or the load got cancelled
+    if (buffer->load_state < BufferLoad_Tagged && !buffer->load_cancelled)
+    {
+        platform->AddJobToGroup(buffer->load_queue, &buffer->load_jobs, buffer, LoadBufferJob);
+    }
+}
+
+function bool
+IsBufferLoaded(Buffer *buffer, BufferLoadState state)
+{
+    bool result = (buffer->load_state >= state);
+    READ_BARRIER;
+    return result;
+}
+
+function void
+WaitForBufferLoad(Buffer *buffer)
+{
+    if (buffer->load_state == BufferLoad_Loaded)
+    {
+        return;
+    }
+
+    platform->WaitForJobGroup(&buffer->load_jobs);
+
+    // NOTE: If the jobs never got to run to the end there's nothing left to wait on, so finish the job here
+    while (buffer->load_state < BufferLoad_Tagged)
+    {
+        AdvanceBufferLoad(buffer);
+    }
+    FinishLoadingBuffer(buffer);
+}
+
+function void
+UpdateLoadingBuffers(void)
+{
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        Buffer *buffer = it.buffer;
+
+        // NOTE: The state goes to tagged from inside the last job, so it's only safe to pick up once the job is done
+        if (buffer->load_state == BufferLoad_Tagged && !buffer->load_jobs.pending)
+        {
+            READ_BARRIER;
+            FinishLoadingBuffer(buffer);
+        }
+    }
 }
 
 function Buffer *
@@ -160,10 +255,7 @@ OpenBufferFromFile(String filename, BufferFlags flags)
 {
     bool already_exists;
     Buffer *buffer = BeginOpenBufferFromFile(filename, flags, &already_exists);
-    if (!already_exists)
-    {
-        FinalizeOpenBufferFromFile(buffer);
-    }
+    WaitForBufferLoad(buffer);
     return buffer;
 }
 
@@ -174,7 +266,8 @@ OpenBufferFromFileAsync(PlatformJobQueue *queue, String filename, BufferFlags fl
     Buffer *buffer = BeginOpenBufferFromFile(filename, flags, &already_exists);
     if (!already_exists)
     {
-        platform->AddJob(queue, buffer, FinalizeOpenBufferFromFileJob);
+        buffer->load_queue = queue;
+        platform->AddJobToGroup(queue, &buffer->load_jobs, buffer, LoadBufferJob);
     }
     return buffer;
 }
@@ -197,7 +290,7 @@ GetBuffer(BufferID id)
 function bool
 IsNullBuffer(Buffer *buffer)
 {
-    return buffer != editor->null_buffer;
+    return buffer == editor->null_buffer;
 }
 
 function BufferIterator
@@ -783,7 +876,7 @@ OnBufferChanged(Buffer *buffer, int64_t pos, int64_t delta)
 function int64_t
 BufferReplaceRangeNoUndoHistory(Buffer *buffer, Range range, String text)
 {
-    if (buffer->flags & Buffer_ReadOnly)
+    if ((buffer->flags & Buffer_ReadOnly) || !IsBufferLoaded(buffer))
     {
         return range.start;
     }
@@ -816,6 +909,9 @@ BufferReplaceRangeNoUndoHistory(Buffer *buffer, Range range, String text)
     Range line_range = MakeRange(start_info.line, end_info.line);
     RemoveLinesFromIndex(buffer, line_range);
 
+    // NOTE: The indentation context of every line from here on might have changed
+    InvalidateIndentCacheFromLine(buffer, start_info.line);
+
     //
     // Replace text
     //
@@ -837,7 +933,7 @@ BufferReplaceRangeNoUndoHistory(Buffer *buffer, Range range, String text)
     {
         int64_t this_line_start = tokenize_pos;
 
-        LineData line_data;
+        LineData line_data = {};
         tokenize_pos = TokenizeLine(buffer, tokenize_pos, prev_line_data->end_tokenize_state, &line_data);
 
         LineIndexNode *node = InsertLine(buffer, MakeRange(this_line_start, tokenize_pos), line_data);
@@ -868,6 +964,10 @@ BufferReplaceRangeNoUndoHistory(Buffer *buffer, Range range, String text)
         if (old_prev) old_prev->next = next_line_data->first_token_block;
         if (old_next) old_next->prev = next_line_data->last_token_block;
 
+        UpdateRecordNests(it.record);
+
+        AddLineReferences(buffer, it.record, it.range.start);
+
         prev_line_data = next_line_data;
 
         Next(&it);
@@ -884,7 +984,7 @@ BufferReplaceRangeNoUndoHistory(Buffer *buffer, Range range, String text)
 function int64_t
 BufferReplaceRange(Buffer *buffer, Range range, String text)
 {
-    if (buffer->flags & Buffer_ReadOnly)
+    if ((buffer->flags & Buffer_ReadOnly) || !IsBufferLoaded(buffer))
     {
         return range.start;
     }
@@ -1174,6 +1274,9 @@ function void
 FreeTokens(Buffer *buffer, LineIndexNode *node)
 {
     Assert(node->kind == LineIndexNode_Record);
+    RemoveLineReferences(buffer, node);
+    node->data.styled_line     = nullptr;
+    node->data.styled_line_key = 0;
     while (TokenBlock *block = node->data.first_token_block)
     {
         node->data.first_token_block = block->next;
@@ -1196,6 +1299,73 @@ FreeLineIndexNode(Buffer *buffer, LineIndexNode *node)
     SllStackPush(buffer->first_free_line_index_node, node);
 }
 
+//
+// Nest Index
+//
+
+function void
+ComputeRecordNests(LineIndexNode *record)
+{
+    Assert(record->kind == LineIndexNode_Record);
+
+    ZeroArray(NestKind_COUNT, record->nests);
+
+    LineData *data = &record->data;
+    for (TokenBlock *block = data->first_token_block; block; block = block->next)
+    {
+        for (int64_t i = 0; i < block->token_count; i += 1)
+        {
+            Token *t = &block->tokens[i];
+
+            NestKind kind = GetNestKind(t->kind);
+            if (kind == NestKind_None) continue;
+
+            NestAggregate *nest = &record->nests[kind];
+            nest->delta += GetNestDelta(t, kind);
+            if (nest->min_depth > nest->delta)
+            {
+                nest->min_depth = nest->delta;
+            }
+        }
+
+        if (block == data->last_token_block)
+        {
+            break;
+        }
+    }
+}
+
+function void
+UpdateNodeNests(LineIndexNode *node)
+{
+    Assert(node->kind != LineIndexNode_Record);
+
+    for (int kind = 0; kind < NestKind_COUNT; kind += 1)
+    {
+        NestAggregate result = {};
+        for (int i = 0; i < node->entry_count; i += 1)
+        {
+            NestAggregate child = node->children[i]->nests[kind];
+            if (result.min_depth > result.delta + child.min_depth)
+            {
+                result.min_depth = result.delta + child.min_depth;
+            }
+            result.delta += child.delta;
+        }
+        node->nests[kind] = result;
+    }
+}
+
+function void
+UpdateRecordNests(LineIndexNode *record)
+{
+    ComputeRecordNests(record);
+    for (LineIndexNode *node = record->parent; node; node = node->parent)
+    {
+        UpdateNodeNests(node);
+    }
+}
+
 struct LineIndexLocator
 {
     LineIndexNode *record;
@@ -1215,10 +1385,19 @@ LocateLineIndexNode(LineIndexNode    *node,
 {
     Assert(node->kind != LineIndexNode_Record);
 
-    int next_index = 0;
-    for (; next_index < node->entry_count - 1; next_index += 1)
+    // NOTE: Removing lines can leave empty nodes behind, they have nothing to find so they get skipped
+    int next_index = -1;
+    for (int i = 0; i < node->entry_count; i += 1)
     {
-        LineIndexNode *child = node->children[next_index];
+        LineIndexNode *child = node->children[i];
+        if (child->line_span == 0) continue;
+
+        if (next_index >= 0)
+        {
+            offset      += node->children[next_index]->span;
+            line_offset += node->children[next_index]->line_span;
+        }
+        next_index = i;
 
         int64_t delta;
         if constexpr(by_line)
@@ -1234,10 +1413,8 @@ LocateLineIndexNode(LineIndexNode    *node,
         {
             break;
         }
-
-        offset      += child->span;
-        line_offset += child->line_span;
     }
+    if (next_index < 0) next_index = 0;
 
     LineIndexNode *child = node->children[next_index];
     if (child->kind == LineIndexNode_Record)
@@ -1269,7 +1446,7 @@ template <bool by_line>
 function void
 FindLineInfo(Buffer *buffer, int64_t target, LineInfo *out_info)
 {
-    PlatformHighResTime start = platform->GetTime();
+    TimedFunction;
 
     LineIndexLocator locator;
     LocateLineIndexNode<by_line>(buffer->line_index_root, target, &locator);
@@ -1284,12 +1461,6 @@ FindLineInfo(Buffer *buffer, int64_t target, LineInfo *out_info)
     out_info->range       = MakeRangeStartLength(locator.pos, node->span);
     out_info->newline_pos = locator.pos + data->newline_col;
     out_info->data        = data;
-
-    PlatformHighResTime end = platform->GetTime();
-    editor->debug.line_index_lookup_timing += platform->SecondsElapsed(start, end);
-
-    editor->debug.line_index_lookup_count += 1;
-    editor->debug.line_index_lookup_recursion_count += locator.times_recursed;
 }
 
 function void
@@ -1304,6 +1475,38 @@ FindLineInfoByLine(Buffer *buffer, int64_t line, LineInfo *out_info)
     FindLineInfo<true>(buffer, line, out_info);
 }
 
+function void
+FindLineInfoByRecord(Buffer *buffer, LineIndexNode *record, LineInfo *out_info)
+{
+    Assert(record->kind == LineIndexNode_Record);
+
+    // NOTE: Walk up the tree, adding up the spans of every sibling that comes before us
+    int64_t pos  = 0;
+    int64_t line = 0;
+    for (LineIndexNode *node = record; node->parent; node = node->parent)
+    {
+        LineIndexNode *parent = node->parent;
+        for (int i = 0; i < parent->entry_count; i += 1)
+        {
+            LineIndexNode *child = parent->children[i];
+            if (child == node)
+            {
+                break;
+            }
+            pos  += child->span;
+            line += child->line_span;
+        }
+    }
+
+    LineData *data = &record->data;
+
+    ZeroStruct(out_info);
+    out_info->line        = line;
+    out_info->range       = MakeRangeStartLength(pos, record->span);
+    out_info->newline_pos = pos + data->newline_col;
+    out_info->data        = data;
+}
+
 function void
 RemoveRecord(LineIndexNode *record)
 {
@@ -1347,6 +1550,11 @@ RemoveRecord(LineIndexNode *record)
     }
     leaf->entry_count -= 1;
 
+    for (LineIndexNode *parent = leaf; parent; parent = parent->parent)
+    {
+        UpdateNodeNests(parent);
+    }
+
 #if TEXTIT_SLOW
     {
         LineIndexNode *root = record;
@@ -1487,17 +1695,26 @@ InsertEntry(Buffer         *buffer,
     }
     else
     {
-        int insert_index = 0;
-        for (int i = 0; i < node->entry_count - 1; i += 1)
+        // NOTE: Removing lines can leave empty nodes behind, which have no records for the new one to be linked
+        // up with, so they only get inserted into if there's nothing else
+        int insert_index = -1;
+        for (int i = 0; i < node->entry_count; i += 1)
         {
-            int64_t test_span = node->children[i]->span;
-            if (pos - offset - test_span < 0)
+            LineIndexNode *child = node->children[i];
+            if (child->line_span == 0) continue;
+
+            if (insert_index >= 0)
+            {
+                offset += node->children[insert_index]->span;
+            }
+            insert_index = i;
+
+            if (pos - offset - child->span < 0)
             {
                 break;
             }
-            insert_index += 1;
-            offset += test_span;
         }
+        if (insert_index < 0) insert_index = node->entry_count - 1;
 
         LineIndexNode *child = node->children[insert_index];
         if (LineIndexNode *split = InsertEntry(buffer, child, pos, record, offset))
@@ -1525,6 +1742,11 @@ InsertEntry(Buffer         *buffer,
             }
         }
     }
+
+    // NOTE: Everything below us is up to date by now, including any nodes that got split off
+    UpdateNodeNests(node);
+    if (result) UpdateNodeNests(result);
+
     return result;
 }
 
@@ -1535,7 +1757,10 @@ GetFirstLeafNode(LineIndexNode *root)
     while (result->kind != LineIndexNode_Leaf)
     {
         Assert(result->entry_count > 0);
-        result = result->children[0];
+
+        int index = 0;
+        while (index < result->entry_count - 1 && result->children[index]->line_span == 0) index += 1;
+        result = result->children[index];
     }
     Assert(result);
     return result;
@@ -1548,7 +1773,10 @@ GetFirstRecord(LineIndexNode *root)
     while (result->kind != LineIndexNode_Record)
     {
         Assert(result->entry_count > 0);
-        result = result->children[0];
+
+        int index = 0;
+        while (index < result->entry_count - 1 && result->children[index]->line_span == 0) index += 1;
+        result = result->children[index];
     }
     Assert(result);
     return result;
@@ -1557,7 +1785,7 @@ GetFirstRecord(LineIndexNode *root)
 function LineIndexNode *
 InsertLine(Buffer *buffer, Range range, const LineData &data)
 {
-    PlatformHighResTime start = platform->GetTime();
+    TimedFunction;
 
     if (!buffer->line_index_root)
     {
@@ -1568,6 +1796,10 @@ InsertLine(Buffer *buffer, Range range, const LineData &data)
     record->span      = RangeSize(range);
     record->line_span = 1;
     record->data = data;
+    record->data.first_reference = nullptr;
+    record->data.styled_line     = nullptr;
+    record->data.styled_line_key = 0;
+    ComputeRecordNests(record);
 
     if (LineIndexNode *split_node = InsertEntry(buffer, buffer->line_index_root, range.start, record))
     {
@@ -1581,14 +1813,14 @@ InsertLine(Buffer *buffer, Range range, const LineData &data)
         new_root->span      += new_root->children[1]->span;
         new_root->line_span += new_root->children[0]->line_span;
         new_root->line_span += new_root->children[1]->line_span;
+        UpdateNodeNests(new_root);
         buffer->line_index_root = new_root;
     }
 
     // NOTE: I am not doing the full validation here because the buffer may be desynced with the line index temporarily
     AssertSlow(ValidateLineIndexTreeIntegrity(buffer->line_index_root));
 
-    PlatformHighResTime end = platform->GetTime();
-    editor->debug.line_index_insert_timing += platform->SecondsElapsed(start, end);
+    AddLineReferences(buffer, record, range.start);
 
     return record;
 }
@@ -1610,6 +1842,7 @@ ClearLineIndex(Buffer *buffer)
 {
     ClearLineIndex(buffer, buffer->line_index_root);
     buffer->line_index_root = nullptr;
+    InvalidateIndentCache(buffer);
 }
 
 function void
@@ -1756,6 +1989,339 @@ AdjustSize(LineIndexNode *record, int64_t span_delta)
     }
 }
 
+//
+// Nest Queries
+//
+
+function int
+GetNestDepthAtRecord(LineIndexNode *record, NestKind kind)
+{
+    int result = 0;
+    for (LineIndexNode *node = record; node->parent; node = node->parent)
+    {
+        LineIndexNode *parent = node->parent;
+        for (int i = 0; i < parent->entry_count; i += 1)
+        {
+            LineIndexNode *child = parent->children[i];
+            if (child == node)
+            {
+                break;
+            }
+            result += child->nests[kind].delta;
+        }
+    }
+    return result;
+}
+
+// NOTE: Finds the first closer at or after pos that brings the depth down to target
+function int64_t
+SeekNestForwardInRecord(LineIndexNode *record, NestKind kind, int64_t start, int depth, int64_t pos, int target)
+{
+    LineData *data = &record->data;
+
+    int64_t at = start;
+    for (TokenBlock *block = data->first_token_block; block; block = block->next)
+    {
+        for (int64_t i = 0; i < block->token_count; i += 1)
+        {
+            Token *t = &block->tokens[i];
+
+            int delta = GetNestDelta(t, kind);
+            depth += delta;
+
+            if (delta < 0 && at >= pos && depth <= target)
+            {
+                return at;
+            }
+
+            at += t->length;
+        }
+
+        if (block == data->last_token_block)
+        {
+            break;
+        }
+    }
+
+    return -1;
+}
+
+// NOTE: Finds the last opener before pos that was entered from a depth of target
+function int64_t
+SeekNestBackwardInRecord(LineIndexNode *record, NestKind kind, int64_t start, int depth, int64_t pos, int target)
+{
+    LineData *data = &record->data;
+
+    int64_t result = -1;
+
+    int64_t at = start;
+    for (TokenBlock *block = data->first_token_block; block; block = block->next)
+    {
+        for (int64_t i = 0; i < block->token_count && at < pos; i += 1)
+        {
+            Token *t = &block->tokens[i];
+
+            int delta = GetNestDelta(t, kind);
+            if (delta > 0 && depth <= target)
+            {
+                result = at;
+            }
+            depth += delta;
+
+            at += t->length;
+        }
+
+        if (block == data->last_token_block || at >= pos)
+        {
+            break;
+        }
+    }
+
+    return result;
+}
+
+function int64_t
+SeekNestForwardInNode(LineIndexNode *node, NestKind kind, int64_t start, int depth, int target)
+{
+    if (node->kind == LineIndexNode_Record)
+    {
+        return SeekNestForwardInRecord(node, kind, start, depth, start, target);
+    }
+
+    for (int i = 0; i < node->entry_count; i += 1)
+    {
+        LineIndexNode *child = node->children[i];
+        NestAggregate  nest  = child->nests[kind];
+
+        // NOTE: Only descend into subtrees that actually dip down far enough
+        if (depth + nest.min_depth <= target)
+        {
+            int64_t result = SeekNestForwardInNode(child, kind, start, depth, target);
+            if (result >= 0)
+            {
+                return result;
+            }
+        }
+
+        depth += nest.delta;
+        start += child->span;
+    }
+
+    return -1;
+}
+
+function int64_t
+SeekNestBackwardInNode(LineIndexNode *node, NestKind kind, int64_t end, int end_depth, int target)
+{
+    if (node->kind == LineIndexNode_Record)
+    {
+        int64_t start = end - node->span;
+        int     depth = end_depth - node->nests[kind].delta;
+        return SeekNestBackwardInRecord(node, kind, start, depth, end, target);
+    }
+
+    for (int i = node->entry_count - 1; i >= 0; i -= 1)
+    {
+        LineIndexNode *child = node->children[i];
+        NestAggregate  nest  = child->nests[kind];
+
+        int start_depth = end_depth - nest.delta;
+        if (start_depth + nest.min_depth <= target)
+        {
+            int64_t result = SeekNestBackwardInNode(child, kind, end, end_depth, target);
+            if (result >= 0)
+            {
+                return result;
+            }
+        }
+
+        end_depth = start_depth;
+        end      -= child->span;
+    }
+
+    return -1;
+}
+
+function int64_t
+SeekNestForward(Buffer *buffer, NestKind kind, int64_t pos, int target)
+{
+    if (!buffer->line_index_root) return -1;
+
+    LineIndexLocator locator;
+    LocateLineIndexNodeByPos(buffer->line_index_root, pos, &locator);
+
+    LineIndexNode *record = locator.record;
+
+    int64_t start = locator.pos;
+    int     depth = GetNestDepthAtRecord(record, kind);
+
+    int64_t result = SeekNestForwardInRecord(record, kind, start, depth, pos, target);
+    if (result >= 0)
+    {
+        return result;
+    }
+
+    depth += record->nests[kind].delta;
+    start += record->span;
+
+    for (LineIndexNode *node = record; node->parent; node = node->parent)
+    {
+        LineIndexNode *parent = node->parent;
+
+        int index = 0;
+        for (; index < parent->entry_count && parent->children[index] != node; index += 1);
+
+        for (int i = index + 1; i < parent->entry_count; i += 1)
+        {
+            LineIndexNode *child = parent->children[i];
+            NestAggregate  nest  = child->nests[kind];
+
+            if (depth + nest.min_depth <= target)
+            {
+                result = SeekNestForwardInNode(child, kind, start, depth, target);
+                if (result >= 0)
+                {
+                    return result;
+                }
+            }
+
+            depth += nest.delta;
+            start += child->span;
+        }
+    }
+
+    return -1;
+}
+
+function int64_t
+SeekNestBackward(Buffer *buffer, NestKind kind, int64_t pos, int target)
+{
+    if (!buffer->line_index_root) return -1;
+
+    LineIndexLocator locator;
+    LocateLineIndexNodeByPos(buffer->line_index_root, pos, &locator);
+
+    LineIndexNode *record = locator.record;
+
+    int64_t end       = locator.pos;
+    int     end_depth = GetNestDepthAtRecord(record, kind);
+
+    int64_t result = SeekNestBackwardInRecord(record, kind, locator.pos, end_depth, pos, target);
+    if (result >= 0)
+    {
+        return result;
+    }
+
+    for (LineIndexNode *node = record; node->parent; node = node->parent)
+    {
+        LineIndexNode *parent = node->parent;
+
+        int index = 0;
+        for (; index < parent->entry_count && parent->children[index] != node; index += 1);
+
+        for (int i = index - 1; i >= 0; i -= 1)
+        {
+            LineIndexNode *child = parent->children[i];
+            NestAggregate  nest  = child->nests[kind];
+
+            int start_depth = end_depth - nest.delta;
+            if (start_depth + nest.min_depth <= target)
+            {
+                result = SeekNestBackwardInNode(child, kind, end, end_depth, target);
+                if (result >= 0)
+                {
+                    return result;
+                }
+            }
+
+            end_depth = start_depth;
+            end      -= child->span;
+        }
+    }
+
+    return -1;
+}
+
+function int
+GetNestDepth(Buffer *buffer, int64_t pos, NestKind kind)
+{
+    if (!buffer->line_index_root) return 0;
+
+    LineIndexLocator locator;
+    LocateLineIndexNodeByPos(buffer->line_index_root, pos, &locator);
+
+    LineIndexNode *record = locator.record;
+    LineData      *data   = &record->data;
+
+    int result = GetNestDepthAtRecord(record, kind);
+
+    int64_t at = locator.pos;
+    for (TokenBlock *block = data->first_token_block; block; block = block->next)
+    {
+        for (int64_t i = 0; i < block->token_count && at < pos; i += 1)
+        {
+            Token *t = &block->tokens[i];
+            result += GetNestDelta(t, kind);
+            at     += t->length;
+        }
+
+        if (block == data->last_token_block || at >= pos)
+        {
+            break;
+        }
+    }
+
+    return result;
+}
+
+function int64_t
+FindMatchingNest(Buffer *buffer, int64_t pos)
+{
+    if (!buffer->line_index_root) return -1;
+
+    LineInfo info;
+    FindLineInfoByPos(buffer, pos, &info);
+
+    Token t = GetToken(LocateTokenAtPos(&info, pos));
+    if (!IsInTokenRange(t, pos))
+    {
+        return -1;
+    }
+
+    NestKind kind = GetNestKind(t.kind);
+    if (kind == NestKind_None || !GetNestDelta(&t, kind))
+    {
+        return -1;
+    }
+
+    int depth = GetNestDepth(buffer, t.pos, kind);
+
+    int64_t result;
+    if (IsNestOpener(t.kind))
+    {
+        result = SeekNestForward(buffer, kind, t.pos + t.length, depth);
+    }
+    else
+    {
+        result = SeekNestBackward(buffer, kind, t.pos, depth - 1);
+    }
+    return result;
+}
+
+function int64_t
+FindEnclosingNestOpener(Buffer *buffer, int64_t pos, NestKind kind)
+{
+    int depth = GetNestDepth(buffer, pos, kind);
+    return SeekNestBackward(buffer, kind, pos, depth - 1);
+}
+
+function int64_t
+FindEnclosingNestCloser(Buffer *buffer, int64_t pos, NestKind kind)
+{
+    int depth = GetNestDepth(buffer, pos, kind);
+    return SeekNestForward(buffer, kind, pos, depth - 1);
+}
+
 function int64_t
 GetLineCount(Buffer *buffer)
 {
@@ -2047,8 +2613,12 @@ ValidateLineIndexInternal(LineIndexNode *root, Buffer *buffer)
             Assert(line_sum == root->line_span);
         }
 
-        LineIndexNode *record = GetFirstRecord(root);
-        ValidateTokenBlockChain(record);
+        // NOTE: The index is empty for a moment when every line gets replaced
+        if (root->line_span > 0)
+        {
+            LineIndexNode *record = GetFirstRecord(root);
+            ValidateTokenBlockChain(record);
+        }
     }
 #endif
 
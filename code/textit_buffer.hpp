@@ -55,7 +55,21 @@ enum BufferFlags_ENUM : BufferFlags
     Buffer_Hidden         = 0x4,
 };
 
+// NOTE: Buffers opened from files walk through these in order, each stage running as a job after the one
+// before it. A stage never touches what the stages before it produced, so the app thread can already use a
+// buffer for anything its current state covers while the rest is still loading.
+enum BufferLoadState : uint32_t
+{
+    BufferLoad_Reading,   // nothing is usable yet
+    BufferLoad_Indexed,   // the text, line endings and language are in, which is enough to search
+    BufferLoad_Tokenized, // the line index and tokens are built, which is enough to draw and move around
+    BufferLoad_Tagged,    // the tags are parsed, waiting for the app thread to pick the buffer up
+    BufferLoad_Loaded,    // tags are linked into the project and references are indexed, the buffer can be edited
+};
+
 struct LineIndexNode;
+struct ReferenceEntry;
+struct StyledLine;
 
 // struct BufferLine
 // {
@@ -68,18 +82,33 @@ struct LineIndexNode;
 
 #define TEXTIT_BUFFER_SIZE Gigabytes(8)
 #define BUFFER_ASYNC_THRESHOLD Megabytes(4)
+
+#define INDENT_CACHE_EDIT_COUNT 64
+
+// NOTE: An edit that threw out the cached indent context of every line after it
+struct IndentCacheEdit
+{
+    uint32_t generation;
+    int64_t  line;
+};
+
 struct Buffer : TextStorage
 {
     BufferID id;
     BufferFlags flags;
 
+    volatile BufferLoadState load_state;
+    volatile bool load_cancelled;
+    PlatformJobQueue *load_queue;
+    PlatformJobGroup load_jobs;
+
     bool dirty;
 
     bool bulk_edit;
     uint64_t undo_batch_ordinal;
 
     Arena arena;
-    Heap *heap;
+    SizeClassHeap *heap;
 
     String name;
     String full_path;
@@ -100,11 +129,21 @@ struct Buffer : TextStorage
     int64_t last_save_undo_ordinal;
 
     Project      *project;
+    bool          references_indexed;
     LanguageSpec *inferred_language;
     LanguageSpec *language;
     IndentRules  *indent_rules;
     Tags         *tags;
 
+    // NOTE: Edits are kept sorted by both generation and line, an edit drops any earlier edits below it
+    uint32_t        indent_cache_generation;
+    uint32_t        indent_cache_oldest_generation; // NOTE: contexts cached before this are always stale
+    int             indent_cache_edit_count;
+    IndentCacheEdit indent_cache_edits[INDENT_CACHE_EDIT_COUNT];
+
+    Arena    style_cache_arena;
+    uint32_t style_cache_generation;
+
     TokenBlock *first_free_token_block;
     Tag *first_free_tag;
 
@@ -115,6 +154,9 @@ struct Buffer : TextStorage
 function Buffer         *OpenNewBuffer                    (String buffer_name, BufferFlags flags = 0);
 function Buffer         *OpenBufferFromFile               (String filename, BufferFlags flags = 0);
 function Buffer         *OpenBufferFromFileAsync          (PlatformJobQueue *queue, String filename, BufferFlags flags = 0);
+function bool           IsBufferLoaded                   (Buffer *buffer, BufferLoadState state = BufferLoad_Loaded);
+function void           WaitForBufferLoad                (Buffer *buffer);
+function void           UpdateLoadingBuffers             (void);
 function Buffer         *GetBuffer                        (BufferID id);
 function bool           IsNullBuffer                      (Buffer *buffer);
 function bool           DestroyBuffer                     (BufferID id);
@@ -209,6 +251,16 @@ struct LineData
     LineTokenizeState end_tokenize_state;   
     TokenBlock       *first_token_block;
     TokenBlock       *last_token_block;
+    ReferenceEntry   *first_reference;
+
+    // NOTE: Only valid if IsIndentContextCached says so
+    Token             indent_anchor;
+    uint8_t           indent_anchor_rule;
+    uint32_t          indent_generation;
+
+    // NOTE: Only valid if styled_line_key matches the key DrawTextArea computes for the buffer
+    StyledLine       *styled_line;
+    uint64_t          styled_line_key;
 };
 
 struct LineInfo
@@ -230,6 +282,12 @@ enum LineIndexNodeKind : uint8_t
 
 #define LINE_INDEX_ORDER 4
 
+struct NestAggregate
+{
+    int32_t delta;     // change in depth over the whole span
+    int32_t min_depth; // lowest depth reached within the span, relative to the depth at its start
+};
+
 struct LineIndexNode
 {
     LineIndexNodeKind kind;
@@ -241,6 +299,8 @@ struct LineIndexNode
     int64_t span;
     int64_t line_span;
 
+    NestAggregate nests[NestKind_COUNT];
+
     union
     {
         // NOTE: The + 1 is pure slop. It lets me overflow the node and _then_ split it without having
@@ -255,9 +315,16 @@ function void RemoveLinesFromIndex(Buffer *buffer, Range line_range);
 function void MergeLines(Buffer *buffer, Range range);
 function void ClearLineIndex(Buffer *buffer);
 function void FreeTokens(Buffer *buffer, LineIndexNode *node);
+function void UpdateRecordNests(LineIndexNode *record);
 
 function void FindLineInfoByPos(Buffer *buffer, int64_t pos, LineInfo *out_info);
 function void FindLineInfoByLine(Buffer *buffer, int64_t line, LineInfo *out_info);
+function void FindLineInfoByRecord(Buffer *buffer, LineIndexNode *record, LineInfo *out_info);
+
+function int GetNestDepth(Buffer *buffer, int64_t pos, NestKind kind);
+function int64_t FindMatchingNest(Buffer *buffer, int64_t pos);
+function int64_t FindEnclosingNestOpener(Buffer *buffer, int64_t pos, NestKind kind);
+function int64_t FindEnclosingNestCloser(Buffer *buffer, int64_t pos, NestKind kind);
 
 function int64_t GetLineCount(Buffer *buffer);
 
@@ -93,6 +93,7 @@ LoadDefaultBindings()
     BindCommand(command, 'C',                      Modifier_None,                "ChangeSelection"_str);
     BindCommand(command, 'C',                      Modifier_Shift,               "ChangeOuterSelection"_str);
     BindCommand(command, 'Q',                      Modifier_None,                "ToUppercase"_str);
+    BindCommand(command, PlatformInputCode_Plus,   Modifier_None,                "Reindent"_str); // NOTE: '='
     BindCommand(command, 'X',                      Modifier_None,                "EncloseLine"_str);
     BindCommand(command, 'F',                      Modifier_Ctrl,                "PageDown"_str);
     BindCommand(command, 'B',                      Modifier_Ctrl,                "PageUp"_str);
@@ -104,6 +105,7 @@ LoadDefaultBindings()
     BindCommand(command, 'S',                      Modifier_None,                "EncloseNextScope"_str);
     BindCommand(command, PlatformInputCode_Oem4,   Modifier_Shift,               "EncloseSurroundingScope"_str);
     BindCommand(command, PlatformInputCode_Oem6,   Modifier_Ctrl,                "GoToDefinitionUnderCursor"_str);
+    BindCommand(command, PlatformInputCode_Oem6,   Modifier_Ctrl|Modifier_Shift, "FindReferences"_str);
     BindCommand(command, '9',                      Modifier_Shift,               "EncloseSurroundingParen"_str);
     BindCommand(command, PlatformInputCode_Period, Modifier_None,                "RepeatLastCommand"_str);
     BindCommand(command, PlatformInputCode_F1,     Modifier_None,                "ToggleVisualizeNewlines"_str);
@@ -111,7 +111,7 @@ typedef void (*TextCommandProc)(const Cursors &cursors, String text);
 typedef void (*MovementProc)(const Cursors &cursors);
 #define MOVEMENT_PROC(name, ...)                                                                                                            \
     static void Paste(MOV_, name)(const Cursors &cursors);                                                                                  \
-    CommandRegisterHelper Paste(CMDHELPER_, name)(Command_Movement, StringLiteral(#name), (void *)&Paste(MOV_, name), ""_str, __VA_ARGS__); \
+    CommandRegisterHelper Paste(CMDHELPER_, name)(Command_Movement, StringLiteral(#name), (void *)&Paste(MOV_, name), ""_str, ##__VA_ARGS__); \
     static void Paste(MOV_, name)(const Cursors &cursors)
 
 typedef void (*ChangeProc)(const Cursors &cursors);
@@ -12,6 +12,11 @@ EndCommandLine()
         CommandLine *cl = editor->command_lines[--editor->command_line_count];
         if (cl->OnTerminate && !cl->accepted_entry) cl->OnTerminate(cl);
 
+        Release(&cl->arena);
+        Release(&cl->cache_arena);
+        Release(&cl->candidate_arena);
+        Release(&cl->survivor_arena);
+
         EndTemporaryMemory(cl->temporary_memory);
 
         if (editor->command_line_count > 0)
@@ -52,48 +57,369 @@ BeginCommandLine()
         TemporaryMemory temp = BeginTemporaryMemory(&editor->command_arena);
 
         cl = PushStruct(&editor->command_arena, CommandLine);
-        cl->arena                     = PushSubArena(&editor->command_arena, Kilobytes(512));
         cl->temporary_memory          = temp;
         cl->prediction_selected_index = -1;
 
-        for (int i = 0; i < ArrayCount(cl->sort_keys); i += 1)
-        {
-            cl->sort_keys[i].index = i;
-        }
-
         editor->command_lines[index] = cl;
     }
 
     return cl;
 }
 
-function bool
+// NOTE: The candidate's strings aren't copied, so they have to stay put for as long as the command line is
+// open. Anything made up on the spot can go in the cache arena.
+function void
+AddCandidate(CommandLine *cl, const Prediction &candidate)
+{
+    Prediction *dest = PushStruct(&cl->candidate_arena, Prediction);
+    Assert(!cl->candidates || dest == cl->candidates + cl->candidate_count);
+
+    if (!cl->candidates)
+    {
+        cl->candidates = dest;
+    }
+    cl->candidate_count += 1;
+
+    *dest = candidate;
+    if (!dest->preview_text.size)
+    {
+        dest->preview_text = dest->text;
+    }
+    dest->quickselect_char = ToUpperAscii(candidate.quickselect_char);
+}
+
+function void
 AddPrediction(CommandLine *cl, const Prediction &prediction, uint32_t sort_key)
 {
-    if (cl->prediction_count < ArrayCount(cl->predictions))
+    Prediction copy = prediction;
+    copy.text         = PushString(&cl->arena, prediction.text);
+    copy.preview_text = (prediction.preview_text.size ? PushString(&cl->arena, prediction.preview_text) : copy.text);
+    AddCandidate(cl, copy);
+
+    // NOTE: GatherPredictions already did the filtering, so everything it adds survives
+    SortKey *survivor = PushStruct(&cl->survivor_arena, SortKey);
+    Assert(!cl->survivors || survivor == cl->survivors + cl->candidate_count - 1);
+
+    if (!cl->survivors)
+    {
+        cl->survivors = survivor;
+    }
+    survivor->key   = sort_key;
+    survivor->index = (uint32_t)(cl->candidate_count - 1);
+}
+
+function bool
+ScoreCandidateSubstring(CommandLine *cl, Prediction *candidate, String query, uint32_t *sort_key)
+{
+    (void)cl;
+    bool result = (FindSubstring(candidate->text, query, StringMatch_CaseInsensitive) != candidate->text.size);
+    *sort_key = 0;
+    return result;
+}
+
+function bool
+ScoreCandidateFuzzy(CommandLine *cl, Prediction *candidate, String query, uint32_t *sort_key)
+{
+    (void)cl;
+    int score = FuzzyMatch(candidate->text, query);
+    *sort_key = FuzzyMatchSortKey(score);
+    return score > 0;
+}
+
+function uint32_t
+GetPredictionSortKey(CommandLine *cl, String query, Prediction *prediction, uint32_t sort_key)
+{
+    uint32_t result = sort_key;
+    if (cl->sort_by_edit_distance)
+    {
+        result = CalculateEditDistance(query, prediction->preview_text);
+    }
+    if (!AreEqual(query, prediction->preview_text, StringMatch_CaseInsensitive) &&
+        !AreEqual(query, prediction->text,         StringMatch_CaseInsensitive))
+    {
+        result += 1000;
+    }
+    return result;
+}
+
+function void
+ResetCandidates(CommandLine *cl)
+{
+    Clear(&cl->candidate_arena);
+    cl->candidates      = nullptr;
+    cl->candidate_count = 0;
+
+    Clear(&cl->survivor_arena);
+    cl->survivors      = nullptr;
+    cl->survivor_count = 0;
+    cl->sorted         = nullptr;
+    cl->sorted_count   = 0;
+}
+
+function void
+BeginSortingPredictions(CommandLine *cl)
+{
+    // NOTE: The survivors array has room for every candidate, what follows it is room for the sorted ones
+    if (cl->survivors)
     {
-        int index = cl->prediction_count++;
-        Prediction *dest = &cl->predictions[index];
-        dest->text             = PushString(cl->arena, prediction.text);
-        dest->preview_text     = (prediction.preview_text.size ? PushString(cl->arena, prediction.preview_text) : dest->text);
-        dest->color            = prediction.color;
-        dest->quickselect_char = ToUpperAscii(prediction.quickselect_char);
-        dest->incomplete       = prediction.incomplete;
-        dest->userdata         = prediction.userdata;
-        cl->sort_keys[index].key = sort_key;
-        return true;
+        ResetTo(&cl->survivor_arena, (char *)(cl->survivors + cl->candidate_count));
     }
-    cl->prediction_overflow = true;
-    return false;
+    cl->sorted       = PushArrayNoClear(&cl->survivor_arena, cl->survivor_count, SortKey);
+    cl->sorted_count = 0;
+}
+
+function void
+GatherAllCandidates(CommandLine *cl)
+{
+    ResetCandidates(cl);
+
+    cl->GatherCandidates(cl);
+
+    cl->survivors      = PushArrayNoClear(&cl->survivor_arena, cl->candidate_count, SortKey);
+    cl->survivor_count = cl->candidate_count;
+    for (size_t i = 0; i < cl->candidate_count; i += 1)
+    {
+        cl->survivors[i].key   = 0;
+        cl->survivors[i].index = (uint32_t)i;
+    }
+
+    cl->candidates_gathered = true;
+}
+
+function void
+FilterCandidates(CommandLine *cl, String query, bool only_survivors)
+{
+    if (!only_survivors)
+    {
+        cl->survivor_count = cl->candidate_count;
+    }
+
+    ScoreCandidateProc *Score = (cl->ScoreCandidate ? cl->ScoreCandidate : ScoreCandidateSubstring);
+
+    size_t kept_count = 0;
+    for (size_t i = 0; i < cl->survivor_count; i += 1)
+    {
+        uint32_t id = (only_survivors ? cl->survivors[i].index : (uint32_t)i);
+        Prediction *candidate = &cl->candidates[id];
+
+        uint32_t sort_key = 0;
+        if (Score(cl, candidate, query, &sort_key))
+        {
+            SortKey *survivor = &cl->survivors[kept_count++];
+            survivor->key   = GetPredictionSortKey(cl, query, candidate, sort_key);
+            survivor->index = id;
+        }
+    }
+    cl->survivor_count = kept_count;
+
+    BeginSortingPredictions(cl);
+}
+
+// NOTE: Rather than sorting every survivor whenever the query changes, only as many get sorted as get
+// looked at, in batches that double in size so that looking at all of them costs about as much as
+// sorting them in one go would have. Ties keep the order the candidates were added in.
+function void
+SortPredictionsUpTo(CommandLine *cl, size_t count)
+{
+    count = Min(count, cl->survivor_count);
+    if (cl->sorted_count >= count)
+    {
+        return;
+    }
+
+    size_t unsorted_count = cl->survivor_count - cl->sorted_count;
+
+    size_t sort_count = (cl->sorted_count ? 2*cl->sorted_count : PREDICTION_SORT_BATCH);
+    if (sort_count < count) sort_count = count;
+    sort_count = Min(sort_count, cl->survivor_count) - cl->sorted_count;
+
+    // NOTE: Once the batch is a good part of what's left, picking it out costs more than sorting the rest
+    if (4*sort_count >= unsorted_count)
+    {
+        sort_count = unsorted_count;
+    }
+
+    bool have_boundary = (cl->sorted_count > 0);
+    SortKey boundary = {};
+    if (have_boundary)
+    {
+        boundary = cl->sorted[cl->sorted_count - 1];
+    }
+
+    auto IsUnsorted = [have_boundary, boundary](SortKey key)
+    {
+        return (!have_boundary ||
+                key.key > boundary.key ||
+                (key.key == boundary.key && key.index > boundary.index));
+    };
+
+    // NOTE: The scratch space goes after the sorted array rather than in the thread's temp arena, which
+    // isn't big enough to sort a list that can be as long as the provider likes
+    ScopedMemory temp(&cl->survivor_arena);
+
+    // NOTE: Find the key of the worst survivor that makes the cut. Everything better than it is in, and
+    // so are the first few that tie with it, for as many as are left to fill.
+    bool take_all = (sort_count == unsorted_count);
+
+    uint32_t threshold = 0;
+    if (!take_all)
+    {
+        TopK top_k = MakeTopK(temp, (uint32_t)sort_count);
+        for (size_t i = 0; i < cl->survivor_count; i += 1)
+        {
+            SortKey key = cl->survivors[i];
+            if (IsUnsorted(key))
+            {
+                Push(&top_k, key.key, key.index);
+            }
+        }
+        threshold = top_k.heap[0].key;
+    }
+
+    SortKey *dest = cl->sorted + cl->sorted_count;
+    size_t dest_count = 0;
+    for (size_t i = 0; i < cl->survivor_count; i += 1)
+    {
+        SortKey key = cl->survivors[i];
+        if (IsUnsorted(key) && (take_all || key.key < threshold))
+        {
+            dest[dest_count++] = key;
+        }
+    }
+    for (size_t i = 0; i < cl->survivor_count && dest_count < sort_count; i += 1)
+    {
+        SortKey key = cl->survivors[i];
+        if (!take_all && key.key == threshold && IsUnsorted(key))
+        {
+            dest[dest_count++] = key;
+        }
+    }
+    Assert(dest_count == sort_count);
+
+    // NOTE: The radix sort is stable, and everything went in in the order it was added
+    SortKey *temp_keys = PushArrayNoClear(temp, dest_count, SortKey);
+    RadixSort(dest_count, dest, temp_keys);
+
+    cl->sorted_count += dest_count;
 }
 
 function Prediction *
 GetPrediction(CommandLine *cl, int index)
 {
+    if (cl->prediction_count == 0) return nullptr;
+
     if (index == -1) index = cl->prediction_selected_index;
     if (index <  0)                    index = 0;
     if (index >= cl->prediction_count) index = cl->prediction_count - 1;
-    return &cl->predictions[cl->sort_keys[index].index];
+
+    SortPredictionsUpTo(cl, (size_t)index + 1);
+    return &cl->candidates[cl->sorted[index].index];
+}
+
+function PredictionIterator
+IteratePredictions(CommandLine *cl, int first, int count)
+{
+    PredictionIterator it = {};
+    it.cl    = cl;
+    it.index = (first > 0 ? first : 0);
+    it.end   = (count < cl->prediction_count - it.index ? it.index + count : cl->prediction_count);
+    if (it.index < it.end)
+    {
+        SortPredictionsUpTo(cl, (size_t)it.end);
+        it.prediction = &cl->candidates[cl->sorted[it.index].index];
+    }
+    return it;
+}
+
+function bool
+IsValid(PredictionIterator *it)
+{
+    return it->index < it->end;
+}
+
+function void
+Next(PredictionIterator *it)
+{
+    it->index += 1;
+    if (it->index < it->end)
+    {
+        CommandLine *cl = it->cl;
+        it->prediction = &cl->candidates[cl->sorted[it->index].index];
+    }
+}
+
+function void
+UpdatePredictions(CommandLine *cl)
+{
+    if (cl->cycling_predictions ||
+        !(cl->GatherPredictions || cl->GatherCandidates))
+    {
+        return;
+    }
+
+    String query      = GetCommandString(cl);
+    String last_query = MakeString(cl->last_query_size, cl->last_query);
+
+    bool candidates_changed = (cl->GatherCandidates &&
+                               (!cl->candidates_gathered ||
+                                (cl->CandidatesChanged && cl->CandidatesChanged(cl))));
+
+    if (cl->predictions_valid && !candidates_changed && AreEqual(query, last_query))
+    {
+        return;
+    }
+
+    cl->prediction_count          = 0;
+    cl->prediction_index          = 0;
+    cl->prediction_selected_index = -1;
+
+    if (cl->GatherCandidates)
+    {
+        if (candidates_changed)
+        {
+            GatherAllCandidates(cl);
+        }
+
+        // NOTE: Anything matching the new query also matched the old one if the old one is a prefix of it
+        bool query_grew = (cl->predictions_valid &&
+                           !candidates_changed &&
+                           MatchPrefix(query, last_query, StringMatch_CaseInsensitive));
+        FilterCandidates(cl, query, query_grew);
+    }
+    else
+    {
+        Clear(&cl->arena);
+        ResetCandidates(cl);
+
+        cl->GatherPredictions(cl);
+
+        cl->survivor_count = cl->candidate_count;
+        for (size_t i = 0; i < cl->survivor_count; i += 1)
+        {
+            SortKey *survivor = &cl->survivors[i];
+            survivor->key = GetPredictionSortKey(cl, query, &cl->candidates[survivor->index], survivor->key);
+        }
+
+        BeginSortingPredictions(cl);
+    }
+
+    cl->prediction_count = (int)cl->survivor_count;
+    SortPredictionsUpTo(cl, PREDICTION_SORT_BATCH);
+
+    cl->last_query_size = query.size;
+    CopySize(query.size, query.data, cl->last_query);
+    cl->predictions_valid = true;
+}
+
+function String
+GetPreviewText(CommandLine *cl, Prediction *prediction)
+{
+    String result = prediction->preview_text;
+    if (cl->FormatPreviewText)
+    {
+        result = cl->FormatPreviewText(cl, prediction);
+    }
+    return result;
 }
 
 function bool
@@ -124,10 +450,13 @@ HandleCommandLineEvent(CommandLine *cl, PlatformEvent *event)
         {
             String text = GetText(event);
 
+            // NOTE: Only what's on screen can be quickselected
+            int quickselect_count = (int)Min((int64_t)cl->prediction_count, max_visible_predictions);
+
             bool handled_quickselect = false;
-            for (int i = 0; i < cl->prediction_count; i += 1)
+            for (int i = 0; i < quickselect_count; i += 1)
             {
-                Prediction *pred = &cl->predictions[i];
+                Prediction *pred = GetPrediction(cl, i);
                 if (pred->quickselect_char == ToUpperAscii(text[0]))
                 {
                     cl->prediction_selected_index = i;
@@ -254,7 +583,7 @@ HandleCommandLineEvent(CommandLine *cl, PlatformEvent *event)
                     if (selection < cl->prediction_count)
                     {
                         cl->prediction_selected_index = selection;
-                        Prediction *prediction = &cl->predictions[cl->prediction_selected_index];
+                        Prediction *prediction = GetPrediction(cl, cl->prediction_selected_index);
                         if (prediction->incomplete)
                         {
                             AcceptPrediction(cl);
@@ -433,48 +762,7 @@ HandleCommandLineEvent(CommandLine *cl, PlatformEvent *event)
 
         auto ClPostEvent = [](CommandLine *cl)
         {
-            if (!cl->cycling_predictions &&
-                cl->GatherPredictions)
-            {
-                cl->prediction_overflow = false;
-                cl->prediction_count = 0;
-                cl->prediction_index = 0;
-                cl->prediction_selected_index = -1;
-                ZeroArray(ArrayCount(cl->sort_keys), cl->sort_keys);
-
-                Clear(cl->arena);
-                cl->GatherPredictions(cl);
-
-                String cl_string = TrimSpaces(MakeString(cl->count, cl->text));
-
-                ScopedMemory temp;
-
-                SortKey *sort_keys = cl->sort_keys;
-                SortKey *temp_sort_keys = PushArray(temp, cl->prediction_count, SortKey);
-                for (int i = 0; i < cl->prediction_count; i += 1)
-                {
-                    Prediction *prediction = &cl->predictions[i];
-                    if (cl->sort_by_edit_distance)
-                    {
-                        sort_keys[i].key = CalculateEditDistance(cl_string, prediction->preview_text);
-                    }
-                    if (!AreEqual(cl_string, prediction->preview_text, StringMatch_CaseInsensitive) &&
-                        !AreEqual(cl_string, prediction->text,         StringMatch_CaseInsensitive))
-                    {
-                        sort_keys[i].key += 1000;
-                    }
-                    sort_keys[i].index = i;
-                }
-                if (cl_string.size > 0)
-                {
-                    RadixSort(cl->prediction_count, sort_keys, temp_sort_keys);
-                }
-
-                if (cl->prediction_index > cl->prediction_count)
-                {
-                    cl->prediction_index = cl->prediction_count;
-                }
-            }
+            UpdatePredictions(cl);
 
             if (cl->terminate)
             {
@@ -21,13 +21,28 @@ MakePrediction(String text, StringID color = "command_line_option"_id, uint8_t q
     return result;
 }
 
-#define MAX_PREDICTIONS 8192
+// NOTE: Sorting predictions starts with this many, and doubles from there as further predictions get
+// looked at
+#define PREDICTION_SORT_BATCH 256
 
+struct CommandLine;
+
+// NOTE: Decides whether a candidate matches the query and with what sort key, lower sorts first. When a
+// query gets extended, only the candidates that matched the shorter query are asked about again, so
+// anything rejected for a query must also be rejected for every query it's a prefix of.
+typedef bool ScoreCandidateProc(CommandLine *cl, Prediction *candidate, String query, uint32_t *sort_key);
+
+// NOTE: There's no limit to how many predictions a command line can have. They're only sorted as far
+// as they get looked at, and only the visible ones get their preview text formatted and drawn.
 struct CommandLine
 {
-    Arena *arena;
+    Arena arena; // NOTE: the strings copied by AddPrediction, cleared for every call to GatherPredictions
     TemporaryMemory temporary_memory;
 
+    // NOTE: Unlike the arena, this one survives between calls to GatherPredictions, so you can keep
+    // results around to refine as the query changes. It gets released when the command line ends.
+    Arena cache_arena;
+
     void *userdata;
 
     String name;
@@ -52,11 +67,37 @@ struct CommandLine
     int prediction_count;
     bool actively_scrolling;
     int scroll_offset;
-    bool prediction_overflow;
-    Prediction predictions[MAX_PREDICTIONS];
-    SortKey sort_keys[MAX_PREDICTIONS];
 
+    bool predictions_valid;
+    size_t  last_query_size;
+    uint8_t last_query[256];
+
+    // NOTE: Whatever AddPrediction or AddCandidate added, a candidate's index is its id
+    bool candidates_gathered;
+    size_t candidate_count;
+    Prediction *candidates;
+    Arena candidate_arena; // NOTE: holds nothing but the candidates, so that they form one array
+
+    // NOTE: The survivors are the candidates matching the last query, in the order they were added. The
+    // best sorted_count of them are also copied into sorted, in order.
+    size_t survivor_count;
+    size_t sorted_count;
+    SortKey *survivors;
+    SortKey *sorted;
+    Arena survivor_arena;
+
+    // NOTE: GatherPredictions adds the predictions matching the query with AddPrediction, and gets called
+    // again whenever the query changes.
     void (*GatherPredictions)(CommandLine *cl);
+
+    // NOTE: Prediction sources are the alternative to GatherPredictions. GatherCandidates adds every
+    // candidate once with AddCandidate, and from then on a change to the query just scores them.
+    // CandidatesChanged is optional, and gets asked before each update whether to gather them again.
+    void (*GatherCandidates)(CommandLine *cl);
+    ScoreCandidateProc *ScoreCandidate; // optional, defaults to ScoreCandidateSubstring
+    bool (*CandidatesChanged)(CommandLine *cl);
+
+    String (*FormatPreviewText)(CommandLine *cl, Prediction *prediction); // optional, only called for visible predictions
     String (*OnText)(CommandLine *cl, String text);
     void (*OnTerminate)(CommandLine *cl);
     bool (*AcceptEntry)(CommandLine *cl);
@@ -67,8 +108,26 @@ function void EndCommandLine();
 function void EndAllCommandLines();
 function bool HandleCommandLineEvent(CommandLine *cl, PlatformEvent *event);
 function String GetCommandString(CommandLine *cl);
-function bool AddPrediction(CommandLine *cl, const Prediction &prediction, uint32_t sort_key = 0);
+function void AddPrediction(CommandLine *cl, const Prediction &prediction, uint32_t sort_key = 0);
+function void AddCandidate(CommandLine *cl, const Prediction &candidate);
+function bool ScoreCandidateSubstring(CommandLine *cl, Prediction *candidate, String query, uint32_t *sort_key);
+function bool ScoreCandidateFuzzy(CommandLine *cl, Prediction *candidate, String query, uint32_t *sort_key);
+function void UpdatePredictions(CommandLine *cl);
 function Prediction *GetPrediction(CommandLine *cl, int index = -1);
+function String GetPreviewText(CommandLine *cl, Prediction *prediction);
+
+// NOTE: Walks the predictions from first up to first + count, in order
+struct PredictionIterator
+{
+    CommandLine *cl;
+    int index;
+    int end;
+    Prediction *prediction;
+};
+
+function PredictionIterator IteratePredictions(CommandLine *cl, int first, int count);
+function bool IsValid(PredictionIterator *it);
+function void Next(PredictionIterator *it);
 
 function void
 Terminate(CommandLine *cl)
@@ -212,32 +212,60 @@ FindCompletionCandidatesAt(Buffer *buffer, int64_t pos)
 
     LanguageSpec *language = buffer->language;
 
-    if (string.size > 0)
+    Project *project = buffer->project;
+
+    if (string.size > 0 && project)
     {
-        for (BufferIterator it = IterateBuffers();
-             IsValid(&it);
-             Next(&it))
+        SyncIndexedTagNames(project);
+
+        ScopedMemory temp;
+
+        // NOTE: All names sharing the prefix are contiguous in the name index, so the first ones that fit
+        // in the menu are taken in index order without looking at the rest. AddEntry then puts them in order
+        // of edit distance, which against a prefix is just how much longer they are.
+        int candidate_count = 0;
+        TagName **candidates = PushArray(temp, menu->capacity, TagName *);
+
+        Slice<TagName *> names = FindTagNamesWithPrefix(&project->tag_names, string);
+        for (TagName *candidate : names)
         {
-            Tags *tags = it.buffer->tags;
-            for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
+            if (candidate->name.size == string.size) continue;
+
+            if (candidate_count >= menu->capacity)
             {
-                ScopedMemory temp;
-                String name = PushBufferRange(temp, it.buffer, MakeRangeStartLength(tag->pos, tag->length));
+                menu->overflow = true;
+                break;
+            }
 
-                if (name.size != string.size && MatchPrefix(name, string, StringMatch_CaseInsensitive))
-                {
-                    String kind_name     = GetTagBaseKindName(tag);
-                    String sub_kind_name = GetTagSubKindName(buffer->language, tag);
+            candidates[candidate_count++] = candidate;
+        }
 
-                    CustomAutocompleteResult custom = language->CustomAutocomplete(temp, tag, name);
+        for (int i = 0; i < candidate_count; i += 1)
+        {
+            ScopedMemory entry_temp;
 
-                    CompletionEntry entry = {};
-                    entry.desc   = PushStringF(temp, "%-32.*s %.*s %.*s", StringExpand(name), StringExpand(sub_kind_name), StringExpand(kind_name));
-                    entry.string = custom.text; 
-                    entry.cursor_pos = custom.pos;
-                    AddEntry(menu, entry);
-                }
+            String name = candidates[i]->name;
+
+            Tag tag = {};
+            if (Tag *tags = PushTagsWithName(entry_temp, project, name))
+            {
+                tag = *tags;
             }
+            else if (IndexedTag *indexed = PushIndexedTagsWithName(entry_temp, project, name))
+            {
+                tag = MakeTag(indexed);
+            }
+
+            String kind_name     = GetTagBaseKindName(&tag);
+            String sub_kind_name = GetTagSubKindName(buffer->language, &tag);
+
+            CustomAutocompleteResult custom = language->CustomAutocomplete(entry_temp, &tag, name);
+
+            CompletionEntry entry = {};
+            entry.desc   = PushStringF(entry_temp, "%-32.*s %.*s %.*s", StringExpand(name), StringExpand(sub_kind_name), StringExpand(kind_name));
+            entry.string = custom.text; 
+            entry.cursor_pos = custom.pos;
+            AddEntry(menu, entry);
         }
     }
 
@@ -144,10 +144,13 @@ HotReloadConfigs()
     }
 }
 
+// NOTE: Indexing a String past its end gives 0, which has to end an identifier or a file ending
+// in one (like a project.textit with nothing but a section header) never gets parsed to the end
 function bool
 IsLegalConfigIdent(uint8_t c)
 {
-	return !IsWhitespaceAscii(c) && 
+	return c != 0 &&
+        !IsWhitespaceAscii(c) && 
         c != '#' && 
         c != ';' && 
         c != '=' && 
@@ -0,0 +1,269 @@
+function void
+EnsureDirectoryCacheInitialized()
+{
+    DirectoryCache *cache = directory_cache;
+    if (!cache->heap)
+    {
+        cache->heap = CreateSizeClassHeap(LOCATION_STRING("Directory Cache Heap"));
+        DllInit(&cache->lru_sentinel);
+    }
+}
+
+function DirectoryListing **
+FindDirectoryListingSlot(String path, uint64_t hash)
+{
+    DirectoryListing **result = &directory_cache->table[hash % DIRECTORY_CACHE_TABLE_SIZE];
+    while (*result && ((*result)->hash != hash || !AreEqual((*result)->path, path)))
+    {
+        result = &(*result)->next_in_hash;
+    }
+    return result;
+}
+
+// NOTE: Runs on the main thread for listings that are needed right away, and on the low priority queue for
+// prefetches. Either way, nothing else touches the listing until it's done.
+function void
+LoadDirectoryListing(DirectoryListing *listing)
+{
+    DirectoryCache *cache = directory_cache;
+
+    ScopedMemory temp;
+
+    // NOTE: The write time gets read before listing the directory, so a change made while listing it makes
+    // the next validation fail rather than going unnoticed
+    String stat_path = (listing->path.size ? listing->path : "."_str);
+    listing->write_time = platform->GetLastFileWriteTime(stat_path);
+
+    struct GatheredEntry
+    {
+        GatheredEntry *next;
+        DirectoryEntry entry;
+    };
+
+    GatheredEntry *first = nullptr;
+    GatheredEntry *last  = nullptr;
+
+    size_t entry_count = 0;
+    size_t name_bytes  = 0;
+
+    for (PlatformFileIterator *it = platform->FindFiles(temp, listing->path);
+         platform->FileIteratorIsValid(it);
+         platform->FileIteratorNext(it))
+    {
+        if (AreEqual(it->info.name, "."_str) ||
+            AreEqual(it->info.name, ".."_str))
+        {
+            continue;
+        }
+
+        GatheredEntry *gathered = PushStruct(temp, GatheredEntry);
+        gathered->entry.name      = PushString(temp, it->info.name);
+        gathered->entry.directory = it->info.directory;
+        SllQueuePush(first, last, gathered);
+
+        entry_count += 1;
+        name_bytes  += it->info.name.size;
+    }
+
+    void *memory = SizeClassAlloc(cache->heap, entry_count*sizeof(DirectoryEntry) + name_bytes);
+
+    DirectoryEntry *entries = (DirectoryEntry *)memory;
+    uint8_t *names = (uint8_t *)(entries + entry_count);
+
+    size_t entry_index = 0;
+    for (GatheredEntry *gathered = first; gathered; gathered = gathered->next)
+    {
+        DirectoryEntry *entry = &entries[entry_index++];
+        entry->directory = gathered->entry.directory;
+        entry->name      = MakeString(gathered->entry.name.size, names);
+        CopyArray(entry->name.size, gathered->entry.name.data, names);
+        names += entry->name.size;
+    }
+
+    if (listing->memory)
+    {
+        SizeClassFree(cache->heap, listing->memory);
+    }
+
+    listing->memory      = memory;
+    listing->entries     = entries;
+    listing->entry_count = entry_count;
+
+    listing->validated_time = platform->GetTime();
+}
+
+function
+PLATFORM_JOB(LoadDirectoryListingJob)
+{
+    DirectoryListing *listing = (DirectoryListing *)userdata;
+    LoadDirectoryListing(listing);
+
+    // NOTE: This hands the listing back to the main thread, which is free to evict it from here on, so the
+    // job can't touch it anymore
+    WRITE_BARRIER;
+    listing->state = DirectoryListing_Loaded;
+}
+
+function void
+EvictDirectoryListings(size_t max_listings)
+{
+    DirectoryCache *cache = directory_cache;
+
+    DirectoryListing *listing = cache->lru_sentinel.prev;
+    while (listing != &cache->lru_sentinel)
+    {
+        DirectoryListing *prev = listing->prev;
+
+        // NOTE: Listings still being prefetched belong to their job until it's done
+        if (listing->state == DirectoryListing_Loaded &&
+            (listing->orphaned || cache->listing_count > max_listings))
+        {
+            // NOTE: Orphans were already taken out of the table when they got replaced
+            if (!listing->orphaned)
+            {
+                DirectoryListing **slot = FindDirectoryListingSlot(listing->path, listing->hash);
+                Assert(*slot == listing);
+                *slot = listing->next_in_hash;
+            }
+
+            DllRemove(listing);
+
+            SizeClassFree(cache->heap, listing->path.data);
+            if (listing->memory)
+            {
+                SizeClassFree(cache->heap, listing->memory);
+            }
+
+            ZeroStruct(listing);
+            SllStackPush(cache->first_free_listing, listing);
+
+            cache->listing_count -= 1;
+        }
+
+        listing = prev;
+    }
+}
+
+function DirectoryListing *
+CreateDirectoryListing(String path, uint64_t hash)
+{
+    DirectoryCache *cache = directory_cache;
+
+    DirectoryListing *result = cache->first_free_listing;
+    if (result)
+    {
+        cache->first_free_listing = result->next;
+        ZeroStruct(result);
+    }
+    else
+    {
+        result = PushStruct(&cache->arena, DirectoryListing);
+    }
+
+    result->path = MakeString(path.size, (uint8_t *)SizeClassAlloc(cache->heap, path.size));
+    CopyArray(path.size, path.data, result->path.data);
+    result->hash = hash;
+
+    DirectoryListing **slot = FindDirectoryListingSlot(path, hash);
+    Assert(!*slot);
+    *slot = result;
+
+    DllInsertFront(&cache->lru_sentinel, result);
+    cache->listing_count += 1;
+
+    EvictDirectoryListings(DIRECTORY_CACHE_MAX_LISTINGS);
+
+    return result;
+}
+
+function DirectoryListing *
+GetDirectoryListing(String path)
+{
+    DirectoryCache *cache = directory_cache;
+    EnsureDirectoryCacheInitialized();
+
+    uint64_t hash = HashString(path).u64[0];
+
+    DirectoryListing **slot = FindDirectoryListingSlot(path, hash);
+    if (*slot && (*slot)->state != DirectoryListing_Loaded)
+    {
+        // NOTE: It's still being prefetched. Waiting on it would mean waiting on whatever else is ahead of it in
+        // the low priority queue, so it gets listed again right here and the prefetch is dropped when it's done
+        DirectoryListing *orphan = *slot;
+        *slot = orphan->next_in_hash;
+        orphan->orphaned = true;
+    }
+
+    DirectoryListing *result = *FindDirectoryListingSlot(path, hash);
+    if (!result)
+    {
+        cache->misses += 1;
+
+        result = CreateDirectoryListing(path, hash);
+        LoadDirectoryListing(result);
+        result->state = DirectoryListing_Loaded;
+    }
+    else
+    {
+        cache->hits += 1;
+
+        DllRemove(result);
+        DllInsertFront(&cache->lru_sentinel, result);
+
+        // NOTE: Pairs with the write barrier in LoadDirectoryListingJob, for listings that were prefetched
+        READ_BARRIER;
+
+        PlatformHighResTime now = platform->GetTime();
+        double ttl = 0.001*(double)core_config->directory_cache_ttl_ms;
+        if (platform->SecondsElapsed(result->validated_time, now) > ttl)
+        {
+            cache->revalidations += 1;
+
+            String stat_path = (path.size ? path : "."_str);
+            if (platform->GetLastFileWriteTime(stat_path) != result->write_time)
+            {
+                cache->reloads += 1;
+                LoadDirectoryListing(result);
+            }
+            else
+            {
+                result->validated_time = now;
+            }
+        }
+    }
+
+    return result;
+}
+
+function void
+PrefetchDirectoryListing(String path)
+{
+    DirectoryCache *cache = directory_cache;
+    EnsureDirectoryCacheInitialized();
+
+    uint64_t hash = HashString(path).u64[0];
+    if (*FindDirectoryListingSlot(path, hash))
+    {
+        // NOTE: Already cached or on its way, whether it's still up to date gets checked once it's asked for
+        return;
+    }
+
+    cache->prefetches += 1;
+
+    DirectoryListing *listing = CreateDirectoryListing(path, hash);
+    listing->state = DirectoryListing_Loading;
+
+    platform->AddJobToGroup(platform->low_priority_queue, &cache->prefetch_jobs, listing, LoadDirectoryListingJob);
+}
+
+function void
+FlushDirectoryCache()
+{
+    EnsureDirectoryCacheInitialized();
+
+    // NOTE: Prefetches in flight would otherwise survive the flush
+    platform->WaitForJobGroup(&directory_cache->prefetch_jobs);
+    READ_BARRIER;
+
+    EvictDirectoryListings(0);
+}
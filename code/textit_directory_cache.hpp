@@ -0,0 +1,76 @@
+#ifndef TEXTIT_DIRECTORY_CACHE_HPP
+#define TEXTIT_DIRECTORY_CACHE_HPP
+
+//
+// NOTE: Keeps directory listings around so that things like the file picker can filter them in memory on
+// every keystroke, rather than asking the file system again each time. A listing is trusted for
+// core_config->directory_cache_ttl_ms, after which the directory's write time is checked, and only if
+// that changed is the directory listed again. Listings can be prefetched on the low priority queue,
+// for directories the user is likely to go into next. Relative paths are cached as given, so the cache has
+// to be flushed when the working directory changes.
+//
+
+#define DIRECTORY_CACHE_TABLE_SIZE   256
+#define DIRECTORY_CACHE_MAX_LISTINGS 128
+
+struct DirectoryEntry
+{
+    String name;
+    bool directory;
+};
+
+enum DirectoryListingState : uint32_t
+{
+    DirectoryListing_Loading,
+    DirectoryListing_Loaded,
+};
+
+struct DirectoryListing
+{
+    DirectoryListing *next_in_hash;
+
+    DirectoryListing *next; // NOTE: next and prev keep the listings in least recently used order
+    DirectoryListing *prev;
+
+    String path; // NOTE: as passed to FindFiles, so either empty or ending in a separator
+    uint64_t hash;
+
+    volatile DirectoryListingState state;
+    bool orphaned; // NOTE: replaced by a fresh listing while it was still being prefetched, freed once the job is done
+
+    uint64_t write_time;
+    PlatformHighResTime validated_time;
+
+    size_t entry_count;
+    DirectoryEntry *entries;
+    void *memory; // NOTE: the entries and their names, in one allocation from the cache's heap
+};
+
+struct DirectoryCache
+{
+    SizeClassHeap *heap;
+
+    size_t listing_count;
+    DirectoryListing *table[DIRECTORY_CACHE_TABLE_SIZE];
+    DirectoryListing lru_sentinel;
+    DirectoryListing *first_free_listing;
+
+    Arena arena;
+
+    PlatformJobGroup prefetch_jobs;
+
+    // NOTE: Only written by the main thread
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t revalidations;
+    uint64_t reloads;
+    uint64_t prefetches;
+};
+
+GLOBAL_STATE(DirectoryCache, directory_cache);
+
+function DirectoryListing *GetDirectoryListing(String path);
+function void PrefetchDirectoryListing(String path);
+function void FlushDirectoryCache();
+
+#endif /* TEXTIT_DIRECTORY_CACHE_HPP */
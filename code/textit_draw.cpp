@@ -52,14 +52,214 @@ DrawText(V2i p, String line, Color foreground, Color background, size_t max = 0)
     return at_p;
 }
 
+//
+// Styled Lines
+//
+
+function ThemeColorIndex
+GetThemeIndexForTokenInBuffer(Buffer *buffer, Token token)
+{
+    Project *project = buffer->project;
+    LanguageSpec *language = buffer->language;
+    ThemePalette *palette  = &editor->theme_palette;
+
+    String token_name = MakeString(token.length, &buffer->text[token.pos]);
+
+    ThemeColorIndex foreground = GetThemeColorIndex("text_foreground"_id);
+    if (core_config->syntax_highlighting)
+    {
+        foreground = GetThemeIndexForToken(language, &token);
+        // FIXME: Decide what to do about highlighting untagged functions
+        if (token.kind == Token_Function)
+        {
+            foreground = GetThemeColorIndex("text_unknown_function"_id);
+        }
+
+        if (token.kind == Token_Identifier ||
+            token.kind == Token_Function)
+        {
+            StringID id = HashStringID(token_name);
+            TokenKind kind = GetTokenKindFromStringID(language, id);
+            if (kind)
+            {
+                foreground = GetThemeIndexForToken(language, &token);
+                token.kind = kind;
+            }
+
+            ScopedMemory tag_temp;
+            bool found_tag = false;
+            for (Tag *tag = PushTagsWithName(tag_temp, project, token_name); tag; tag = tag->next)
+            {
+                if (tag->related_token_kind == token.kind)
+                {
+                    if (tag->kind == Tag_CommentAnnotation)
+                    {
+                        if (HasFlag(token.flags, TokenFlag_IsComment))
+                        {
+                            foreground = GetThemeIndexForTag(language, tag);
+                        }
+                    }
+                    else
+                    {
+                        foreground = GetThemeIndexForTag(language, tag);
+                    }
+                    found_tag = true;
+                    break;
+                }
+            }
+
+            if (!found_tag)
+            {
+                for (IndexedTag *indexed = PushIndexedTagsWithName(tag_temp, project, token_name); indexed; indexed = indexed->next)
+                {
+                    if (indexed->related_token_kind == token.kind)
+                    {
+                        Tag tag = MakeTag(indexed);
+                        if (tag.kind != Tag_CommentAnnotation ||
+                            HasFlag(token.flags, TokenFlag_IsComment))
+                        {
+                            foreground = GetThemeIndexForTag(language, &tag);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (HasFlag(token.flags, TokenFlag_IsComment))
+        {
+            if (palette->keys[foreground] != "text_comment_annotation"_id)
+            {
+                foreground = GetThemeColorIndex("text_comment"_id);
+                if (AreEqual(token_name, "NOTE"_str, StringMatch_CaseInsensitive))
+                {
+                    foreground = GetThemeColorIndex("text_comment_note"_id);
+                }
+                else if (AreEqual(token_name, "TODO"_str, StringMatch_CaseInsensitive))
+                {
+                    foreground = GetThemeColorIndex("text_comment_todo"_id);
+                }
+                else if (AreEqual(token_name, "FIXME"_str, StringMatch_CaseInsensitive))
+                {
+                    foreground = GetThemeColorIndex("text_comment_fixme"_id);
+                }
+            }
+        }
+        else if (HasFlag(token.flags, TokenFlag_PartOfString))
+        {
+            if (palette->keys[foreground] != "text_string_special"_id)
+            {
+                foreground = GetThemeColorIndex("text_string"_id);
+            }
+        }
+        else if (HasFlag(token.flags, TokenFlag_IsPreprocessor))
+        {
+            foreground = GetThemeColorIndex("text_preprocessor"_id);
+        }
+    }
+
+    return foreground;
+}
+
+// NOTE: Everything besides the line's own tokens that goes into its colors. The tokens themselves
+// are covered by FreeTokens clearing the cached line.
+function uint64_t
+GetStyledLineKey(Buffer *buffer)
+{
+    if (buffer->style_cache_arena.used >= STYLE_CACHE_BUDGET)
+    {
+        // NOTE: Bumping the generation changes the key, so the lines pointing into the arena
+        // all get rebuilt before they're looked at again
+        Clear(&buffer->style_cache_arena);
+        buffer->style_cache_generation += 1;
+    }
+
+    Project *project = buffer->project;
+
+    HashResult hash = HashIntegers((uint64_t)editor->theme_palette.generation, (uint64_t)buffer->language);
+    if (project)
+    {
+        hash = HashIntegers(hash, (uint64_t)project->tag_generation, (uint64_t)project->index.first_file);
+    }
+    hash = HashIntegers(hash, (uint64_t)buffer->style_cache_generation, (uint64_t)core_config->syntax_highlighting);
+
+    // NOTE: 0 is what a line with nothing cached has
+    return hash.u64[0] | 1;
+}
+
+function StyledLine *
+BuildStyledLine(Buffer *buffer, LineIndexIterator *line_it)
+{
+    Arena *arena = &buffer->style_cache_arena;
+
+    LineInfo info;
+    GetLineInfo(line_it, &info);
+
+    int64_t line_start = line_it->range.start;
+    int64_t line_end   = line_it->range.end;
+
+    int64_t token_count = 0;
+    for (TokenIterator it = IterateLineTokens(&info); IsValid(&it) && it.token.pos < line_end; Next(&it))
+    {
+        token_count += 1;
+    }
+
+    StyledLine *result = PushStruct(arena, StyledLine);
+    result->runs = PushArrayNoClear(arena, token_count, StyledRun);
+
+    for (TokenIterator it = IterateLineTokens(&info); IsValid(&it) && it.token.pos < line_end; Next(&it))
+    {
+        Token token = it.token;
+
+        ThemeColorIndex foreground_index = GetThemeIndexForTokenInBuffer(buffer, token);
+
+        Color          foreground = GetPaletteColor(foreground_index);
+        TextStyleFlags style      = GetPaletteStyle(foreground_index);
+
+        if (token.flags & TokenFlag_NonParticipating)
+        {
+            foreground.r = foreground.r / 2;
+            foreground.g = foreground.g / 2;
+            foreground.b = foreground.b / 2;
+        }
+
+        int64_t end = Min(token.pos + token.length, line_end) - line_start;
+
+        StyledRun *prev = (result->run_count > 0 ? &result->runs[result->run_count - 1] : nullptr);
+        if (prev && prev->foreground.u32 == foreground.u32 && prev->style == style)
+        {
+            prev->end = end;
+        }
+        else
+        {
+            StyledRun *run = &result->runs[result->run_count++];
+            run->end        = end;
+            run->foreground = foreground;
+            run->style      = style;
+        }
+    }
+
+    return result;
+}
+
+function StyledLine *
+GetStyledLine(Buffer *buffer, LineIndexIterator *line_it, uint64_t key)
+{
+    LineData *data = &line_it->record->data;
+    if (data->styled_line_key != key || !data->styled_line)
+    {
+        data->styled_line     = BuildStyledLine(buffer, line_it);
+        data->styled_line_key = key;
+    }
+    return data->styled_line;
+}
+
 function int64_t
 DrawTextArea(View *view, Rect2i bounds, bool is_active_window)
 {
     ScopedMemory temp;
 
     Buffer *buffer = GetBuffer(view);
-    Project *project = buffer->project;
-    LanguageSpec *language = buffer->language;
 
     bool draw_cursor    = is_active_window;
     bool draw_selection = (editor->edit_mode != EditMode_Text);
@@ -121,10 +321,7 @@ DrawTextArea(View *view, Rect2i bounds, bool is_active_window)
 
     LineIndexIterator line_it = IterateLineIndexFromLine(buffer, min_line);
 
-    LineInfo info;
-    GetLineInfo(&line_it, &info);
-
-    TokenIterator token_it = IterateLineTokens(&info);
+    uint64_t style_key = GetStyledLineKey(buffer);
 
     int nest_highlight_count = 0;
     Range *nest_highlights = PushArrayNoClear(temp, 64, Range);
@@ -136,28 +333,18 @@ DrawTextArea(View *view, Rect2i bounds, bool is_active_window)
 
         if (GetOtherNestTokenKind(nest_it.token.kind) && IsInTokenRange(nest_it.token, cursor->pos))
         {
-            Direction direction = (IsNestOpener(nest_it.token.kind) ? Direction_Forward : Direction_Backward);
+            Token start_token = nest_it.token;
 
-            NestHelper nests = {};
-            if (IsInNest(&nests, nest_it.token.kind, direction) == NestResult_EnteringNest)
+            int64_t match_pos = FindMatchingNest(buffer, start_token.pos);
+            if (match_pos >= 0)
             {
-                Token start_token = nest_it.token;
-				Token prev = PeekPrev(&nest_it);
-				Range prev_line_range = EncloseLine(buffer, prev.pos, false);
-				nest_preambles[nest_highlight_count] = prev_line_range;
-				
-                Advance(&nest_it, direction);
-
-                for (; IsValid(&nest_it); Advance(&nest_it, direction))
-                {
-                    if (IsInNest(&nests, nest_it.token.kind, direction) == NestResult_ExitingNest)
-                    {
-                        Token end_token = nest_it.token;
-                        if (nest_highlight_count < 64) nest_highlights[nest_highlight_count++] = GetTokenRange(start_token);
-                        if (nest_highlight_count < 64) nest_highlights[nest_highlight_count++] = GetTokenRange(end_token);
-                        break;
-                    }
-                }
+                Token prev = PeekPrev(&nest_it);
+                Range prev_line_range = EncloseLine(buffer, prev.pos, false);
+                nest_preambles[nest_highlight_count] = prev_line_range;
+
+                Token end_token = GetTokenAt(buffer, match_pos);
+                if (nest_highlight_count < 64) nest_highlights[nest_highlight_count++] = GetTokenRange(start_token);
+                if (nest_highlight_count < 64) nest_highlights[nest_highlight_count++] = GetTokenRange(end_token);
             }
         }
     }
@@ -185,6 +372,9 @@ DrawTextArea(View *view, Rect2i bounds, bool is_active_window)
 
         actual_line_height += 1;
 
+        StyledLine *styled_line = GetStyledLine(buffer, &line_it, style_key);
+        int64_t run_index = 0;
+
         bool empty_line = (ReadBufferByte(buffer, line_it.range.start) == '\r' ||
                            ReadBufferByte(buffer, line_it.range.start) == '\n');
         int64_t indentation_end = FindFirstNonHorzWhitespace(buffer, line_it.range.start);
@@ -241,108 +431,17 @@ DrawTextArea(View *view, Rect2i bounds, bool is_active_window)
             // Colorize Tokens
             //
 
-#if 1
-            Token token = token_it.token;
-
-            while (token &&
-                   (pos >= (token.pos + token.length)))
+            while (run_index < styled_line->run_count &&
+                   pos - line_it.range.start >= styled_line->runs[run_index].end)
             {
-                token = Next(&token_it);
+                run_index += 1;
             }
-#else
-            Token token = GetTokenAt(buffer, pos);
-#endif
 
-            if (token)
+            if (run_index < styled_line->run_count)
             {
-                String token_name = MakeString(token.length, &buffer->text[token.pos]);
-
-                StringID foreground_id = "text_foreground"_id;
-                if (core_config->syntax_highlighting)
-                {
-                    foreground_id = GetThemeIDForToken(language, &token);
-                    // FIXME: Decide what to do about highlighting untagged functions
-                    if (token.kind == Token_Function)
-                    {
-                        foreground_id = "text_unknown_function"_id;
-                    }
-
-                    if (token.kind == Token_Identifier ||
-                        token.kind == Token_Function)
-                    {
-                        String string = MakeString(token.length, &buffer->text[token.pos]);
-                        StringID id = HashStringID(string);
-                        TokenKind kind = GetTokenKindFromStringID(language, id);
-                        if (kind)
-                        {
-                            foreground_id = GetThemeIDForToken(language, &token);
-                            token.kind = kind; // TODO: questionable! deferring the lookup to only do visible areas is good,
-                                                // but maybe it should be moved outside of the actual drawing function
-                        }
-
-                        ScopedMemory tag_temp;
-                        // TODO: Bit excessive
-                        for (Tag *tag = PushTagsWithName(tag_temp, project, token_name); tag; tag = tag->next)
-                        {
-                            if (tag->related_token_kind == token.kind)
-                            {
-                                if (tag->kind == Tag_CommentAnnotation)
-                                {
-                                    if (HasFlag(token.flags, TokenFlag_IsComment))
-                                    {
-                                        foreground_id = GetThemeIDForTag(language, tag);
-                                    }
-                                }
-                                else
-                                {
-                                    foreground_id = GetThemeIDForTag(language, tag);
-                                }
-                                break;
-                            }
-                        }
-                    }
-
-                    if (HasFlag(token.flags, TokenFlag_IsComment))
-                    {
-                        if (foreground_id != "text_comment_annotation"_id)
-                        {
-                            foreground_id = "text_comment"_id;
-                            if (AreEqual(token_name, "NOTE"_str, StringMatch_CaseInsensitive))
-                            {
-                                foreground_id = "text_comment_note"_id;
-                            }
-                            else if (AreEqual(token_name, "TODO"_str, StringMatch_CaseInsensitive))
-                            {
-                                foreground_id = "text_comment_todo"_id;
-                            }
-                            else if (AreEqual(token_name, "FIXME"_str, StringMatch_CaseInsensitive))
-                            {
-                                foreground_id = "text_comment_fixme"_id;
-                            }
-                        }
-                    }
-                    else if (HasFlag(token.flags, TokenFlag_PartOfString))
-                    {
-                        if (foreground_id != "text_string_special"_id)
-                        {
-                            foreground_id = "text_string"_id;
-                        }
-                    }
-                    else if (HasFlag(token.flags, TokenFlag_IsPreprocessor))
-                    {
-                        foreground_id = "text_preprocessor"_id;
-                    }
-                }
-
-                foreground = GetThemeColor(foreground_id);
-                text_style = GetThemeStyle(foreground_id);
-
-                if (token.flags & TokenFlag_NonParticipating)
-                {
-                    foreground.r = foreground.r / 2;
-                    foreground.g = foreground.g / 2;
-                    foreground.b = foreground.b / 2;
-                }
+                StyledRun *run = &styled_line->runs[run_index];
+                foreground = run->foreground;
+                text_style = run->style;
             }
 
             String string = {};
@@ -574,12 +673,57 @@ DrawTextArea(View *view, Rect2i bounds, bool is_active_window)
     return actual_line_height;
 }
 
+function int64_t
+DrawLoadingView(View *view, bool is_active_window)
+{
+    Buffer *buffer = GetBuffer(view);
+    Rect2i bounds = view->viewport;
+
+    Color text_foreground_dim     = GetThemeColor("text_foreground_dim"_id);
+    Color text_background         = GetThemeColor(is_active_window ? "text_background"_id : "text_background_inactive"_id);
+    Color filebar_text_foreground = GetThemeColor("filebar_text_foreground"_id);
+    Color filebar_text_background = GetThemeColor(is_active_window ? "filebar_text_background"_id : "filebar_text_inactive"_id);
+
+    static const char *stage_names[] =
+    {
+        "reading", "tokenizing", "parsing tags", "finishing up",
+    };
+    StaticAssert(ArrayCount(stage_names) == BufferLoad_Loaded, "Stage names must match BufferLoadState");
+
+    String leaf;
+    SplitPath(buffer->name, &leaf);
+
+    int64_t filebar_y = bounds.max.y - 1;
+
+    PushLayer(Layer_ViewForeground);
+    DrawText(MakeV2i(bounds.min.x + 1, bounds.min.y),
+             PushTempStringF("loading %.*s (%s)...", StringExpand(leaf), stage_names[buffer->load_state]),
+             text_foreground_dim, text_background);
+    DrawText(MakeV2i(bounds.min.x, filebar_y),
+             PushTempStringF("%hd:%.*s", buffer->id.index, StringExpand(leaf)),
+             filebar_text_foreground, filebar_text_background);
+
+    PushLayer(Layer_ViewBackground);
+    PushRect(MakeRect2iMinMax(MakeV2i(bounds.min.x, filebar_y), MakeV2i(bounds.max.x, filebar_y + 1)), filebar_text_background);
+
+    int64_t result = Max(0, GetHeight(bounds) - 1);
+    return result;
+}
+
 function int64_t
 DrawView(View *view, bool is_active_window)
 {
+    TimedFunction;
+
     Buffer *buffer = GetBuffer(view);
     Rect2i bounds = view->viewport;
 
+    // NOTE: Drawing needs the line index and tokens, until the buffer has those there's nothing to show
+    if (!IsBufferLoaded(buffer, BufferLoad_Tokenized))
+    {
+        return DrawLoadingView(view, is_active_window);
+    }
+
     PushLayer(Layer_ViewForeground);
 
     Color text_foreground          = GetThemeColor("text_foreground"_id);
@@ -806,12 +950,12 @@ DrawCommandLines()
 
     int64_t height = GetHeight(render_state->viewport);
     int64_t max_visible_predictions = height - 1;
-    bool prediction_overflow = cl->prediction_count - cl->scroll_offset > max_visible_predictions;
+    bool more_below = cl->prediction_count - cl->scroll_offset > max_visible_predictions;
 
     int64_t offset_visible_predictions = Min(cl->prediction_count - cl->scroll_offset, max_visible_predictions);
 
     int64_t total_width  = 0;
-    int64_t total_height = offset_visible_predictions;
+    int64_t total_height = 0;
 
     if (cl->highlight_numbers)
     {
@@ -824,10 +968,14 @@ DrawCommandLines()
     {
         active_prediction = GetPrediction(cl, 0);
 
+        // NOTE: Only the rows on screen get looked at, no matter how many predictions there are
+        int visible_count = (int)(offset_visible_predictions - more_below);
+
         int y_offset = 1;
-		for (int y = 0; y < offset_visible_predictions - prediction_overflow; y += 1)
+        for (PredictionIterator it = IteratePredictions(cl, cl->scroll_offset, visible_count); IsValid(&it); Next(&it))
         {
-            int prediction_index = y + cl->scroll_offset;
+            int prediction_index = it.index;
+            int y = prediction_index - cl->scroll_offset;
 
             Color bg = overlay_background;
             if (prediction_index == 0 || prediction_index == cl->prediction_count - 1)
@@ -835,8 +983,8 @@ DrawCommandLines()
                 bg = text_background_2;
             }
 
-            Prediction *prediction = GetPrediction(cl, prediction_index);
-            String text = prediction->preview_text;
+            Prediction *prediction = it.prediction;
+            String text = GetPreviewText(cl, prediction);
 
             Color color = GetThemeColor(prediction->color ? prediction->color : "command_line_option"_id);
             if (prediction_index == cl->prediction_selected_index)
@@ -862,10 +1010,19 @@ DrawCommandLines()
             y_offset += 1;
         }
         
-		if (prediction_overflow)
+        if (more_below)
         {
-            DrawText(p + MakeV2i(2, -y_offset), "... and more"_str, color_option, overlay_background);
+            int more_count = cl->prediction_count - cl->scroll_offset - visible_count;
+            String more_text = PushTempStringF("... and %d more", more_count);
+            DrawText(p + MakeV2i(2, -y_offset), more_text, color_option, overlay_background);
+
+            total_width = Max(total_width, 2 + (int64_t)more_text.size);
+
+            y_offset += 1;
         }
+
+        // NOTE: Covers the "... and N more" row too, so it doesn't end up drawn over the views behind it
+        total_height = y_offset - 1;
     }
 
     PushLayer(Layer_OverlayBackground);
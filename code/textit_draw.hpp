@@ -1,6 +1,24 @@
 #ifndef TEXTIT_DRAW_HPP
 #define TEXTIT_DRAW_HPP
 
+// NOTE: The syntax highlighting of a line, resolved down to colors. Runs are contiguous, each
+// one going from where the previous one ended up to end (relative to the start of the line), and
+// anything past the last run gets the default text colors.
+struct StyledRun
+{
+    int64_t        end;
+    Color          foreground;
+    TextStyleFlags style;
+};
+
+struct StyledLine
+{
+    int64_t    run_count;
+    StyledRun *runs;
+};
+
+#define STYLE_CACHE_BUDGET Megabytes(4)
+
 function int64_t DrawView(View *view, bool is_active_window);
 function void DrawCommandLines();
 
@@ -0,0 +1,479 @@
+//
+// Globs
+//
+
+function bool
+MatchGlobClass(String glob, size_t *at, uint8_t c)
+{
+    // NOTE: *at points just past the '['
+    size_t i = *at;
+
+    bool negate = false;
+    if (i < glob.size && (glob.data[i] == '!' || glob.data[i] == '^'))
+    {
+        negate = true;
+        i += 1;
+    }
+
+    bool result = false;
+    bool first  = true;
+    while (i < glob.size && (first || glob.data[i] != ']'))
+    {
+        first = false;
+
+        uint8_t lo = glob.data[i];
+        uint8_t hi = lo;
+        if (i + 2 < glob.size && glob.data[i + 1] == '-' && glob.data[i + 2] != ']')
+        {
+            hi = glob.data[i + 2];
+            i += 2;
+        }
+
+        if (c >= lo && c <= hi)
+        {
+            result = true;
+        }
+
+        i += 1;
+    }
+
+    *at = i + 1;
+    return result != negate;
+}
+
+// NOTE: Gitignore flavoured globs: '*' and '?' stop at path separators, '**' doesn't, and "**/" matches zero
+// or more whole directories. Either kind of slash in the glob matches either kind in the text.
+function bool
+MatchGlob(String glob, String text)
+{
+    size_t g = 0;
+    size_t t = 0;
+    while (g < glob.size)
+    {
+        uint8_t c = glob.data[g];
+        if (c == '*')
+        {
+            bool any_depth = (Peek(glob, g + 1) == '*');
+            g += (any_depth ? 2 : 1);
+
+            if (any_depth && IsPathSeparator(Peek(glob, g)))
+            {
+                String rest = Advance(glob, g + 1);
+                if (MatchGlob(rest, Advance(text, t)))
+                {
+                    return true;
+                }
+                for (size_t i = t; i < text.size; i += 1)
+                {
+                    if (IsPathSeparator(text.data[i]) && MatchGlob(rest, Advance(text, i + 1)))
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            String rest = Advance(glob, g);
+            for (size_t i = t; i <= text.size; i += 1)
+            {
+                if (MatchGlob(rest, Advance(text, i)))
+                {
+                    return true;
+                }
+                if (i < text.size && !any_depth && IsPathSeparator(text.data[i]))
+                {
+                    break;
+                }
+            }
+            return false;
+        }
+
+        if (t >= text.size)
+        {
+            return false;
+        }
+
+        uint8_t tc = text.data[t];
+        if (c == '?')
+        {
+            if (IsPathSeparator(tc)) return false;
+            g += 1;
+        }
+        else if (c == '[' && FindSubstring(Advance(glob, g + 2), "]"_str) < glob.size - g - 2)
+        {
+            g += 1;
+            if (IsPathSeparator(tc) || !MatchGlobClass(glob, &g, tc)) return false;
+        }
+        else
+        {
+            if (c == '\\' && g + 1 < glob.size)
+            {
+                // NOTE: Escaped, match the next character literally
+                g += 1;
+                c = glob.data[g];
+            }
+
+            bool matches = (c == tc) || (IsPathSeparator(c) && IsPathSeparator(tc));
+            if (!matches) return false;
+            g += 1;
+        }
+
+        t += 1;
+    }
+
+    return t == text.size;
+}
+
+//
+// Ignore Rules
+//
+
+function void
+AddIgnorePattern(Arena *arena, IgnoreRules *rules, String pattern)
+{
+    IgnorePattern *result = PushStruct(arena, IgnorePattern);
+
+    if (Peek(pattern, 0) == '!')
+    {
+        result->negate = true;
+        pattern = Advance(pattern);
+    }
+
+    if (IsPathSeparator(PeekEnd(pattern)))
+    {
+        result->directory_only = true;
+        pattern.size -= 1;
+    }
+
+    // NOTE: A slash anywhere but the end ties the pattern to the directory of the ignore file
+    for (size_t i = 0; i < pattern.size; i += 1)
+    {
+        if (IsPathSeparator(pattern.data[i]))
+        {
+            result->anchored = true;
+            break;
+        }
+    }
+
+    if (IsPathSeparator(Peek(pattern, 0)))
+    {
+        pattern = Advance(pattern);
+    }
+
+    if (pattern.size == 0)
+    {
+        return;
+    }
+
+    result->glob = PushString(arena, pattern);
+
+    if (rules->last_pattern)
+    {
+        rules->last_pattern->next = result;
+    }
+    else
+    {
+        rules->first_pattern = result;
+    }
+    rules->last_pattern = result;
+}
+
+function void
+AddIgnorePatterns(Arena *arena, IgnoreRules *rules, String patterns)
+{
+    // NOTE: One pattern per line like a .gitignore, but patterns can also be separated by spaces so a
+    // list fits on one line of a config file. The price is that patterns can't contain spaces.
+    while (patterns.size > 0)
+    {
+        String line = SplitLine(patterns, &patterns);
+        line = TrimSpaces(line);
+
+        if (Peek(line, 0) == '#')
+        {
+            continue;
+        }
+
+        while (line.size > 0)
+        {
+            size_t end = 0;
+            while (end < line.size && !IsWhitespaceAscii(line.data[end])) end += 1;
+
+            AddIgnorePattern(arena, rules, Substring(line, 0, end));
+
+            line = TrimSpaces(Advance(line, end));
+        }
+    }
+}
+
+function bool
+IsIgnored(IgnoreRules *rules, String path, String name, bool directory)
+{
+    for (IgnoreRules *level = rules; level; level = level->parent)
+    {
+        if (!MatchPrefix(path, level->base))
+        {
+            continue;
+        }
+
+        String relative = Advance(path, level->base.size);
+
+        bool matched = false;
+        bool ignored = false;
+        for (IgnorePattern *pattern = level->first_pattern; pattern; pattern = pattern->next)
+        {
+            if (pattern->directory_only && !directory)
+            {
+                continue;
+            }
+
+            if (MatchGlob(pattern->glob, pattern->anchored ? relative : name))
+            {
+                matched = true;
+                ignored = !pattern->negate;
+            }
+        }
+
+        // NOTE: Deeper ignore files take precedence, and within one file the last matching pattern wins
+        if (matched)
+        {
+            return ignored;
+        }
+    }
+
+    return false;
+}
+
+//
+// File Walker
+//
+
+struct FileWalkerDirectory
+{
+    FileWalker *walker;
+    IgnoreRules *rules;
+    String path; // NOTE: ends in a separator
+};
+
+struct FileWalkerFile
+{
+    FileWalker *walker;
+    String path;
+};
+
+struct FileWalkerEntry
+{
+    FileWalkerEntry *next;
+    String path;
+    bool directory;
+    bool queue; // NOTE: files that get visited by a job of their own rather than the directory job
+
+    void *job_params;
+};
+
+function
+PLATFORM_JOB(FileWalkerFileJob)
+{
+    FileWalkerFile *file = (FileWalkerFile *)userdata;
+    FileWalker *walker = file->walker;
+
+    if (!walker->cancel)
+    {
+        walker->Visit(walker, file->path);
+    }
+
+    AtomicAdd(&walker->files_in_flight, (uint32_t)-1);
+}
+
+function
+PLATFORM_JOB(FileWalkerDirectoryJob)
+{
+    FileWalkerDirectory *directory = (FileWalkerDirectory *)userdata;
+    FileWalker *walker = directory->walker;
+
+    if (walker->cancel)
+    {
+        return;
+    }
+
+    AtomicIncrement(&walker->directory_count);
+
+    ScopedMemory temp;
+
+    IgnoreRules *rules = directory->rules;
+
+    // NOTE: The .gitignore has to be in effect before looking at anything else in the directory,
+    // so rather than waiting to come across it in the listing it gets looked up directly
+    String gitignore_path = PushStringF(temp, "%.*s.gitignore", StringExpand(directory->path));
+    if (platform->GetFileSize(gitignore_path) > 0)
+    {
+        String gitignore = platform->ReadFile(temp, gitignore_path);
+
+        BeginTicketMutex(&walker->mutex);
+        IgnoreRules *child_rules = PushStruct(&walker->arena, IgnoreRules);
+        child_rules->parent = rules;
+        child_rules->base   = directory->path;
+        AddIgnorePatterns(&walker->arena, child_rules, gitignore);
+        EndTicketMutex(&walker->mutex);
+
+        rules = child_rules;
+    }
+
+    FileWalkerEntry *first_entry = nullptr;
+    FileWalkerEntry *last_entry  = nullptr;
+
+    for (PlatformFileIterator *it = platform->FindFiles(temp, directory->path);
+         platform->FileIteratorIsValid(it);
+         platform->FileIteratorNext(it))
+    {
+        if (walker->cancel) break;
+
+        String name = it->info.name;
+        if (AreEqual(name, "."_str) || AreEqual(name, ".."_str)) continue;
+
+        String path = PushStringF(temp, "%.*s%.*s", StringExpand(directory->path), StringExpand(name));
+
+        if (IsIgnored(rules, path, name, it->info.directory))
+        {
+            AtomicIncrement(&walker->ignored_count);
+            continue;
+        }
+
+        if (!it->info.directory)
+        {
+            AtomicIncrement(&walker->file_count);
+
+            if (walker->Filter && !walker->Filter(walker, path, name))
+            {
+                continue;
+            }
+
+            if (!walker->Visit)
+            {
+                continue;
+            }
+        }
+
+        FileWalkerEntry *entry = PushStruct(temp, FileWalkerEntry);
+        entry->path      = path;
+        entry->directory = it->info.directory;
+
+        if (!entry->directory)
+        {
+            if (AtomicIncrement(&walker->files_in_flight) < walker->max_files_in_flight)
+            {
+                entry->queue = true;
+            }
+            else
+            {
+                AtomicAdd(&walker->files_in_flight, (uint32_t)-1);
+            }
+        }
+
+        SllQueuePush(first_entry, last_entry, entry);
+    }
+
+    // NOTE: Everything queued from this directory gets its memory in one go, so the walker's mutex
+    // is taken once per directory rather than once per file
+    BeginTicketMutex(&walker->mutex);
+    for (FileWalkerEntry *entry = first_entry; entry; entry = entry->next)
+    {
+        if (entry->directory)
+        {
+            FileWalkerDirectory *child = PushStruct(&walker->arena, FileWalkerDirectory);
+            child->walker = walker;
+            child->rules  = rules;
+            child->path   = PushStringF(&walker->arena, "%.*s/", StringExpand(entry->path));
+
+            entry->job_params = child;
+        }
+        else if (entry->queue)
+        {
+            FileWalkerFile *file = PushStruct(&walker->arena, FileWalkerFile);
+            file->walker = walker;
+            file->path   = PushString(&walker->arena, entry->path);
+
+            entry->job_params = file;
+        }
+    }
+    EndTicketMutex(&walker->mutex);
+
+    for (FileWalkerEntry *entry = first_entry; entry; entry = entry->next)
+    {
+        if (entry->directory)
+        {
+            platform->AddJobToGroup(walker->queue, &walker->jobs, entry->job_params, FileWalkerDirectoryJob);
+        }
+        else if (entry->queue)
+        {
+            platform->AddJobToGroup(walker->queue, &walker->jobs, entry->job_params, FileWalkerFileJob);
+        }
+    }
+
+    // NOTE: Enough files were in flight already when these came along, so they get visited right here instead
+    for (FileWalkerEntry *entry = first_entry; entry; entry = entry->next)
+    {
+        if (walker->cancel) break;
+
+        if (!entry->directory && !entry->queue)
+        {
+            walker->Visit(walker, entry->path);
+        }
+    }
+}
+
+function void
+BeginFileWalk(FileWalker *walker, PlatformJobQueue *queue, String root, String ignore_patterns)
+{
+    walker->queue      = queue;
+    walker->start_time = platform->GetTime();
+    if (!walker->max_files_in_flight)
+    {
+        walker->max_files_in_flight = FILE_WALKER_MAX_FILES_IN_FLIGHT;
+    }
+
+    String root_path = (IsPathSeparator(PeekEnd(root))
+                        ? PushString(&walker->arena, root)
+                        : PushStringF(&walker->arena, "%.*s/", StringExpand(root)));
+
+    IgnoreRules *rules = PushStruct(&walker->arena, IgnoreRules);
+    rules->base = root_path;
+
+    // NOTE: Git never looks inside its own directory, and neither should we
+    AddIgnorePatterns(&walker->arena, rules, ".git/"_str);
+    AddIgnorePatterns(&walker->arena, rules, ignore_patterns);
+
+    FileWalkerDirectory *directory = PushStruct(&walker->arena, FileWalkerDirectory);
+    directory->walker = walker;
+    directory->rules  = rules;
+    directory->path   = root_path;
+
+    platform->AddJobToGroup(queue, &walker->jobs, directory, FileWalkerDirectoryJob);
+}
+
+function void
+WaitForFileWalk(FileWalker *walker)
+{
+    platform->WaitForJobGroup(&walker->jobs);
+}
+
+function void
+CancelFileWalk(FileWalker *walker)
+{
+    walker->cancel = true;
+    WaitForFileWalk(walker);
+}
+
+function void
+EndFileWalk(FileWalker *walker)
+{
+    Assert(!walker->jobs.pending);
+    Release(&walker->arena);
+}
+
+function double
+GetFileWalkFilesPerSecond(FileWalker *walker)
+{
+    double seconds = platform->SecondsElapsed(walker->start_time, platform->GetTime());
+    double result = (seconds > 0.0 ? (double)walker->file_count / seconds : 0.0);
+    return result;
+}
@@ -0,0 +1,73 @@
+#ifndef TEXTIT_FILE_WALKER_HPP
+#define TEXTIT_FILE_WALKER_HPP
+
+//
+// NOTE: Walks a directory tree on the job queue, one job per directory, skipping whatever the .gitignore
+// files along the way (and any extra patterns handed to BeginFileWalk) say to skip. Files that make it
+// through the filter get visited in jobs of their own, up to max_files_in_flight at a time. Past that the
+// directory job visits them itself, which keeps a huge tree from flooding the queue.
+//
+
+#define FILE_WALKER_MAX_FILES_IN_FLIGHT 64
+
+struct FileWalker;
+
+#define FILE_WALKER_FILTER(proc_name) bool proc_name(FileWalker *walker, String path, String name)
+typedef FILE_WALKER_FILTER(FileWalkerFilterProc);
+
+#define FILE_WALKER_VISIT(name) void name(FileWalker *walker, String path)
+typedef FILE_WALKER_VISIT(FileWalkerVisitProc);
+
+struct IgnorePattern
+{
+    IgnorePattern *next;
+
+    String glob;
+    bool negate;         // "!pattern", un-ignores what an earlier pattern ignored
+    bool directory_only; // "pattern/"
+    bool anchored;       // matched against the path relative to the ignore file, rather than just the name
+};
+
+struct IgnoreRules
+{
+    IgnoreRules *parent;
+
+    String base; // NOTE: the directory the patterns are relative to, ending in a separator
+    IgnorePattern *first_pattern;
+    IgnorePattern *last_pattern;
+};
+
+struct FileWalker
+{
+    PlatformJobQueue *queue;
+    PlatformJobGroup jobs;
+
+    FileWalkerFilterProc *Filter; // NOTE: runs on the directory job for every file that isn't ignored
+    FileWalkerVisitProc  *Visit;  // NOTE: runs for every file the filter let through, may be null
+    void *userdata;
+
+    uint32_t max_files_in_flight;
+    volatile uint32_t files_in_flight;
+
+    volatile bool cancel;
+
+    TicketMutex mutex; // NOTE: guards the arena
+    Arena arena;
+
+    volatile uint32_t directory_count;
+    volatile uint32_t file_count;
+    volatile uint32_t ignored_count;
+
+    PlatformHighResTime start_time;
+};
+
+function bool MatchGlob(String glob, String text);
+function void AddIgnorePatterns(Arena *arena, IgnoreRules *rules, String patterns);
+
+function void BeginFileWalk(FileWalker *walker, PlatformJobQueue *queue, String root, String ignore_patterns);
+function void WaitForFileWalk(FileWalker *walker);
+function void CancelFileWalk(FileWalker *walker);
+function void EndFileWalk(FileWalker *walker);
+function double GetFileWalkFilesPerSecond(FileWalker *walker);
+
+#endif /* TEXTIT_FILE_WALKER_HPP */
@@ -1,34 +1,75 @@
 function void
-ResizeGlyphCache(GlyphCache *cache, uint32_t size)
+AddGlyphCachePage(GlyphCache *cache)
 {
-    if (cache->size)
+    Assert(cache->size + cache->entries_per_page <= cache->max_size);
+
+    uint32_t first = cache->size;
+
+    // NOTE: Nothing else lives on the arena after the lookup table, so the pages stay contiguous
+    GlyphEntry *page = PushArray(&cache->arena, cache->entries_per_page, GlyphEntry);
+    Assert(page == cache->entries + first);
+
+    cache->size += cache->entries_per_page;
+
+    // NOTE: Pages are only added when the free list is empty, so the new entries simply become it.
+    // The first entry of the first page is the sentinel.
+    GlyphEntry *sentinel = cache->entries;
+    uint32_t first_free = (first == 0 ? 1 : first);
+    for (uint32_t i = first_free; i < cache->size; i += 1)
     {
-        Release(&cache->arena);
-        ZeroStruct(cache);
+        GlyphEntry *entry = &cache->entries[i];
+        entry->index = i;
+        entry->next_in_hash = (i + 1 < cache->size ? i + 1 : 0);
     }
-    
-    cache->size = size;
-    cache->lookup_table = PushArray(&cache->arena, 4*size / 3, uint32_t);
-    cache->entries      = PushArray(&cache->arena, size, GlyphEntry);
+    sentinel->next_in_hash = first_free;
 
-    for (size_t i = 0; i < size; i += 1)
+    cache->stats.pages_added += 1;
+}
+
+function void
+InitGlyphCache(GlyphCache *cache, uint32_t entries_per_page, uint32_t max_pages)
+{
+    if (cache->max_size)
     {
-        GlyphEntry *entry = &cache->entries[i];
-        entry->index = (uint32_t)i;
-        entry->next_in_hash = ((uint32_t)i + 1) % size;
+        Release(&cache->arena);
+        ZeroStruct(cache);
     }
+
+    Assert(max_pages > 0);
+
+    cache->entries_per_page = entries_per_page;
+    cache->max_size         = entries_per_page*max_pages;
+    cache->lookup_size      = 4*cache->max_size / 3;
+    cache->lookup_table     = PushArray(&cache->arena, cache->lookup_size, uint32_t);
+    cache->entries          = (GlyphEntry *)GetNextAllocationLocation(&cache->arena, alignof(GlyphEntry));
+
+    AddGlyphCachePage(cache);
+}
+
+function uint32_t
+GetGlyphCachePageCount(GlyphCache *cache)
+{
+    uint32_t result = cache->size / cache->entries_per_page;
+    return result;
+}
+
+function void
+RollGlyphCacheStats(GlyphCache *cache)
+{
+    cache->last_stats = cache->stats;
+    ZeroStruct(&cache->stats);
 }
 
 function GlyphEntry *
 GetGlyphEntry(GlyphCache *cache, HashResult hash)
 {
-    Assert(cache->size);
+    Assert(cache->max_size);
 
     GlyphEntry *sentinel = cache->entries;
     GlyphEntry *result   = nullptr;
 
     {
-        uint32_t index = cache->lookup_table[hash.u32[0] % cache->size];
+        uint32_t index = cache->lookup_table[hash.u32[0] % cache->lookup_size];
         while (index)
         {
             GlyphEntry *entry = &cache->entries[index];
@@ -41,8 +82,23 @@ GetGlyphEntry(GlyphCache *cache, HashResult hash)
         }
     }
 
-    if (!result)
+    if (result)
+    {
+        cache->stats.hits += 1;
+
+        // remove result from lru, it gets put back at the end below
+        cache->entries[result->next_lru].prev_lru = result->prev_lru;
+        cache->entries[result->prev_lru].next_lru = result->next_lru;
+    }
+    else
     {
+        cache->stats.misses += 1;
+
+        if (!sentinel->next_in_hash && cache->size < cache->max_size)
+        {
+            AddGlyphCachePage(cache);
+        }
+
         if (sentinel->next_in_hash)
         {
             result = &cache->entries[sentinel->next_in_hash];
@@ -52,13 +108,14 @@ GetGlyphEntry(GlyphCache *cache, HashResult hash)
         else
         {
             result = &cache->entries[sentinel->next_lru];
+            cache->stats.evictions += 1;
 
             // remove result from lru
             cache->entries[result->next_lru].prev_lru = result->prev_lru;
             cache->entries[result->prev_lru].next_lru = result->next_lru;
 
             // evict old entry if there is one
-            uint32_t *prev_index_at = &cache->lookup_table[result->hash.u32[0] % cache->size];
+            uint32_t *prev_index_at = &cache->lookup_table[result->hash.u32[0] % cache->lookup_size];
             while (*prev_index_at)
             {
                 GlyphEntry *entry = &cache->entries[*prev_index_at];
@@ -75,7 +132,7 @@ GetGlyphEntry(GlyphCache *cache, HashResult hash)
         result->hash  = hash;
         result->state = GlyphState_Empty;
 
-        uint32_t *index_at = &cache->lookup_table[hash.u32[0] % cache->size];
+        uint32_t *index_at = &cache->lookup_table[hash.u32[0] % cache->lookup_size];
         result->next_in_hash = *index_at;
         *index_at = result->index;
     }
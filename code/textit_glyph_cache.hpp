@@ -21,15 +21,38 @@ struct GlyphEntry
     uint32_t next_in_hash;
     uint32_t next_lru;
     uint32_t prev_lru;
+
+    uint32_t last_used_batch;
 };
 
+#define GLYPH_CACHE_ENTRIES_PER_PAGE 1024
+#define GLYPH_CACHE_MAX_PAGES        64
+
+struct GlyphCacheStats
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t pages_added;
+};
+
+// NOTE: The cache starts out with a single page of entries and adds pages when it runs out of free
+// entries, until it hits max_size. Only then does it start evicting. Entries never move, so the
+// entry at index i always lives in page i / entries_per_page.
 struct GlyphCache
 {
     Arena arena;
 
     uint32_t size;
+    uint32_t max_size;
+    uint32_t entries_per_page;
+
+    uint32_t lookup_size;
     uint32_t *lookup_table; 
     GlyphEntry *entries;
+
+    GlyphCacheStats stats;      // counting up for the current frame
+    GlyphCacheStats last_stats; // the last complete frame
 };
 
 #endif /* TEXTIT_GLYPH_CACHE_HPP */
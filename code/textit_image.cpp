@@ -111,3 +111,52 @@ ParseBitmap(Arena *arena, String buffer)
     
     return result;
 }
+
+static Font
+MakeFont(Bitmap bitmap, int32_t glyph_w, int32_t glyph_h)
+{
+    Font font = {};
+
+    font.w       = bitmap.w;
+    font.h       = bitmap.h;
+    font.pitch   = bitmap.pitch;
+    font.glyph_w = glyph_w;
+    font.glyph_h = glyph_h;
+
+    // you probably got it wrong if there's slop
+    Assert(font.w % glyph_w == 0);
+    Assert(font.h % glyph_h == 0);
+
+    font.glyphs_per_row = font.w / glyph_w;
+    font.glyphs_per_col = font.h / glyph_h;
+    font.glyph_count = font.glyphs_per_col*font.glyphs_per_row;
+
+    font.data = bitmap.data;
+
+    return font;
+}
+
+function Font
+LoadFontFromDisk(Arena *arena, String filename, int glyph_w, int glyph_h)
+{
+    Font result = {};
+
+    String file = platform->ReadFile(platform->GetTempArena(), filename);
+    if (!file.size)
+    {
+        platform->ReportError(PlatformError_Nonfatal,
+                              "Could not open file '%.*s' while loading font.", StringExpand(filename));
+        return result;
+    }
+
+    Bitmap bitmap = ParseBitmap(arena, file);
+    if (!bitmap.data)
+    {
+        platform->ReportError(PlatformError_Nonfatal,
+                              "Failed to parse bitmap '%.*s' while loading font.", StringExpand(filename));
+        return result;
+    }
+
+    result = MakeFont(bitmap, glyph_w, glyph_h);
+    return result;
+}
@@ -1,11 +1,24 @@
 #ifndef TEXTIT_INTRINSICS_HPP
 #define TEXTIT_INTRINSICS_HPP
 
+#if _WIN32
 #include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
 #include <immintrin.h>
 #include <xmmintrin.h>
 #include <wmmintrin.h>
 
+#if COMPILER_MSVC
+#define TARGET_AVX2
+#define TARGET_XSAVE
+#else
+#define TARGET_AVX2  __attribute__((target("avx2")))
+#define TARGET_XSAVE __attribute__((target("xsave")))
+#endif
+
 static inline uint32_t
 RotateLeft(uint32_t value, int32_t amount)
 {
@@ -58,6 +71,58 @@ FindLeastSignificantSetBit(uint32_t value)
     return result;
 }
 
+static inline BitScanResult
+FindMostSignificantSetBit(uint64_t value)
+{
+    BitScanResult result = {};
+
+#if COMPILER_MSVC
+    result.found = _BitScanReverse64((unsigned long*)&result.index, value);
+#else
+    if (value)
+    {
+        result.found = true;
+        result.index = 63 - (uint32_t)__builtin_clzll(value);
+    }
+#endif
+    return result;
+}
+
+struct CpuFeatures
+{
+    bool sse2;
+    bool avx2;
+};
+
+static inline TARGET_XSAVE CpuFeatures
+GetCpuFeatures(void)
+{
+    CpuFeatures result = {};
+
+    int info[4];
+    __cpuidex(info, 0, 0);
+    int max_leaf = info[0];
+
+    __cpuidex(info, 1, 0);
+    result.sse2 = !!(info[3] & (1 << 26));
+
+    bool os_saves_ymm = false;
+    if ((info[2] & (1 << 27)) && // OSXSAVE
+        (info[2] & (1 << 28)))   // AVX
+    {
+        uint64_t xcr0 = _xgetbv(0);
+        os_saves_ymm = ((xcr0 & 0x6) == 0x6);
+    }
+
+    if (max_leaf >= 7 && os_saves_ymm)
+    {
+        __cpuidex(info, 7, 0);
+        result.avx2 = !!(info[1] & (1 << 5));
+    }
+
+    return result;
+}
+
 static inline uint64_t
 ExtractU64(__m128i v, int index)
 {
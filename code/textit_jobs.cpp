@@ -0,0 +1,614 @@
+static JobScheduler *job_scheduler_;
+static thread_local JobWorker *job_worker_;
+
+//
+// Semaphore
+//
+
+#if _WIN32
+function void
+InitializeJobSemaphore(JobSemaphore *semaphore)
+{
+    semaphore->handle = CreateSemaphoreA(NULL, 0, LONG_MAX, NULL);
+}
+
+function void
+SignalJobSemaphore(JobSemaphore *semaphore)
+{
+    ReleaseSemaphore(semaphore->handle, 1, NULL);
+}
+
+function void
+WaitJobSemaphore(JobSemaphore *semaphore)
+{
+    WaitForSingleObject(semaphore->handle, INFINITE);
+}
+
+function void
+DestroyJobSemaphore(JobSemaphore *semaphore)
+{
+    CloseHandle(semaphore->handle);
+}
+#else
+function void
+InitializeJobSemaphore(JobSemaphore *semaphore)
+{
+    sem_init(&semaphore->sem, 0, 0);
+}
+
+function void
+SignalJobSemaphore(JobSemaphore *semaphore)
+{
+    sem_post(&semaphore->sem);
+}
+
+function void
+WaitJobSemaphore(JobSemaphore *semaphore)
+{
+    while (sem_wait(&semaphore->sem) != 0 && errno == EINTR);
+}
+
+function void
+DestroyJobSemaphore(JobSemaphore *semaphore)
+{
+    sem_destroy(&semaphore->sem);
+}
+#endif
+
+//
+// Deques
+//
+
+function bool
+PushJobDeque(JobDeque *deque, JobEntry *entry)
+{
+    uint32_t bottom = deque->bottom;
+    uint32_t top    = deque->top;
+    if (bottom - top >= JOB_DEQUE_SIZE)
+    {
+        return false;
+    }
+
+    deque->entries[bottom & (JOB_DEQUE_SIZE - 1)] = *entry;
+    WRITE_BARRIER;
+    deque->bottom = bottom + 1;
+
+    return true;
+}
+
+function bool
+PopJobDeque(JobDeque *deque, JobEntry *out_entry)
+{
+    uint32_t bottom = deque->bottom - 1;
+    deque->bottom = bottom;
+
+    // NOTE: Thieves must see the new bottom before we look at top, or we could both take the last job
+    FULL_BARRIER;
+
+    uint32_t top = deque->top;
+
+    bool result = false;
+    if ((int32_t)(bottom - top) >= 0)
+    {
+        *out_entry = deque->entries[bottom & (JOB_DEQUE_SIZE - 1)];
+        result = true;
+
+        if (bottom == top)
+        {
+            // NOTE: That was the last job, which a thief might be trying to take at the same time
+            result = (AtomicCompareExchange(&deque->top, top, top + 1) == top);
+            deque->bottom = top + 1;
+        }
+    }
+    else
+    {
+        deque->bottom = top;
+    }
+
+    return result;
+}
+
+function bool
+StealJobDeque(JobDeque *deque, JobEntry *out_entry)
+{
+    uint32_t top = deque->top;
+    READ_BARRIER;
+    uint32_t bottom = deque->bottom;
+
+    bool result = false;
+    if ((int32_t)(bottom - top) > 0)
+    {
+        // NOTE: The entry might get overwritten as soon as top moves on, so it has to be copied out
+        // before the exchange, and is thrown away again if the exchange fails
+        *out_entry = deque->entries[top & (JOB_DEQUE_SIZE - 1)];
+        READ_BARRIER;
+        result = (AtomicCompareExchange(&deque->top, top, top + 1) == top);
+    }
+
+    return result;
+}
+
+function bool
+PushInjectionQueue(JobInjectionQueue *queue, JobEntry *entry)
+{
+    bool result = false;
+
+    BeginTicketMutex(&queue->mutex);
+    if (queue->write - queue->read < JOB_DEQUE_SIZE)
+    {
+        queue->entries[queue->write & (JOB_DEQUE_SIZE - 1)] = *entry;
+        queue->write += 1;
+        result = true;
+    }
+    EndTicketMutex(&queue->mutex);
+
+    return result;
+}
+
+function bool
+PopInjectionQueue(JobInjectionQueue *queue, JobEntry *out_entry)
+{
+    if (queue->read == queue->write)
+    {
+        return false;
+    }
+
+    bool result = false;
+
+    BeginTicketMutex(&queue->mutex);
+    if (queue->read != queue->write)
+    {
+        *out_entry = queue->entries[queue->read & (JOB_DEQUE_SIZE - 1)];
+        queue->read += 1;
+        result = true;
+    }
+    EndTicketMutex(&queue->mutex);
+
+    return result;
+}
+
+function bool
+HasQueuedJobs(JobScheduler *scheduler)
+{
+    bool result = false;
+    for (uint32_t priority = 0; priority < JobPriority_COUNT && !result; priority += 1)
+    {
+        JobInjectionQueue *injection = &scheduler->injection[priority];
+        result = (injection->read != injection->write);
+
+        for (uint32_t i = 0; i < scheduler->worker_count && !result; i += 1)
+        {
+            JobDeque *deque = &scheduler->workers[i].deques[priority];
+            result = (int32_t)(deque->bottom - deque->top) > 0;
+        }
+    }
+    return result;
+}
+
+//
+// Scheduling
+//
+
+// NOTE: Sleeping workers announce themselves in sleeper_count, and whoever queues a job claims one of
+// them by decrementing it before signalling, so every signal has exactly one worker waiting for it.
+function void
+WakeJobWorker(JobScheduler *scheduler)
+{
+    for (;;)
+    {
+        uint32_t sleepers = scheduler->sleeper_count;
+        if (!sleepers)
+        {
+            break;
+        }
+
+        if (AtomicCompareExchange(&scheduler->sleeper_count, sleepers, sleepers - 1) == sleepers)
+        {
+            SignalJobSemaphore(&scheduler->wake);
+            break;
+        }
+    }
+}
+
+function void RunJob(JobScheduler *scheduler, JobEntry *entry);
+
+function void
+SubmitJob(JobScheduler *scheduler, JobEntry *entry)
+{
+    JobPriority priority = entry->queue->priority;
+
+    JobWorker *worker = job_worker_;
+    bool queued = (worker ? PushJobDeque(&worker->deques[priority], entry)
+                          : PushInjectionQueue(&scheduler->injection[priority], entry));
+
+    if (!queued)
+    {
+        // NOTE: No room left, so the job just runs right here
+        RunJob(scheduler, entry);
+        return;
+    }
+
+    // NOTE: Pairs with the barrier in RunJobWorker, either the worker going to sleep sees our job or we see it
+    FULL_BARRIER;
+    WakeJobWorker(scheduler);
+}
+
+function void
+SubmitContinuations(JobScheduler *scheduler, PlatformJobContinuation *continuations)
+{
+    while (continuations)
+    {
+        PlatformJobContinuation *continuation = continuations;
+        continuations = continuation->next;
+
+        JobEntry entry = continuation->entry;
+
+        BeginTicketMutex(&scheduler->continuation_mutex);
+        continuation->next = scheduler->first_free_continuation;
+        scheduler->first_free_continuation = continuation;
+        EndTicketMutex(&scheduler->continuation_mutex);
+
+        SubmitJob(scheduler, &entry);
+    }
+}
+
+function void
+CountJob(PlatformJobGroup *group, JobPriority priority)
+{
+    AtomicIncrement(&group->pending);
+    if (group->priority < (uint32_t)priority)
+    {
+        group->priority = (uint32_t)priority;
+    }
+}
+
+function void
+FinishJobInGroup(JobScheduler *scheduler, PlatformJobGroup *group)
+{
+    for (;;)
+    {
+        uint32_t pending = group->pending;
+        Assert(pending > 0);
+
+        if (pending == 1)
+        {
+            // NOTE: The drop to zero happens with the mutex held, see WaitForJobGroup for why
+            PlatformJobContinuation *continuations = nullptr;
+
+            BeginTicketMutex(&group->mutex);
+            if (AtomicAdd(&group->pending, (uint32_t)-1) == 1)
+            {
+                continuations = group->continuations;
+                group->continuations = nullptr;
+            }
+            EndTicketMutex(&group->mutex);
+
+            SubmitContinuations(scheduler, continuations);
+            break;
+        }
+
+        if (AtomicCompareExchange(&group->pending, pending, pending - 1) == pending)
+        {
+            break;
+        }
+    }
+}
+
+function void
+RunJob(JobScheduler *scheduler, JobEntry *entry)
+{
+    entry->proc(entry->params);
+
+    if (entry->group)
+    {
+        FinishJobInGroup(scheduler, entry->group);
+    }
+    FinishJobInGroup(scheduler, &entry->queue->jobs);
+}
+
+function uint32_t
+NextStealVictim(JobScheduler *scheduler, JobWorker *worker)
+{
+    uint32_t result = 0;
+    if (worker)
+    {
+        uint32_t x = worker->random_state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        worker->random_state = x;
+        result = x % scheduler->worker_count;
+    }
+    return result;
+}
+
+function bool
+FindJob(JobScheduler *scheduler, JobWorker *worker, JobPriority lowest_priority, JobEntry *out_entry)
+{
+    for (uint32_t priority = 0; priority <= (uint32_t)lowest_priority; priority += 1)
+    {
+        if (worker && PopJobDeque(&worker->deques[priority], out_entry))
+        {
+            return true;
+        }
+
+        if (PopInjectionQueue(&scheduler->injection[priority], out_entry))
+        {
+            return true;
+        }
+
+        uint32_t first_victim = NextStealVictim(scheduler, worker);
+        for (uint32_t i = 0; i < scheduler->worker_count; i += 1)
+        {
+            JobWorker *victim = &scheduler->workers[(first_victim + i) % scheduler->worker_count];
+            if (victim != worker && StealJobDeque(&victim->deques[priority], out_entry))
+            {
+                if (worker) worker->jobs_stolen += 1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+function void
+RunJobWorker(JobWorker *worker)
+{
+    job_worker_ = worker;
+
+    JobScheduler *scheduler = worker->scheduler;
+
+    uint32_t idle_rounds = 0;
+    while (!scheduler->stop)
+    {
+        JobEntry entry;
+        if (FindJob(scheduler, worker, (JobPriority)(JobPriority_COUNT - 1), &entry))
+        {
+            // TODO: Double buffered temp arenas are less useful in this context, not sure what the right design is,
+            // not that important for now though.
+            ThreadLocalContext *context = platform->GetThreadLocalContext();
+            Swap(context->temp_arena, context->prev_temp_arena);
+            Clear(context->temp_arena);
+
+            RunJob(scheduler, &entry);
+            worker->jobs_run += 1;
+
+            idle_rounds = 0;
+        }
+        else if (idle_rounds < JOB_SPIN_COUNT)
+        {
+            _mm_pause();
+            idle_rounds += 1;
+        }
+        else
+        {
+            AtomicIncrement(&scheduler->sleeper_count);
+            FULL_BARRIER;
+
+            if (HasQueuedJobs(scheduler) || scheduler->stop)
+            {
+                // NOTE: Take ourselves back out of the sleepers, unless somebody already claimed us, in which
+                // case their signal is on its way and has to be eaten
+                for (;;)
+                {
+                    uint32_t sleepers = scheduler->sleeper_count;
+                    if (!sleepers)
+                    {
+                        WaitJobSemaphore(&scheduler->wake);
+                        break;
+                    }
+
+                    if (AtomicCompareExchange(&scheduler->sleeper_count, sleepers, sleepers - 1) == sleepers)
+                    {
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                WaitJobSemaphore(&scheduler->wake);
+                worker->sleeps += 1;
+            }
+
+            idle_rounds = 0;
+        }
+    }
+}
+
+function void
+InitializeJobScheduler(JobScheduler *scheduler, Arena *arena, uint32_t thread_count)
+{
+    if (thread_count > JOB_MAX_WORKERS - 1)
+    {
+        thread_count = JOB_MAX_WORKERS - 1;
+    }
+
+    scheduler->worker_count = thread_count + 1;
+    scheduler->workers      = PushArray(arena, scheduler->worker_count, JobWorker);
+
+    for (uint32_t i = 0; i < scheduler->worker_count; i += 1)
+    {
+        JobWorker *worker = &scheduler->workers[i];
+        worker->scheduler    = scheduler;
+        worker->index        = i;
+        worker->random_state = 0x9E3779B9u*(i + 1);
+    }
+
+    for (uint32_t priority = 0; priority < JobPriority_COUNT; priority += 1)
+    {
+        PlatformJobQueue *queue = &scheduler->queues[priority];
+        queue->priority      = (JobPriority)priority;
+        queue->jobs.priority = priority;
+    }
+
+    InitializeJobSemaphore(&scheduler->wake);
+    SetTag(&scheduler->continuation_arena, LOCATION_STRING("Job Continuations"));
+
+    job_scheduler_ = scheduler;
+}
+
+// NOTE: The thread running the app gets workers[0], so the jobs it adds go in its own deques without
+// taking any locks, and when it waits it gets to run them itself
+function void
+AttachJobSchedulerThread(JobScheduler *scheduler)
+{
+    job_worker_ = &scheduler->workers[0];
+}
+
+function void
+StopJobScheduler(JobScheduler *scheduler)
+{
+    scheduler->stop = true;
+    FULL_BARRIER;
+
+    for (uint32_t i = 0; i < scheduler->worker_count; i += 1)
+    {
+        SignalJobSemaphore(&scheduler->wake);
+    }
+}
+
+function void
+ReleaseJobScheduler(JobScheduler *scheduler)
+{
+    DestroyJobSemaphore(&scheduler->wake);
+    Release(&scheduler->continuation_arena);
+}
+
+function JobSchedulerStats
+GetJobSchedulerStats(JobScheduler *scheduler)
+{
+    JobSchedulerStats result = {};
+    for (uint32_t i = 0; i < scheduler->worker_count; i += 1)
+    {
+        JobWorker *worker = &scheduler->workers[i];
+        result.jobs_run    += worker->jobs_run;
+        result.jobs_stolen += worker->jobs_stolen;
+        result.jobs_helped += worker->jobs_helped;
+        result.sleeps      += worker->sleeps;
+    }
+    return result;
+}
+
+//
+// Platform API
+//
+
+static void
+Jobs_AddJobToGroup(PlatformJobQueue *queue, PlatformJobGroup *group, void *params, PlatformJobProc *proc)
+{
+    JobEntry entry = {};
+    entry.proc   = proc;
+    entry.params = params;
+    entry.queue  = queue;
+    entry.group  = group;
+
+    CountJob(&queue->jobs, queue->priority);
+    if (group)
+    {
+        CountJob(group, queue->priority);
+    }
+
+    SubmitJob(job_scheduler_, &entry);
+}
+
+static void
+Jobs_AddJobAfter(PlatformJobQueue *queue, PlatformJobGroup *after, PlatformJobGroup *group, void *params, PlatformJobProc *proc)
+{
+    JobScheduler *scheduler = job_scheduler_;
+
+    JobEntry entry = {};
+    entry.proc   = proc;
+    entry.params = params;
+    entry.queue  = queue;
+    entry.group  = group;
+
+    // NOTE: The job counts as pending right away, so waiting on its group or queue also waits for the
+    // jobs it comes after
+    CountJob(&queue->jobs, queue->priority);
+    if (group)
+    {
+        CountJob(group, queue->priority);
+    }
+
+    bool deferred = false;
+    if (after)
+    {
+        BeginTicketMutex(&after->mutex);
+        if (after->pending)
+        {
+            BeginTicketMutex(&scheduler->continuation_mutex);
+            PlatformJobContinuation *continuation = scheduler->first_free_continuation;
+            if (continuation)
+            {
+                scheduler->first_free_continuation = continuation->next;
+            }
+            else
+            {
+                continuation = PushStructNoClear(&scheduler->continuation_arena, PlatformJobContinuation);
+            }
+            EndTicketMutex(&scheduler->continuation_mutex);
+
+            continuation->entry = entry;
+            continuation->next  = after->continuations;
+            after->continuations = continuation;
+
+            deferred = true;
+        }
+        EndTicketMutex(&after->mutex);
+    }
+
+    if (!deferred)
+    {
+        SubmitJob(scheduler, &entry);
+    }
+}
+
+static void
+Jobs_WaitForJobGroup(PlatformJobGroup *group)
+{
+    JobScheduler *scheduler = job_scheduler_;
+    JobWorker *worker = job_worker_;
+
+    uint32_t idle_rounds = 0;
+    while (group->pending)
+    {
+        JobEntry entry;
+        if (FindJob(scheduler, worker, (JobPriority)group->priority, &entry))
+        {
+            // NOTE: This thread is in the middle of something, so rather than getting a freshly cleared
+            // temp arena the job gets to use whatever is left at the top of ours
+            TemporaryMemory temp = BeginTemporaryMemory(platform->GetTempArena());
+            RunJob(scheduler, &entry);
+            EndTemporaryMemory(temp);
+
+            if (worker) worker->jobs_helped += 1;
+
+            idle_rounds = 0;
+        }
+        else
+        {
+            // NOTE: Nothing left we can help with, the jobs we're waiting on are running elsewhere
+            if      (idle_rounds <    JOB_SPIN_COUNT) _mm_pause();
+            else if (idle_rounds < 16*JOB_SPIN_COUNT) platform->SleepThread(0);
+            else                                      platform->SleepThread(1);
+            idle_rounds += 1;
+        }
+    }
+
+    // NOTE: The last job in the group drops pending to zero with the mutex held, so once we get the mutex
+    // it's done touching the group and the caller is free to reuse it or let it go out of scope
+    BeginTicketMutex(&group->mutex);
+    EndTicketMutex(&group->mutex);
+}
+
+static void
+Jobs_AddJob(PlatformJobQueue *queue, void *params, PlatformJobProc *proc)
+{
+    Jobs_AddJobToGroup(queue, nullptr, params, proc);
+}
+
+static void
+Jobs_WaitForJobs(PlatformJobQueue *queue)
+{
+    Jobs_WaitForJobGroup(&queue->jobs);
+}
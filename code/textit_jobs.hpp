@@ -0,0 +1,119 @@
+#ifndef TEXTIT_JOBS_HPP
+#define TEXTIT_JOBS_HPP
+
+//
+// NOTE: The job scheduler shared by the platform layers. Every thread that runs jobs owns a deque per
+// priority, it pushes and pops at the bottom of its own deques while idle workers steal from the top of
+// everyone else's (a Chase-Lev deque). Threads that don't own deques push into a locked injection queue
+// instead. Waiting on jobs runs queued jobs until the wait is over rather than blocking, so a waiting
+// thread is never idle while there's work it could be doing.
+//
+
+#if _WIN32
+struct JobSemaphore
+{
+    HANDLE handle;
+};
+#else
+#include <semaphore.h>
+struct JobSemaphore
+{
+    sem_t sem;
+};
+#endif
+
+#define JOB_DEQUE_SIZE  1024
+#define JOB_MAX_WORKERS 32
+#define JOB_SPIN_COUNT  64 // rounds of looking for work before an idle worker goes to sleep
+
+enum JobPriority
+{
+    JobPriority_High,
+    JobPriority_Low,
+    JobPriority_COUNT,
+};
+
+struct JobEntry
+{
+    PlatformJobProc *proc;
+    void *params;
+    PlatformJobQueue *queue;
+    PlatformJobGroup *group;
+};
+
+struct JobDeque
+{
+    volatile uint32_t top; // stolen from here
+    uint8_t pad0_[60];
+    volatile uint32_t bottom; // pushed and popped here, only by the owner
+    uint8_t pad1_[60];
+    JobEntry entries[JOB_DEQUE_SIZE];
+
+    StaticAssert(IsPow2(JOB_DEQUE_SIZE), "Deque size must be a power of 2");
+};
+
+struct JobInjectionQueue
+{
+    TicketMutex mutex;
+    volatile uint32_t read;
+    volatile uint32_t write;
+    JobEntry entries[JOB_DEQUE_SIZE];
+};
+
+struct JobScheduler;
+
+struct JobWorker
+{
+    JobScheduler *scheduler;
+    uint32_t index;
+    uint32_t random_state;
+
+    JobDeque deques[JobPriority_COUNT];
+
+    // NOTE: Only written by the thread owning the worker
+    uint64_t jobs_run;
+    uint64_t jobs_stolen;
+    uint64_t jobs_helped; // run while waiting on other jobs
+    uint64_t sleeps;
+};
+
+struct PlatformJobContinuation
+{
+    PlatformJobContinuation *next;
+    JobEntry entry;
+};
+
+struct PlatformJobQueue
+{
+    JobPriority priority;
+    PlatformJobGroup jobs; // every job added to the queue that hasn't finished yet
+};
+
+struct JobSchedulerStats
+{
+    uint64_t jobs_run;
+    uint64_t jobs_stolen;
+    uint64_t jobs_helped;
+    uint64_t sleeps;
+};
+
+struct JobScheduler
+{
+    volatile uint32_t stop;
+
+    // NOTE: workers[0] belongs to the thread that runs the app, the others get a thread each
+    uint32_t worker_count;
+    JobWorker *workers;
+
+    PlatformJobQueue queues[JobPriority_COUNT];
+    JobInjectionQueue injection[JobPriority_COUNT];
+
+    volatile uint32_t sleeper_count;
+    JobSemaphore wake;
+
+    TicketMutex continuation_mutex;
+    Arena continuation_arena;
+    PlatformJobContinuation *first_free_continuation;
+};
+
+#endif /* TEXTIT_JOBS_HPP */
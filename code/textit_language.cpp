@@ -63,11 +63,11 @@ AddTokenSubKind(LanguageSpec *spec, TokenSubKind kind, StringID theme_id)
     spec->sub_token_kind_to_theme_id[kind] = theme_id;
 }
 
-function StringID
-GetThemeIDForToken(LanguageSpec *spec, Token *t)
+function ThemeColorIndex
+GetThemeIndexForToken(LanguageSpec *spec, Token *t)
 {
-    StringID result     = GetBaseTokenThemeID(t->kind);
-    StringID sub_result = spec->sub_token_kind_to_theme_id[t->sub_kind];
+    ThemeColorIndex result     = editor->theme_palette.token_kind_to_theme_index[t->kind];
+    ThemeColorIndex sub_result = spec->sub_token_kind_to_theme_index[t->sub_kind];
     if (sub_result)
     {
         result = sub_result;
@@ -83,17 +83,13 @@ AddTagSubKind(LanguageSpec *spec, TagSubKind kind, String name, StringID theme_i
     spec->sub_tag_kind_to_theme_id[kind] = theme_id;
 }
 
-function StringID
-GetThemeIDForTag(LanguageSpec *spec, Tag *tag)
+function ThemeColorIndex
+GetThemeIndexForTag(LanguageSpec *spec, Tag *tag)
 {
-    StringID result = "text_foreground"_id;
-    if (tag->kind == Tag_CommentAnnotation)
-    {
-        result = "text_comment_annotation"_id;
-    }
+    ThemeColorIndex result = editor->theme_palette.tag_kind_to_theme_index[tag->kind];
     if (tag->sub_kind)
     {
-        result = spec->sub_tag_kind_to_theme_id[tag->sub_kind];
+        result = spec->sub_tag_kind_to_theme_index[tag->sub_kind];
     }
     return result;
 }
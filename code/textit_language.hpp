@@ -53,6 +53,10 @@ struct LanguageSpec
     String      sub_tag_kind_name[256];
     KeywordSlot keyword_table[256];
 
+    // NOTE: The theme ids above resolved against the theme palette, filled in by CompileThemePalette
+    ThemeColorIndex sub_token_kind_to_theme_index[256];
+    ThemeColorIndex sub_tag_kind_to_theme_index[256];
+
     uint32_t operator_count;
     OperatorSlot operators[256];
 };
@@ -0,0 +1,191 @@
+function const char *
+GetEventTypeName(PlatformEventType type)
+{
+    static const char *names[] =
+    {
+        "None", "MouseUp", "MouseDown", "MouseMove", "KeyUp", "KeyDown", "Text", "Tick", "Redraw",
+    };
+    StaticAssert(ArrayCount(names) == PlatformEvent_COUNT, "Event type names must match PlatformEventType");
+
+    const char *result = ((uint32_t)type < PlatformEvent_COUNT ? names[type] : "Unknown");
+    return result;
+}
+
+function uint32_t
+GetLatencyBucket(double seconds)
+{
+    uint32_t result = 0;
+
+    double microseconds = 1000000.0*seconds;
+    if (microseconds > 1.0)
+    {
+        double bucket = LATENCY_BUCKETS_PER_OCTAVE*log2(microseconds);
+        result = (bucket < (double)(LATENCY_BUCKET_COUNT - 1) ? (uint32_t)bucket : LATENCY_BUCKET_COUNT - 1);
+    }
+
+    return result;
+}
+
+function void
+AddLatencySample(LatencyHistogram *histogram, double seconds)
+{
+    histogram->sample_count += 1;
+    histogram->buckets[GetLatencyBucket(seconds)] += 1;
+    if (histogram->max < seconds)
+    {
+        histogram->max = seconds;
+    }
+}
+
+// NOTE: Returns the upper bound of the bucket the percentile falls in, so it errs on the slow side
+function double
+GetLatencyPercentile(LatencyHistogram *histogram, double fraction)
+{
+    double result = 0.0;
+
+    uint64_t target = (uint64_t)ceil(fraction*(double)histogram->sample_count);
+    if (target < 1) target = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < LATENCY_BUCKET_COUNT; bucket += 1)
+    {
+        seen += histogram->buckets[bucket];
+        if (seen >= target)
+        {
+            result = pow(2.0, (double)(bucket + 1) / LATENCY_BUCKETS_PER_OCTAVE) / 1000000.0;
+            break;
+        }
+    }
+
+    if (result > histogram->max)
+    {
+        result = histogram->max;
+    }
+
+    return result;
+}
+
+// NOTE: The platform presents after AppUpdateAndRender returns, so the events of the last frame get their
+// presented samples here, and this is also where a frame that blew through its budget gets reported
+function void
+BeginLatencyFrame(void)
+{
+    PlatformHighResTime now = platform->GetTime();
+
+    if (latency->frame_valid)
+    {
+        PlatformHighResTime presented = platform->present_time;
+        if (presented.opaque < latency->frame_rendered.opaque)
+        {
+            // NOTE: The platform didn't tell us about presenting the last frame
+            presented = now;
+        }
+
+        PendingEventLatency *oldest = nullptr;
+        for (uint32_t i = 0; i < latency->pending_count; i += 1)
+        {
+            PendingEventLatency *pending = &latency->pending[i];
+
+            LatencyHistogram *histograms = latency->histograms[pending->type];
+            AddLatencySample(&histograms[LatencyStage_Handled],   platform->SecondsElapsed(pending->arrived, pending->handled));
+            AddLatencySample(&histograms[LatencyStage_Rendered],  platform->SecondsElapsed(pending->arrived, latency->frame_rendered));
+            AddLatencySample(&histograms[LatencyStage_Presented], platform->SecondsElapsed(pending->arrived, presented));
+
+            if (!oldest || pending->arrived.opaque < oldest->arrived.opaque)
+            {
+                oldest = pending;
+            }
+        }
+
+        double frame_ms = 1000.0*platform->SecondsElapsed(latency->frame_start, presented);
+        if (core_config->slow_frame_budget_ms > 0 &&
+            frame_ms > (double)core_config->slow_frame_budget_ms)
+        {
+            latency->slow_frame_count += 1;
+
+            PlatformFrameTimings *timings = &platform->frame_timings;
+
+            double render_ms  = 1000.0*platform->SecondsElapsed(latency->frame_start, latency->frame_rendered);
+            double present_ms = frame_ms - render_ms;
+            double update_ms  = render_ms - 1000.0*(timings->draw + timings->sort + timings->rasterize);
+
+            platform->LogPrint(PlatformLogLevel_Warning, "Slow frame: %.2fms (budget %dms) | update %.2fms (%u events), draw %.2fms, sort %.2fms, rasterize %.2fms, present %.2fms",
+                               frame_ms, core_config->slow_frame_budget_ms,
+                               update_ms, latency->pending_count,
+                               1000.0*timings->draw, 1000.0*timings->sort, 1000.0*timings->rasterize,
+                               present_ms);
+
+            if (oldest)
+            {
+                platform->LogPrint(PlatformLogLevel_Warning, "    oldest event: %s, %.2fms to handled, %.2fms to rendered, %.2fms to presented",
+                                   GetEventTypeName(oldest->type),
+                                   1000.0*platform->SecondsElapsed(oldest->arrived, oldest->handled),
+                                   1000.0*platform->SecondsElapsed(oldest->arrived, latency->frame_rendered),
+                                   1000.0*platform->SecondsElapsed(oldest->arrived, presented));
+            }
+        }
+    }
+
+    // NOTE: Startup and hot reloads are slow for reasons we don't care about here
+    latency->frame_valid   = platform->app_initialized && !platform->exe_reloaded;
+    latency->frame_start   = now;
+    latency->pending_count = 0;
+}
+
+function void
+RecordEventHandled(PlatformEvent *event)
+{
+    if (latency->pending_count < LATENCY_MAX_PENDING_EVENTS)
+    {
+        PendingEventLatency *pending = &latency->pending[latency->pending_count++];
+        pending->type    = event->type;
+        pending->arrived = event->timestamp;
+        pending->handled = platform->GetTime();
+    }
+}
+
+function void
+RecordFrameRendered(void)
+{
+    latency->frame_rendered = platform->GetTime();
+}
+
+function void
+LogEventLatencies(void)
+{
+    platform->LogPrint(PlatformLogLevel_Info, "Event latency in ms (p50/p95/p99/max), arrival to handled | rendered | presented, %llu slow frames:",
+                       (unsigned long long)latency->slow_frame_count);
+
+    for (uint32_t type = 0; type < PlatformEvent_COUNT; type += 1)
+    {
+        LatencyHistogram *histograms = latency->histograms[type];
+        if (!histograms[LatencyStage_Handled].sample_count)
+        {
+            continue;
+        }
+
+        StringList list = MakeStringList(platform->GetTempArena());
+        PushF(&list, "    %-9s %8llu: ", GetEventTypeName((PlatformEventType)type),
+              (unsigned long long)histograms[LatencyStage_Handled].sample_count);
+
+        for (uint32_t stage = 0; stage < LatencyStage_COUNT; stage += 1)
+        {
+            LatencyHistogram *histogram = &histograms[stage];
+            PushF(&list, "%s%.2f/%.2f/%.2f/%.2f", (stage > 0 ? " | " : ""),
+                  1000.0*GetLatencyPercentile(histogram, 0.50),
+                  1000.0*GetLatencyPercentile(histogram, 0.95),
+                  1000.0*GetLatencyPercentile(histogram, 0.99),
+                  1000.0*histogram->max);
+        }
+
+        String line = FlattenStringOnArena(&list, platform->GetTempArena());
+        platform->LogPrint(PlatformLogLevel_Info, "%.*s", StringExpand(line));
+    }
+}
+
+function void
+ResetEventLatencies(void)
+{
+    ZeroArray(PlatformEvent_COUNT, latency->histograms);
+    latency->slow_frame_count = 0;
+}
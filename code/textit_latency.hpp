@@ -0,0 +1,52 @@
+#ifndef TEXTIT_LATENCY_HPP
+#define TEXTIT_LATENCY_HPP
+
+// NOTE: Latencies are bucketed logarithmically, LATENCY_BUCKETS_PER_OCTAVE buckets for every doubling of
+// the number of microseconds, which keeps percentiles within about 10% of the real value
+#define LATENCY_BUCKETS_PER_OCTAVE 8
+#define LATENCY_BUCKET_COUNT       256
+#define LATENCY_MAX_PENDING_EVENTS 256
+
+enum LatencyStage
+{
+    LatencyStage_Handled,   // arrival -> HandleViewEvent returned
+    LatencyStage_Rendered,  // arrival -> EndRender returned
+    LatencyStage_Presented, // arrival -> the platform presented the frame
+    LatencyStage_COUNT,
+};
+
+struct LatencyHistogram
+{
+    uint64_t sample_count;
+    double max;
+    uint32_t buckets[LATENCY_BUCKET_COUNT];
+};
+
+struct PendingEventLatency
+{
+    PlatformEventType type;
+    PlatformHighResTime arrived;
+    PlatformHighResTime handled;
+};
+
+struct LatencyTracker
+{
+    LatencyHistogram histograms[PlatformEvent_COUNT][LatencyStage_COUNT];
+
+    // NOTE: Events handled this frame, they only get their histogram samples once the frame has been
+    // presented, which we find out about at the start of the next frame
+    uint32_t pending_count;
+    PendingEventLatency pending[LATENCY_MAX_PENDING_EVENTS];
+
+    bool frame_valid;
+    PlatformHighResTime frame_start;
+    PlatformHighResTime frame_rendered;
+
+    uint64_t slow_frame_count;
+};
+GLOBAL_STATE(LatencyTracker, latency);
+
+function void LogEventLatencies(void);
+function void ResetEventLatencies(void);
+
+#endif /* TEXTIT_LATENCY_HPP */
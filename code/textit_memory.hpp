@@ -57,6 +57,12 @@ Slice<T> MakeSlice(size_t count, T *data)
 #define DEFAULT_ARENA_ALIGN    16
 #define DEFAULT_ARENA_CAPACITY Gigabytes(8)
 
+// NOTE: An arena only decommits once ARENA_DECOMMIT_DELAY resets in a row have left more than
+//       ARENA_DECOMMIT_THRESHOLD of its committed memory untouched, so arenas that fill up the same
+//       way every frame (like the temp arenas) don't commit and decommit every frame.
+#define ARENA_DECOMMIT_THRESHOLD Kilobytes(256)
+#define ARENA_DECOMMIT_DELAY     64
+
 function size_t
 GetAlignOffset(Arena *arena, size_t align)
 {
@@ -84,12 +90,65 @@ GetSizeRemaining(Arena *arena, size_t align)
     return result;
 }
 
+// NOTE: Arenas report their usage to the platform through the stats of the memory they reserved,
+//       which is what makes them show up in the memory overlay.
+function void
+UpdateMemoryStats(Arena *arena)
+{
+    if (arena->stats)
+    {
+        arena->stats->committed = arena->committed;
+        arena->stats->used      = arena->used;
+    }
+}
+
+function void
+TrimArena(Arena *arena, size_t used_before_reset)
+{
+    // NOTE: Memory handed over by InitWithMemory or PushSubArena isn't ours to decommit
+    if (!arena->stats)
+    {
+        return;
+    }
+
+    if (arena->recent_peak < used_before_reset)
+    {
+        arena->recent_peak = used_before_reset;
+    }
+
+    size_t keep = AlignPow2(arena->recent_peak, platform->page_size);
+    if (arena->committed >= keep + ARENA_DECOMMIT_THRESHOLD)
+    {
+        arena->idle_resets += 1;
+        if (arena->idle_resets >= ARENA_DECOMMIT_DELAY)
+        {
+            size_t decommit_size = arena->committed - keep;
+            platform->DecommitMemory(arena->base + keep, decommit_size);
+
+            arena->committed = keep;
+            arena->stats->decommit_count += 1;
+            arena->stats->decommitted    += decommit_size;
+
+            arena->idle_resets = 0;
+            arena->recent_peak = arena->used;
+        }
+    }
+    else
+    {
+        arena->idle_resets = 0;
+        arena->recent_peak = arena->used;
+    }
+}
+
 function void
 Clear(Arena *arena)
 {
     Assert(arena->temp_count == 0);
+    size_t used_before_reset = arena->used;
     arena->used = 0;
     arena->temp_count = 0;
+    TrimArena(arena, used_before_reset);
+    UpdateMemoryStats(arena);
 }
 
 function void
@@ -110,7 +169,10 @@ function void
 ResetTo(Arena *arena, char *target)
 {
     Assert((target >= arena->base) && (target <= (arena->base + arena->used)));
+    size_t used_before_reset = arena->used;
     arena->used = (target - arena->base);
+    TrimArena(arena, used_before_reset);
+    UpdateMemoryStats(arena);
 }
 
 function void
@@ -121,6 +183,14 @@ SetCapacity(Arena *arena, size_t capacity)
     arena->capacity = capacity;
 }
 
+// NOTE: Names the arena in the memory stats, instead of the location of whatever happened to push onto it first
+function void
+SetTag(Arena *arena, const char *tag)
+{
+    Assert(!arena->base);
+    arena->tag = tag;
+}
+
 function void
 InitWithMemory(Arena *arena, size_t memory_size, void *memory)
 {
@@ -190,7 +260,8 @@ PushSize_(Arena *arena, size_t size, size_t align, bool clear, const char *tag)
         // NOTE: Let's align up to page size because that's the minimum allocation granularity anyway,
         //       and the code doing the commit down below assumes our capacity is page aligned.
         arena->capacity = AlignPow2(arena->capacity, platform->page_size);
-        arena->base = (char *)platform->ReserveMemory(arena->capacity, PlatformMemFlag_NoLeakCheck, tag);
+        arena->base = (char *)platform->ReserveMemory(arena->capacity, PlatformMemFlag_NoLeakCheck, (arena->tag ? arena->tag : tag));
+        arena->stats = (arena->base ? platform->GetMemoryStats(arena->base) : nullptr);
     }
 
     size_t align_offset = GetAlignOffset(arena, align);
@@ -210,6 +281,7 @@ PushSize_(Arena *arena, size_t size, size_t align, bool clear, const char *tag)
 
     void *result = unaligned_base + align_offset;
     arena->used += aligned_size;
+    UpdateMemoryStats(arena);
 
     if (clear) {
         ZeroSize(size, result);
@@ -304,6 +376,7 @@ EndTemporaryMemory(TemporaryMemory temp)
     {
         Assert(temp.used <= temp.arena->used);
         temp.arena->used = temp.used;
+        UpdateMemoryStats(temp.arena);
         Assert(temp.arena->temp_count > 0);
         --temp.arena->temp_count;
     }
@@ -340,6 +413,9 @@ struct VirtualArray
     unsigned committed;
     T *data;
 
+    unsigned recent_peak; // NOTE: same decommit hysteresis as arenas, see TrimArena
+    unsigned idle_resets;
+
     T &
     operator [] (size_t index)
     {
@@ -356,17 +432,63 @@ struct VirtualArray
     void
     Clear()
     {
-        // TODO: Decommit behaviour
+        unsigned count_before_reset = count;
         count = 0;
+
+        if (!data)
+        {
+            return;
+        }
+
+        PlatformMemoryStats *stats = platform->GetMemoryStats(data);
+
+        if (recent_peak < count_before_reset)
+        {
+            recent_peak = count_before_reset;
+        }
+
+        size_t keep           = AlignPow2(sizeof(T)*recent_peak, platform->page_size);
+        size_t committed_size = sizeof(T)*committed;
+        if (committed_size >= keep + ARENA_DECOMMIT_THRESHOLD)
+        {
+            idle_resets += 1;
+            if (idle_resets >= ARENA_DECOMMIT_DELAY)
+            {
+                // NOTE: EnsureSpace commits whole pages starting from wherever the last commit ended, which
+                // can run up to one element past what committed says
+                size_t reserved      = AlignPow2(sizeof(T)*capacity, platform->allocation_granularity);
+                size_t committed_end = AlignPow2(committed_size + sizeof(T), platform->page_size);
+                if (committed_end > reserved) committed_end = reserved;
+                size_t decommit_size = committed_end - keep;
+                platform->DecommitMemory((char *)data + keep, decommit_size);
+
+                committed = (unsigned)(keep / sizeof(T));
+                stats->committed       = sizeof(T)*committed;
+                stats->decommit_count += 1;
+                stats->decommitted    += decommit_size;
+
+                idle_resets = 0;
+                recent_peak = 0;
+            }
+        }
+        else
+        {
+            idle_resets = 0;
+            recent_peak = 0;
+        }
+
+        stats->used = 0;
     }
 
     void
     Release()
     {
         platform->DeallocateMemory(data);
-        count     = 0;
-        committed = 0;
-        data      = nullptr;
+        count       = 0;
+        committed   = 0;
+        data        = nullptr;
+        recent_peak = 0;
+        idle_resets = 0;
     }
 
     bool
@@ -414,6 +536,10 @@ struct VirtualArray
             Assert(result);
         }
 
+        PlatformMemoryStats *stats = platform->GetMemoryStats(data);
+        stats->committed = sizeof(T)*committed;
+        stats->used      = sizeof(T)*new_count;
+
         return diff;
     }
 
@@ -439,6 +565,549 @@ struct VirtualArray
     }
 };
 
+//
+// Size class heap
+//
+
+// NOTE: A general purpose allocator for the many small, short lived allocations that used to go to the
+// OS heap. Requests up to SIZE_CLASS_MAX_SIZE are rounded up to a size class, 16 byte steps up to 64
+// bytes and then four classes per power of two like the second level of TLSF, so past 64 bytes a block
+// is never more than 20% bigger than what was asked for. Every class
+// carves its blocks out of spans committed from one big reservation, and because spans are aligned to
+// their size the span header can tell HeapFree what class a block is, which makes alloc and free
+// a free list pop and push. Each thread keeps a small cache of free blocks per class, so the heap's
+// mutex only gets touched once per SIZE_CLASS_CACHE_BATCH blocks. Anything bigger goes straight
+// to AllocateMemory.
+#define SIZE_CLASS_MIN_SIZE      16
+#define SIZE_CLASS_MAX_SIZE      Kilobytes(16)
+#define SIZE_CLASS_COUNT         36
+#define SIZE_CLASS_SPAN_SIZE     Kilobytes(64)
+#define SIZE_CLASS_HEAP_CAPACITY Gigabytes(4)
+#define SIZE_CLASS_MAX_THREADS   32
+#define SIZE_CLASS_CACHE_BATCH   16
+#define SIZE_CLASS_CACHE_LIMIT   64
+
+struct SizeClassBlock
+{
+    SizeClassBlock *next;
+};
+
+struct SizeClassSpan
+{
+    uint32_t size_class;
+    uint32_t block_count;
+    SizeClassSpan *next;
+};
+
+struct SizeClassLargeBlock
+{
+    SizeClassLargeBlock *next;
+    SizeClassLargeBlock *prev;
+    size_t size;
+    size_t pad_;
+};
+
+// NOTE: Only ever touched by the thread owning the slot. blocks_in_use goes negative on threads that
+// free more blocks than they allocated, it only makes sense summed over all the caches.
+struct alignas(64) SizeClassCache
+{
+    uint32_t count[SIZE_CLASS_COUNT];
+    SizeClassBlock *free[SIZE_CLASS_COUNT];
+    int64_t blocks_in_use[SIZE_CLASS_COUNT];
+};
+
+struct SizeClassHeap
+{
+    const char *tag;
+    PlatformMemoryStats *stats;
+
+    char *spans_base;
+    size_t span_capacity;
+    size_t span_count;
+
+    TicketMutex mutex;
+
+    // NOTE: Everything below is protected by the mutex
+    SizeClassBlock *free[SIZE_CLASS_COUNT];
+    uint32_t free_count[SIZE_CLASS_COUNT];
+    uint32_t span_count_per_class[SIZE_CLASS_COUNT];
+    int64_t uncached_blocks_in_use[SIZE_CLASS_COUNT];
+    SizeClassLargeBlock large_sentinel;
+    size_t large_count;
+    size_t large_size;
+
+    SizeClassCache caches[SIZE_CLASS_MAX_THREADS];
+};
+
+struct SizeClassHeapStats
+{
+    size_t committed;   // header plus spans, large allocations not included
+    size_t in_use;      // bytes in blocks handed out
+    size_t cached;      // free blocks held in thread caches
+    size_t free;        // free blocks held by the heap itself
+    size_t span_waste;  // the tails of spans too small to fit another block
+    size_t large_count;
+    size_t large_size;
+    size_t span_count;
+
+    // NOTE: Fraction of the committed span memory that isn't handed out
+    float fragmentation;
+
+    uint32_t blocks_in_use[SIZE_CLASS_COUNT];
+    uint32_t blocks_free[SIZE_CLASS_COUNT];
+};
+
+function uint32_t
+GetSizeClass(size_t size)
+{
+    uint32_t result = 0;
+    if (size > 4*SIZE_CLASS_MIN_SIZE)
+    {
+        size_t last_byte  = size - 1;
+        uint32_t top_bit  = FindMostSignificantSetBit(last_byte).index;
+        uint32_t sub_step = (uint32_t)(last_byte >> (top_bit - 2)) & 3;
+        result = 4 + 4*(top_bit - 6) + sub_step;
+    }
+    else if (size > 0)
+    {
+        result = (uint32_t)((size - 1) / SIZE_CLASS_MIN_SIZE);
+    }
+    return result;
+}
+
+function size_t
+GetSizeClassBlockSize(uint32_t size_class)
+{
+    size_t result = SIZE_CLASS_MIN_SIZE*(size_class + 1);
+    if (size_class >= 4)
+    {
+        uint32_t top_bit  = 6 + (size_class - 4) / 4;
+        uint32_t sub_step = (size_class - 4) % 4;
+        result = (size_t)(5 + sub_step) << (top_bit - 2);
+    }
+    return result;
+}
+
+// NOTE: Threads get their slot the first time they touch any size class heap, and keep it for every
+// heap. Threads past SIZE_CLASS_MAX_THREADS go without a cache and take the mutex every time.
+static thread_local uint32_t size_class_thread_slot_;
+static volatile uint32_t size_class_thread_count_;
+
+function SizeClassCache *
+GetSizeClassCache(SizeClassHeap *heap)
+{
+    uint32_t slot = size_class_thread_slot_;
+    if (!slot)
+    {
+        slot = AtomicIncrement(&size_class_thread_count_) + 1;
+        size_class_thread_slot_ = slot;
+    }
+
+    SizeClassCache *result = (slot <= SIZE_CLASS_MAX_THREADS ? &heap->caches[slot - 1] : nullptr);
+    return result;
+}
+
+function SizeClassHeap *
+CreateSizeClassHeap(const char *tag)
+{
+    size_t header_size  = AlignPow2(sizeof(SizeClassHeap), platform->page_size);
+    size_t reserve_size = AlignPow2(header_size, SIZE_CLASS_SPAN_SIZE) + SIZE_CLASS_HEAP_CAPACITY + SIZE_CLASS_SPAN_SIZE;
+
+    char *base = (char *)platform->ReserveMemory(reserve_size, PlatformMemFlag_NoLeakCheck, tag);
+    if (!base)
+    {
+        return nullptr;
+    }
+
+    platform->CommitMemory(base, header_size);
+
+    SizeClassHeap *result = (SizeClassHeap *)base;
+    result->tag           = tag;
+    result->stats         = platform->GetMemoryStats(base);
+    result->spans_base    = (char *)AlignPow2((uintptr_t)base + header_size, (uintptr_t)SIZE_CLASS_SPAN_SIZE);
+    result->span_capacity = SIZE_CLASS_HEAP_CAPACITY / SIZE_CLASS_SPAN_SIZE;
+    DllInit(&result->large_sentinel);
+
+    result->stats->committed = header_size;
+    result->stats->used      = sizeof(SizeClassHeap);
+
+    return result;
+}
+
+function void
+DestroySizeClassHeap(SizeClassHeap *heap)
+{
+    if (!heap)
+    {
+        return;
+    }
+
+    for (SizeClassLargeBlock *large = heap->large_sentinel.next; large != &heap->large_sentinel;)
+    {
+        SizeClassLargeBlock *next = large->next;
+        platform->DeallocateMemory(large);
+        large = next;
+    }
+
+    platform->DeallocateMemory(heap);
+}
+
+function bool
+IsInSpans(SizeClassHeap *heap, void *data)
+{
+    char *at = (char *)data;
+    bool result = (at >= heap->spans_base &&
+                   at <  heap->spans_base + heap->span_count*SIZE_CLASS_SPAN_SIZE);
+    return result;
+}
+
+function SizeClassSpan *
+GetSizeClassSpan(void *data)
+{
+    SizeClassSpan *result = (SizeClassSpan *)((uintptr_t)data & ~((uintptr_t)SIZE_CLASS_SPAN_SIZE - 1));
+    return result;
+}
+
+function void
+UpdateMemoryStats(SizeClassHeap *heap)
+{
+    size_t header_size = AlignPow2(sizeof(SizeClassHeap), platform->page_size);
+    size_t committed   = header_size + heap->span_count*SIZE_CLASS_SPAN_SIZE;
+
+    size_t free_size = 0;
+    for (uint32_t size_class = 0; size_class < SIZE_CLASS_COUNT; size_class += 1)
+    {
+        free_size += heap->free_count[size_class]*GetSizeClassBlockSize(size_class);
+    }
+
+    // NOTE: Blocks sitting in thread caches count as used here, GetSizeClassHeapStats tells them apart
+    heap->stats->committed = committed;
+    heap->stats->used      = committed - free_size;
+}
+
+// NOTE: Must be called with the mutex held. Returns false when the reservation is used up.
+function bool
+AddSizeClassSpan(SizeClassHeap *heap, uint32_t size_class)
+{
+    if (heap->span_count >= heap->span_capacity)
+    {
+        return false;
+    }
+
+    SizeClassSpan *span = (SizeClassSpan *)(heap->spans_base + heap->span_count*SIZE_CLASS_SPAN_SIZE);
+    platform->CommitMemory(span, SIZE_CLASS_SPAN_SIZE);
+    heap->span_count += 1;
+
+    size_t block_size  = GetSizeClassBlockSize(size_class);
+    size_t first_block = AlignPow2(sizeof(SizeClassSpan), (size_t)SIZE_CLASS_MIN_SIZE);
+
+    span->size_class  = size_class;
+    span->block_count = (uint32_t)((SIZE_CLASS_SPAN_SIZE - first_block) / block_size);
+
+    // NOTE: Pushed back to front so blocks get handed out in address order
+    for (uint32_t i = span->block_count; i > 0; i -= 1)
+    {
+        SizeClassBlock *block = (SizeClassBlock *)((char *)span + first_block + (i - 1)*block_size);
+        block->next = heap->free[size_class];
+        heap->free[size_class] = block;
+    }
+    heap->free_count[size_class]           += span->block_count;
+    heap->span_count_per_class[size_class] += 1;
+
+    return true;
+}
+
+// NOTE: Must be called with the mutex held
+function SizeClassBlock *
+PopSizeClassBlocks(SizeClassHeap *heap, uint32_t size_class, uint32_t max_count, uint32_t *out_count)
+{
+    if (!heap->free[size_class])
+    {
+        AddSizeClassSpan(heap, size_class);
+    }
+
+    SizeClassBlock *result = heap->free[size_class];
+    SizeClassBlock *last   = nullptr;
+
+    uint32_t count = 0;
+    for (SizeClassBlock *block = result; block && count < max_count; block = block->next)
+    {
+        last   = block;
+        count += 1;
+    }
+
+    if (last)
+    {
+        heap->free[size_class] = last->next;
+        last->next = nullptr;
+    }
+    heap->free_count[size_class] -= count;
+
+    *out_count = count;
+    return result;
+}
+
+// NOTE: Must be called with the mutex held
+function void
+PushSizeClassBlocks(SizeClassHeap *heap, uint32_t size_class, SizeClassBlock *first, SizeClassBlock *last, uint32_t count)
+{
+    last->next = heap->free[size_class];
+    heap->free[size_class] = first;
+    heap->free_count[size_class] += count;
+}
+
+function void *
+SizeClassAllocLarge(SizeClassHeap *heap, size_t size)
+{
+    SizeClassLargeBlock *large = (SizeClassLargeBlock *)platform->AllocateMemory(sizeof(SizeClassLargeBlock) + size, PlatformMemFlag_NoLeakCheck, heap->tag);
+    if (!large)
+    {
+        return nullptr;
+    }
+
+    large->size = size;
+
+    BeginTicketMutex(&heap->mutex);
+    DllInsertBack(&heap->large_sentinel, large);
+    heap->large_count += 1;
+    heap->large_size  += size;
+    EndTicketMutex(&heap->mutex);
+
+    void *result = large + 1;
+    return result;
+}
+
+function void
+SizeClassFreeLarge(SizeClassHeap *heap, void *data)
+{
+    SizeClassLargeBlock *large = (SizeClassLargeBlock *)data - 1;
+
+    BeginTicketMutex(&heap->mutex);
+    DllRemove(large);
+    heap->large_count -= 1;
+    heap->large_size  -= large->size;
+    EndTicketMutex(&heap->mutex);
+
+    platform->DeallocateMemory(large);
+}
+
+function void *
+SizeClassAlloc(SizeClassHeap *heap, size_t size)
+{
+    if (size > SIZE_CLASS_MAX_SIZE)
+    {
+        return SizeClassAllocLarge(heap, size);
+    }
+
+    uint32_t size_class = GetSizeClass(size);
+
+    SizeClassBlock *block = nullptr;
+    if (SizeClassCache *cache = GetSizeClassCache(heap))
+    {
+        if (!cache->free[size_class])
+        {
+            uint32_t count = 0;
+
+            BeginTicketMutex(&heap->mutex);
+            cache->free[size_class] = PopSizeClassBlocks(heap, size_class, SIZE_CLASS_CACHE_BATCH, &count);
+            UpdateMemoryStats(heap);
+            EndTicketMutex(&heap->mutex);
+
+            cache->count[size_class] = count;
+        }
+
+        block = cache->free[size_class];
+        if (block)
+        {
+            cache->free[size_class] = block->next;
+            cache->count[size_class] -= 1;
+            cache->blocks_in_use[size_class] += 1;
+        }
+    }
+    else
+    {
+        uint32_t count = 0;
+
+        BeginTicketMutex(&heap->mutex);
+        block = PopSizeClassBlocks(heap, size_class, 1, &count);
+        heap->uncached_blocks_in_use[size_class] += count;
+        UpdateMemoryStats(heap);
+        EndTicketMutex(&heap->mutex);
+    }
+
+    if (!block)
+    {
+        // NOTE: Out of spans, which should really never happen, but large allocations still work
+        return SizeClassAllocLarge(heap, size);
+    }
+
+    return block;
+}
+
+function void
+SizeClassFree(SizeClassHeap *heap, void *data)
+{
+    if (!data)
+    {
+        return;
+    }
+
+    if (!IsInSpans(heap, data))
+    {
+        SizeClassFreeLarge(heap, data);
+        return;
+    }
+
+    uint32_t size_class = GetSizeClassSpan(data)->size_class;
+
+    SizeClassBlock *block = (SizeClassBlock *)data;
+    if (SizeClassCache *cache = GetSizeClassCache(heap))
+    {
+        block->next = cache->free[size_class];
+        cache->free[size_class] = block;
+        cache->count[size_class] += 1;
+        cache->blocks_in_use[size_class] -= 1;
+
+        if (cache->count[size_class] > SIZE_CLASS_CACHE_LIMIT)
+        {
+            // NOTE: Hand a batch back so a thread that frees what others allocated doesn't hoard memory
+            SizeClassBlock *first = cache->free[size_class];
+            SizeClassBlock *last  = first;
+            for (uint32_t i = 1; i < SIZE_CLASS_CACHE_BATCH; i += 1)
+            {
+                last = last->next;
+            }
+            cache->free[size_class] = last->next;
+            cache->count[size_class] -= SIZE_CLASS_CACHE_BATCH;
+
+            BeginTicketMutex(&heap->mutex);
+            PushSizeClassBlocks(heap, size_class, first, last, SIZE_CLASS_CACHE_BATCH);
+            UpdateMemoryStats(heap);
+            EndTicketMutex(&heap->mutex);
+        }
+    }
+    else
+    {
+        BeginTicketMutex(&heap->mutex);
+        PushSizeClassBlocks(heap, size_class, block, block, 1);
+        heap->uncached_blocks_in_use[size_class] -= 1;
+        UpdateMemoryStats(heap);
+        EndTicketMutex(&heap->mutex);
+    }
+}
+
+function size_t
+SizeClassGetAllocSize(SizeClassHeap *heap, void *data)
+{
+    size_t result = 0;
+    if (data)
+    {
+        if (IsInSpans(heap, data))
+        {
+            result = GetSizeClassBlockSize(GetSizeClassSpan(data)->size_class);
+        }
+        else
+        {
+            result = ((SizeClassLargeBlock *)data - 1)->size;
+        }
+    }
+    return result;
+}
+
+function void *
+SizeClassReAlloc(SizeClassHeap *heap, void *data, size_t size)
+{
+    if (!data)
+    {
+        return SizeClassAlloc(heap, size);
+    }
+
+    if (size == 0)
+    {
+        SizeClassFree(heap, data);
+        return nullptr;
+    }
+
+    // NOTE: Blocks are kept if the new size still fits and wouldn't land in a smaller size class
+    size_t old_size = SizeClassGetAllocSize(heap, data);
+    if (size <= old_size)
+    {
+        bool keep = (IsInSpans(heap, data) ? GetSizeClass(size) == GetSizeClassSpan(data)->size_class
+                                            : size > SIZE_CLASS_MAX_SIZE);
+        if (keep)
+        {
+            return data;
+        }
+    }
+
+    void *result = SizeClassAlloc(heap, size);
+    if (result)
+    {
+        CopySize((old_size < size ? old_size : size), data, result);
+        SizeClassFree(heap, data);
+    }
+    return result;
+}
+
+// NOTE: Reads the thread caches without synchronizing with their threads, so with other threads
+// allocating at the same time the numbers are only approximately right
+function SizeClassHeapStats
+GetSizeClassHeapStats(SizeClassHeap *heap)
+{
+    SizeClassHeapStats result = {};
+
+    BeginTicketMutex(&heap->mutex);
+
+    size_t first_block = AlignPow2(sizeof(SizeClassSpan), (size_t)SIZE_CLASS_MIN_SIZE);
+    for (uint32_t size_class = 0; size_class < SIZE_CLASS_COUNT; size_class += 1)
+    {
+        size_t block_size = GetSizeClassBlockSize(size_class);
+
+        int64_t in_use = heap->uncached_blocks_in_use[size_class];
+        uint32_t cached = 0;
+        for (uint32_t i = 0; i < SIZE_CLASS_MAX_THREADS; i += 1)
+        {
+            in_use += heap->caches[i].blocks_in_use[size_class];
+            cached += heap->caches[i].count[size_class];
+        }
+
+        result.blocks_in_use[size_class] = (uint32_t)in_use;
+        result.blocks_free[size_class]   = cached + heap->free_count[size_class];
+
+        result.in_use     += (size_t)in_use*block_size;
+        result.cached     += cached*block_size;
+        result.free       += heap->free_count[size_class]*block_size;
+        result.span_waste += heap->span_count_per_class[size_class]*((SIZE_CLASS_SPAN_SIZE - first_block) % block_size + first_block);
+    }
+
+    result.span_count  = heap->span_count;
+    result.committed   = AlignPow2(sizeof(SizeClassHeap), platform->page_size) + heap->span_count*SIZE_CLASS_SPAN_SIZE;
+    result.large_count = heap->large_count;
+    result.large_size  = heap->large_size;
+
+    EndTicketMutex(&heap->mutex);
+
+    size_t span_bytes = heap->span_count*SIZE_CLASS_SPAN_SIZE;
+    result.fragmentation = (span_bytes ? 1.0f - (float)result.in_use / (float)span_bytes : 0.0f);
+
+    return result;
+}
+
+function
+ALLOCATOR_REALLOC(SizeClassHeapReAlloc)
+{
+    return SizeClassReAlloc((SizeClassHeap *)udata, data, size);
+}
+
+function Allocator
+MakeAllocator(SizeClassHeap *heap)
+{
+    Allocator result = {};
+    result.realloc = SizeClassHeapReAlloc;
+    result.udata   = heap;
+    return result;
+}
+
 template <typename T>
 struct Array
 {
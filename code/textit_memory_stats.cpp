@@ -0,0 +1,298 @@
+function const char *
+GetMemorySubsystemName(MemorySubsystem subsystem)
+{
+    static const char *names[] =
+    {
+        "text", "line index", "tokens", "tags", "undo", "buffers", "render", "command line", "other",
+    };
+    StaticAssert(ArrayCount(names) == MemorySubsystem_COUNT, "Subsystem names must match MemorySubsystem");
+
+    const char *result = names[subsystem];
+    return result;
+}
+
+// NOTE: Matched against the tags handed to ReserveMemory / CreateHeap. Buffer arenas hold line index nodes,
+// token blocks, tags and undo history all mixed together, those get split out separately by walking the
+// buffers in GatherMemoryReport.
+static const struct
+{
+    String pattern;
+    MemorySubsystem subsystem;
+} memory_subsystem_patterns[] =
+{
+    { "(text storage)"_str,           MemorySubsystem_Text        },
+    { "Bootstrap Buffer::arena"_str,  MemorySubsystem_Buffers     },
+    { "(Buffer Heap)"_str,            MemorySubsystem_Buffers     },
+    { "textit_tags.cpp"_str,          MemorySubsystem_Tags        },
+    { "(Tag Index Heap)"_str,         MemorySubsystem_Tags        },
+    { "(Undo Scratch)"_str,           MemorySubsystem_Undo        },
+    { "textit_render.cpp"_str,        MemorySubsystem_Render      },
+    { "textit_glyph_cache.cpp"_str,   MemorySubsystem_Render      },
+    { "(Offscreen Buffer)"_str,       MemorySubsystem_Render      },
+    { "(Command Line Arena)"_str,     MemorySubsystem_CommandLine },
+    { "textit_command_line.cpp"_str,  MemorySubsystem_CommandLine },
+};
+
+function MemorySubsystem
+GetMemorySubsystem(String tag)
+{
+    MemorySubsystem result = MemorySubsystem_Other;
+    for (size_t i = 0; i < ArrayCount(memory_subsystem_patterns); i += 1)
+    {
+        String pattern = memory_subsystem_patterns[i].pattern;
+        if (FindSubstring(tag, pattern) < tag.size)
+        {
+            result = memory_subsystem_patterns[i].subsystem;
+            break;
+        }
+    }
+    return result;
+}
+
+function void
+AddMemoryTotals(MemoryTotals *totals, PlatformMemoryStats *stat)
+{
+    totals->count          += 1;
+    totals->reserved       += stat->reserved;
+    totals->committed      += stat->committed;
+    totals->used           += stat->used;
+    totals->decommit_count += stat->decommit_count;
+    totals->decommitted    += stat->decommitted;
+}
+
+function size_t
+CountUndoBytes(Buffer *buffer)
+{
+    size_t result = 0;
+
+    // NOTE: The undo history can be one very long chain, so it's walked without recursion
+    UndoNode *root = &buffer->undo.root;
+    UndoNode *node = root;
+    for (;;)
+    {
+        if (node != root)
+        {
+            result += sizeof(*node) + node->forward.size + node->backward.size;
+        }
+
+        if (node->first_child)
+        {
+            node = node->first_child;
+            continue;
+        }
+
+        while (node != root && !node->next_child)
+        {
+            node = node->parent;
+        }
+
+        if (node == root)
+        {
+            break;
+        }
+
+        node = node->next_child;
+    }
+
+    return result;
+}
+
+function MemoryReport
+GatherMemoryReport(Arena *arena)
+{
+    MemoryReport result = {};
+
+    size_t stats_count = platform->GatherMemoryStats(0, nullptr);
+    PlatformMemoryStats *stats = PushArrayNoClear(arena, stats_count, PlatformMemoryStats);
+    stats_count = Min(stats_count, platform->GatherMemoryStats(stats_count, stats));
+
+    // NOTE: Tags repeat for every buffer, view, thread, etc. so they get merged
+    MemoryTagTotals *tags = PushArray(arena, stats_count, MemoryTagTotals);
+    size_t tag_count = 0;
+
+    for (size_t i = 0; i < stats_count; i += 1)
+    {
+        PlatformMemoryStats *stat = &stats[i];
+        String tag = MakeString(strlen(stat->tag), (uint8_t *)stat->tag);
+
+        MemoryTagTotals *tag_totals = nullptr;
+        for (size_t j = 0; j < tag_count; j += 1)
+        {
+            if (AreEqual(tags[j].tag, tag))
+            {
+                tag_totals = &tags[j];
+                break;
+            }
+        }
+
+        if (!tag_totals)
+        {
+            tag_totals = &tags[tag_count++];
+            tag_totals->tag       = PushString(arena, tag);
+            tag_totals->subsystem = GetMemorySubsystem(tag);
+        }
+
+        AddMemoryTotals(&tag_totals->totals, stat);
+        AddMemoryTotals(&result.subsystems[tag_totals->subsystem], stat);
+        AddMemoryTotals(&result.total, stat);
+    }
+
+    Sort(tag_count, tags, +[](const MemoryTagTotals &a, const MemoryTagTotals &b) {
+        return a.totals.committed > b.totals.committed;
+    });
+    result.tags = MakeSlice(tag_count, tags);
+
+    // NOTE: These only have a used count, the memory they sit in is reserved and committed by the buffer arenas
+    MemoryTotals *buffers = &result.subsystems[MemorySubsystem_Buffers];
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        Buffer *buffer = it.buffer;
+
+        // NOTE: The line index and tags of buffers that are still loading belong to the jobs loading them
+        if (!IsBufferLoaded(buffer)) continue;
+
+        LineIndexCountResult index_stats = {};
+        CountLineIndex(buffer->line_index_root, &index_stats);
+
+        size_t tag_bytes = 0;
+        for (Tag *tag = buffer->tags->sentinel.next; tag != &buffer->tags->sentinel; tag = tag->next)
+        {
+            tag_bytes += sizeof(*tag);
+        }
+
+        size_t undo_bytes = CountUndoBytes(buffer);
+
+        result.subsystems[MemorySubsystem_LineIndex].used += index_stats.nodes_size;
+        result.subsystems[MemorySubsystem_Tokens].used    += index_stats.token_blocks_size;
+        result.subsystems[MemorySubsystem_Tags].used      += tag_bytes;
+        result.subsystems[MemorySubsystem_Undo].used      += undo_bytes;
+
+        size_t split_out = index_stats.nodes_size + index_stats.token_blocks_size + tag_bytes + undo_bytes;
+        buffers->used -= Min(buffers->used, split_out);
+    }
+
+    return result;
+}
+
+function void
+AddSizeClassHeapStats(SizeClassHeapStats *totals, SizeClassHeap *heap)
+{
+    if (!heap)
+    {
+        return;
+    }
+
+    SizeClassHeapStats stats = GetSizeClassHeapStats(heap);
+    totals->committed   += stats.committed;
+    totals->in_use      += stats.in_use;
+    totals->cached      += stats.cached;
+    totals->free        += stats.free;
+    totals->span_waste  += stats.span_waste;
+    totals->large_count += stats.large_count;
+    totals->large_size  += stats.large_size;
+    totals->span_count  += stats.span_count;
+
+    for (uint32_t size_class = 0; size_class < SIZE_CLASS_COUNT; size_class += 1)
+    {
+        totals->blocks_in_use[size_class] += stats.blocks_in_use[size_class];
+        totals->blocks_free[size_class]   += stats.blocks_free[size_class];
+    }
+}
+
+function String
+FormatMemoryTotals(const char *name, MemoryTotals *totals)
+{
+    String result = PushTempStringF("%-13s %9s %9s %9s %9s",
+                                    name,
+                                    (totals->reserved    ? (char *)FormatHumanReadableBytes(totals->reserved).data    : "-"),
+                                    (totals->committed   ? (char *)FormatHumanReadableBytes(totals->committed).data   : "-"),
+                                    (char *)FormatHumanReadableBytes(totals->used).data,
+                                    (totals->decommitted ? (char *)FormatHumanReadableBytes(totals->decommitted).data : "-"));
+    return result;
+}
+
+function void
+DrawMemoryStats(void)
+{
+    ScopedMemory temp;
+    MemoryReport report = GatherMemoryReport(temp);
+
+    Color foreground = GetThemeColor("text_foreground"_id);
+    Color background = GetThemeColor("text_background_popup"_id);
+
+    V2i p = MakeV2i(0, 1);
+
+    DrawText(p, PushTempStringF("%-13s %9s %9s %9s %9s", "memory", "reserved", "committed", "used", "trimmed"), foreground, background);
+    p.y += 1;
+
+    for (int subsystem = 0; subsystem < MemorySubsystem_COUNT; subsystem += 1)
+    {
+        const char *name = GetMemorySubsystemName((MemorySubsystem)subsystem);
+        DrawText(p, FormatMemoryTotals(name, &report.subsystems[subsystem]), foreground, background);
+        p.y += 1;
+    }
+
+    DrawText(p, FormatMemoryTotals("total", &report.total), foreground, background);
+    p.y += 1;
+}
+
+function void
+DumpMemoryReport(void)
+{
+    ScopedMemory temp;
+    MemoryReport report = GatherMemoryReport(temp);
+
+    platform->LogPrint(PlatformLogLevel_Info, "Memory by subsystem:");
+    platform->LogPrint(PlatformLogLevel_Info, "    %-13s %9s %9s %9s %9s", "subsystem", "reserved", "committed", "used", "trimmed");
+    for (int subsystem = 0; subsystem < MemorySubsystem_COUNT; subsystem += 1)
+    {
+        const char *name = GetMemorySubsystemName((MemorySubsystem)subsystem);
+        platform->LogPrint(PlatformLogLevel_Info, "    %.*s", StringExpand(FormatMemoryTotals(name, &report.subsystems[subsystem])));
+    }
+    platform->LogPrint(PlatformLogLevel_Info, "    %.*s", StringExpand(FormatMemoryTotals("total", &report.total)));
+    platform->LogPrint(PlatformLogLevel_Info, "    %s handed back to the OS in %u decommits",
+                       (char *)FormatHumanReadableBytes(report.total.decommitted).data,
+                       report.total.decommit_count);
+
+    SizeClassHeapStats heaps = {};
+    AddSizeClassHeapStats(&heaps, editor->heap);
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        AddSizeClassHeapStats(&heaps, it.buffer->heap);
+    }
+
+    size_t span_bytes = heaps.span_count*SIZE_CLASS_SPAN_SIZE;
+    heaps.fragmentation = (span_bytes ? 1.0f - (float)heaps.in_use / (float)span_bytes : 0.0f);
+
+    platform->LogPrint(PlatformLogLevel_Info, "Size class heaps (editor and buffers):");
+    platform->LogPrint(PlatformLogLevel_Info, "    %s committed in %zu spans, %s in use, %s cached by threads, %s free, %s span waste, %.1f%% fragmented, %zu large allocations totalling %s",
+                       (char *)FormatHumanReadableBytes(heaps.committed).data, heaps.span_count,
+                       (char *)FormatHumanReadableBytes(heaps.in_use).data,
+                       (char *)FormatHumanReadableBytes(heaps.cached).data,
+                       (char *)FormatHumanReadableBytes(heaps.free).data,
+                       (char *)FormatHumanReadableBytes(heaps.span_waste).data,
+                       100.0f*heaps.fragmentation,
+                       heaps.large_count,
+                       (char *)FormatHumanReadableBytes(heaps.large_size).data);
+    for (uint32_t size_class = 0; size_class < SIZE_CLASS_COUNT; size_class += 1)
+    {
+        if (heaps.blocks_in_use[size_class] || heaps.blocks_free[size_class])
+        {
+            platform->LogPrint(PlatformLogLevel_Info, "    %6zu byte blocks: %u in use, %u free",
+                               GetSizeClassBlockSize(size_class),
+                               heaps.blocks_in_use[size_class],
+                               heaps.blocks_free[size_class]);
+        }
+    }
+
+    platform->LogPrint(PlatformLogLevel_Info, "Memory by tag:");
+    platform->LogPrint(PlatformLogLevel_Info, "    %-13s %9s %9s %9s %9s %5s  %s", "subsystem", "reserved", "committed", "used", "trimmed", "count", "tag");
+    for (size_t i = 0; i < report.tags.count; i += 1)
+    {
+        MemoryTagTotals *tag = &report.tags[i];
+        platform->LogPrint(PlatformLogLevel_Info, "    %.*s %5u  %.*s",
+                           StringExpand(FormatMemoryTotals(GetMemorySubsystemName(tag->subsystem), &tag->totals)),
+                           tag->totals.count,
+                           StringExpand(tag->tag));
+    }
+}
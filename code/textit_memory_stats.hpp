@@ -0,0 +1,46 @@
+#ifndef TEXTIT_MEMORY_STATS_HPP
+#define TEXTIT_MEMORY_STATS_HPP
+
+enum MemorySubsystem
+{
+    MemorySubsystem_Text,
+    MemorySubsystem_LineIndex,
+    MemorySubsystem_Tokens,
+    MemorySubsystem_Tags,
+    MemorySubsystem_Undo,
+    MemorySubsystem_Buffers, // whatever is left over in buffer arenas and heaps, mostly free lists
+    MemorySubsystem_Render,
+    MemorySubsystem_CommandLine,
+    MemorySubsystem_Other,
+    MemorySubsystem_COUNT,
+};
+
+struct MemoryTotals
+{
+    uint32_t count;
+    size_t reserved;
+    size_t committed;
+    size_t used;
+    uint32_t decommit_count;
+    size_t decommitted; // NOTE: Total handed back to the OS over time, not a current amount
+};
+
+struct MemoryTagTotals
+{
+    String tag;
+    MemorySubsystem subsystem;
+    MemoryTotals totals;
+};
+
+struct MemoryReport
+{
+    MemoryTotals total;
+    MemoryTotals subsystems[MemorySubsystem_COUNT];
+
+    // NOTE: Sorted by committed bytes, biggest first
+    Slice<MemoryTagTotals> tags;
+};
+
+function void DumpMemoryReport(void);
+
+#endif /* TEXTIT_MEMORY_STATS_HPP */
@@ -9,6 +9,7 @@
 
 // ugh, whatever
 #include <assert.h>
+#include <limits.h>
 
 #define SimpleAssert(x) assert(x) // ((x) ? 1 : (__debugbreak(), 0))
 #define Assert(x) assert(x)
@@ -107,6 +108,7 @@
 
 #define WRITE_BARRIER _WriteBarrier()
 #define READ_BARRIER _ReadBarrier()
+#define FULL_BARRIER _mm_mfence()
 
 function uint32_t
 AtomicAdd(volatile uint32_t *dest, uint32_t value)
@@ -147,6 +149,22 @@ AtomicExchange(void *volatile *dest, void *value)
     return result;
 }
 
+function uint32_t
+AtomicCompareExchange(volatile uint32_t *dest, uint32_t expected, uint32_t value)
+{
+    // NOTE: This returns the value _before_ exchanging, the exchange happened if that equals expected
+    uint32_t result = (uint32_t)_InterlockedCompareExchange((volatile long *)dest, value, expected);
+    return result;
+}
+
+function void *
+AtomicCompareExchange(void *volatile *dest, void *expected, void *value)
+{
+    // NOTE: This returns the value _before_ exchanging, the exchange happened if that equals expected
+    void *result = InterlockedCompareExchangePointer(dest, value, expected);
+    return result;
+}
+
 function uint32_t
 GetThreadID()
 {
@@ -155,6 +173,10 @@ GetThreadID()
     return thread_id;
 }
 #elif COMPILER_LLVM
+#define WRITE_BARRIER __asm__ __volatile__("" ::: "memory")
+#define READ_BARRIER __asm__ __volatile__("" ::: "memory")
+#define FULL_BARRIER __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
 function uint32_t
 AtomicAdd(volatile uint32_t *dest, uint32_t value)
 {
@@ -162,6 +184,69 @@ AtomicAdd(volatile uint32_t *dest, uint32_t value)
     uint32_t result = __atomic_fetch_add(dest, value, __ATOMIC_SEQ_CST);
     return result;
 }
+
+function uint32_t
+AtomicIncrement(volatile uint32_t *dest)
+{
+    // NOTE: This returns the value _before_ adding
+    uint32_t result = __atomic_fetch_add(dest, 1, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+function uint32_t
+AtomicExchange(volatile int32_t *dest, int32_t value)
+{
+    // NOTE: This returns the value _before_ exchanging
+    int32_t result = __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+function uint32_t
+AtomicExchange(volatile uint32_t *dest, uint32_t value)
+{
+    // NOTE: This returns the value _before_ exchanging
+    uint32_t result = __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+function void *
+AtomicExchange(void *volatile *dest, void *value)
+{
+    void *result = __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+function uint32_t
+AtomicCompareExchange(volatile uint32_t *dest, uint32_t expected, uint32_t value)
+{
+    // NOTE: This returns the value _before_ exchanging, the exchange happened if that equals expected
+    __atomic_compare_exchange_n(dest, &expected, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return expected;
+}
+
+function void *
+AtomicCompareExchange(void *volatile *dest, void *expected, void *value)
+{
+    // NOTE: This returns the value _before_ exchanging, the exchange happened if that equals expected
+    __atomic_compare_exchange_n(dest, &expected, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return expected;
+}
+
+function uint32_t
+GetThreadID()
+{
+#if _WIN32
+    uint8_t *thread_local_storage = (uint8_t *)__readgsqword(0x30);
+    uint32_t thread_id = *(uint32_t *)(thread_local_storage + 0x48);
+#else
+    // NOTE: fs:0 holds the address of the thread control block, which is unique per thread and
+    // page aligned, and unlike the address of a thread_local survives hot reloading
+    uint64_t thread_control_block;
+    __asm__ __volatile__("movq %%fs:0, %0" : "=r"(thread_control_block));
+    uint32_t thread_id = (uint32_t)(thread_control_block >> 12);
+#endif
+    return thread_id;
+}
 #endif
 
 struct TicketMutex
@@ -377,7 +462,7 @@ enum PlatformInputCode_ENUM : PlatformInputCode
     PlatformInputCode_MediaPrevTrack = 0xB1,
     /* 0xB5 - 0xB7: "launch" keys, not sure what's up with that */
     PlatformInputCode_Oem1           = 0xBA, // misc characters, us standard: ';:'
-    PlatformInputCode_Plus           = 0xBB,
+    PlatformInputCode_Plus           = 0xBB, // us standard: '=+', so unshifted this is the '=' key
     PlatformInputCode_Comma          = 0xBC,
     PlatformInputCode_Minus          = 0xBD,
     PlatformInputCode_Period         = 0xBE,
@@ -449,6 +534,19 @@ struct PlatformJobQueue;
 #define PLATFORM_JOB(name) void name(void *userdata)
 typedef PLATFORM_JOB(PlatformJobProc);
 
+struct PlatformJobContinuation;
+
+// NOTE: Counts the jobs added to it that haven't finished yet. Jobs added with AddJobAfter only get
+// queued once every job in the group they come after has finished, which is how a chain like
+// tokenize -> parse tags -> index gets expressed. Zero initialize to use.
+struct PlatformJobGroup
+{
+    volatile uint32_t pending;
+    uint32_t priority; // the lowest priority of the jobs added, a wait helps run jobs up to this priority
+    TicketMutex mutex;
+    PlatformJobContinuation *continuations;
+};
+
 #define PLATFORM_MAX_LOG_LINES 1024
 #define PLATFORM_LOG_LINE_SIZE 1024
 
@@ -511,6 +609,32 @@ struct PlatformOffscreenBuffer
 
 struct Heap;
 
+#define PLATFORM_MEMORY_TAG_SIZE 256
+
+// NOTE: Every reservation and heap carries one of these. The platform fills in reserved, but commits
+// happen piecemeal through CommitMemory, so committed and used are kept up to date by whoever owns the
+// memory (see PushSize_ for arenas).
+struct PlatformMemoryStats
+{
+    const char *tag;
+    bool is_heap;
+    size_t reserved;
+    size_t committed;
+    size_t used;
+
+    // NOTE: Running totals of memory handed back to the OS with DecommitMemory
+    uint32_t decommit_count;
+    size_t decommitted;
+};
+
+struct PlatformFrameTimings
+{
+    // NOTE: Filled in by the app every frame, in seconds
+    double draw;
+    double sort;
+    double rasterize;
+};
+
 struct Platform
 {
     bool exit_requested;
@@ -523,6 +647,15 @@ struct Platform
 
     float dt;
 
+    PlatformFrameTimings frame_timings;
+
+    // NOTE: Set by the platform once the last frame has been handed off to the display
+    PlatformHighResTime present_time;
+
+    // NOTE: Files handed to the platform on the command line, opened by the app on startup
+    int startup_file_count;
+    String *startup_files;
+
     PlatformEventIterator (*IterateEvents)(PlatformEventFilter filter);
     bool (*NextEvent)(PlatformEventIterator *it, PlatformEvent *volatile out_event);
     void (*PushTickEvent)(void);
@@ -559,7 +692,10 @@ struct Platform
     void (*DecommitMemory)(void *location, size_t size);
     void (*DeallocateMemory)(void *memory);
 
-    Heap *(*CreateHeap)(size_t initial_size, size_t max_size);
+    PlatformMemoryStats *(*GetMemoryStats)(void *memory);
+    size_t (*GatherMemoryStats)(size_t max_count, PlatformMemoryStats *out_stats);
+
+    Heap *(*CreateHeap)(size_t initial_size, size_t max_size, const char *tag);
     void (*DestroyHeap)(Heap *heap);
 
     void *(*HeapAlloc)(Heap *heap, size_t size);
@@ -586,6 +722,9 @@ struct Platform
 
     void (*AddJob)(PlatformJobQueue *queue, void *arg, PlatformJobProc *proc);
     void (*WaitForJobs)(PlatformJobQueue *queue);
+    void (*AddJobToGroup)(PlatformJobQueue *queue, PlatformJobGroup *group, void *arg, PlatformJobProc *proc);
+    void (*AddJobAfter)(PlatformJobQueue *queue, PlatformJobGroup *after, PlatformJobGroup *group, void *arg, PlatformJobProc *proc);
+    void (*WaitForJobGroup)(PlatformJobGroup *group);
 
     String (*GetExeDirectory)(void);
     bool (*SetWorkingDirectory)(String path);
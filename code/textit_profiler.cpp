@@ -0,0 +1,441 @@
+static thread_local ProfilerThread *profiler_thread_;
+static ProfilerThread profiler_overflow_thread_;
+
+function ProfilerThread *
+GetProfilerThread(void)
+{
+    ProfilerThread *result = profiler_thread_;
+    if (!result)
+    {
+        // NOTE: Threads are found by their ID rather than just trusting the thread local, because a hot reload
+        // gives us fresh thread locals while the rings recorded by the old code are still around
+        uint32_t thread_id = GetThreadID();
+
+        BeginTicketMutex(&profiler->thread_mutex);
+
+        for (uint32_t i = 0; i < profiler->thread_count; i += 1)
+        {
+            if (profiler->threads[i].thread_id == thread_id)
+            {
+                result = &profiler->threads[i];
+                break;
+            }
+        }
+
+        if (!result && profiler->thread_count < PROFILER_MAX_THREADS)
+        {
+            result = &profiler->threads[profiler->thread_count];
+            result->thread_id   = thread_id;
+            result->lane        = profiler->thread_count;
+            result->write_index = 0;
+            result->events      = (ProfilerEvent *)platform->AllocateMemory(PROFILER_EVENTS_PER_THREAD*sizeof(ProfilerEvent),
+                                                                            PlatformMemFlag_NoLeakCheck,
+                                                                            LOCATION_STRING("Profiler Events"));
+            WRITE_BARRIER;
+            profiler->thread_count += 1;
+        }
+
+        EndTicketMutex(&profiler->thread_mutex);
+
+        if (!result)
+        {
+            // NOTE: Out of thread slots, this thread just won't show up
+            result = &profiler_overflow_thread_;
+        }
+
+        profiler_thread_ = result;
+    }
+    return result;
+}
+
+function void
+RecordProfilerEvent(const char *name, ProfilerEventKind kind)
+{
+    ProfilerThread *thread = GetProfilerThread();
+    if (thread->events)
+    {
+        uint32_t index = thread->write_index;
+
+        ProfilerEvent *event = &thread->events[index % PROFILER_EVENTS_PER_THREAD];
+        event->clock = __rdtsc();
+        event->name  = name;
+        event->kind  = kind;
+
+        WRITE_BARRIER;
+
+        thread->write_index = index + 1;
+    }
+}
+
+function double
+GetProfilerClocksPerSecond(void)
+{
+    double result = profiler->clocks_per_second;
+    if (result <= 0.0)
+    {
+        double seconds = platform->SecondsElapsed(profiler->calibration_time, platform->GetTime());
+        uint64_t clocks = __rdtsc() - profiler->calibration_clock;
+        result = (seconds > 0.0 ? (double)clocks / seconds : 1.0);
+    }
+    return result;
+}
+
+function void
+BeginProfilerFrame(void)
+{
+    if (platform->exe_reloaded)
+    {
+        for (uint32_t i = 0; i < profiler->thread_count; i += 1)
+        {
+            profiler->threads[i].write_index = 0;
+        }
+        profiler->frame_count = 0;
+    }
+
+    uint64_t clock = __rdtsc();
+    PlatformHighResTime time = platform->GetTime();
+
+    if (!profiler->calibration_clock)
+    {
+        profiler->calibration_clock = clock;
+        profiler->calibration_time  = time;
+    }
+    else
+    {
+        // NOTE: The longer we run, the better the estimate of the TSC frequency gets
+        double seconds = platform->SecondsElapsed(profiler->calibration_time, time);
+        if (seconds > 0.1)
+        {
+            profiler->clocks_per_second = (double)(clock - profiler->calibration_clock) / seconds;
+        }
+    }
+
+    ProfilerFrame *frame = &profiler->frames[profiler->frame_count % PROFILER_MAX_FRAMES];
+    frame->begin_clock = clock;
+    frame->end_clock   = 0;
+}
+
+function void
+EndProfilerFrame(void)
+{
+    ProfilerFrame *frame = &profiler->frames[profiler->frame_count % PROFILER_MAX_FRAMES];
+    frame->end_clock = __rdtsc();
+    profiler->frame_count += 1;
+}
+
+// NOTE: Pairs up begin and end events into zones that overlap [begin_clock, end_clock). Zones get pushed
+// one after another onto the arena, so nothing else may allocate from it while this runs.
+function Slice<ProfilerZone>
+GatherProfilerZones(Arena *arena, uint64_t begin_clock, uint64_t end_clock)
+{
+    ProfilerZone *zones = nullptr;
+    size_t zone_count = 0;
+
+    uint64_t now = __rdtsc();
+
+    for (uint32_t thread_index = 0; thread_index < profiler->thread_count; thread_index += 1)
+    {
+        ProfilerThread *thread = &profiler->threads[thread_index];
+
+        uint32_t write_index = thread->write_index;
+        READ_BARRIER;
+
+        // NOTE: Keep away from the oldest part of the ring, the owning thread might be overwriting it right now
+        uint32_t available = write_index;
+        if (available > PROFILER_EVENTS_PER_THREAD - 1024)
+        {
+            available = PROFILER_EVENTS_PER_THREAD - 1024;
+        }
+
+        // NOTE: Walk back to the start of the range, and then further until every end event in the range
+        // has seen its begin, so zones that started before the range still show up
+        uint32_t start_index = write_index;
+        int64_t unmatched_ends = 0;
+        while (start_index > write_index - available)
+        {
+            ProfilerEvent *event = &thread->events[(start_index - 1) % PROFILER_EVENTS_PER_THREAD];
+            if (event->clock < begin_clock && unmatched_ends <= 0)
+            {
+                break;
+            }
+            unmatched_ends += (event->kind == ProfilerEvent_End ? 1 : -1);
+            start_index -= 1;
+        }
+
+        uint32_t depth = 0;
+        ProfilerZone stack[PROFILER_MAX_DEPTH];
+
+        for (uint32_t index = start_index; index != write_index; index += 1)
+        {
+            ProfilerEvent *event = &thread->events[index % PROFILER_EVENTS_PER_THREAD];
+            if (event->clock >= end_clock)
+            {
+                break;
+            }
+
+            if (event->kind == ProfilerEvent_Begin)
+            {
+                if (depth < PROFILER_MAX_DEPTH)
+                {
+                    ProfilerZone *zone = &stack[depth];
+                    zone->name        = event->name;
+                    zone->begin_clock = event->clock;
+                    zone->end_clock   = 0;
+                    zone->thread      = thread_index;
+                    zone->depth       = depth;
+                }
+                depth += 1;
+            }
+            else if (depth > 0)
+            {
+                depth -= 1;
+                if (depth < PROFILER_MAX_DEPTH && event->clock >= begin_clock)
+                {
+                    ProfilerZone *zone = PushStructNoClear(arena, ProfilerZone);
+                    if (!zones) zones = zone;
+                    *zone = stack[depth];
+                    zone->end_clock = event->clock;
+                    zone_count += 1;
+                }
+            }
+        }
+
+        // NOTE: Zones that are still open get cut off at the end of the range
+        uint64_t cutoff = Min(end_clock, now);
+        for (uint32_t open = 0; open < depth && open < PROFILER_MAX_DEPTH; open += 1)
+        {
+            if (stack[open].begin_clock < cutoff)
+            {
+                ProfilerZone *zone = PushStructNoClear(arena, ProfilerZone);
+                if (!zones) zones = zone;
+                *zone = stack[open];
+                zone->end_clock = cutoff;
+                zone_count += 1;
+            }
+        }
+    }
+
+    Slice<ProfilerZone> result = MakeSlice(zone_count, zones);
+    return result;
+}
+
+function Color
+GetProfilerZoneColor(const char *name)
+{
+    static const Color palette[] =
+    {
+        MakeColor(230, 159, 110), MakeColor(140, 200, 120), MakeColor(120, 170, 230), MakeColor(220, 200, 110),
+        MakeColor(190, 140, 220), MakeColor(110, 200, 200), MakeColor(230, 130, 150), MakeColor(170, 190, 140),
+    };
+
+    uint32_t hash = 2166136261u;
+    for (const char *at = name; *at; at += 1)
+    {
+        hash = (hash ^ (uint8_t)*at)*16777619u;
+    }
+
+    Color result = palette[hash % ArrayCount(palette)];
+    return result;
+}
+
+function void
+DrawProfiler(void)
+{
+    uint64_t wanted_frames = (core_config->profiler_frames > 1 ? (uint64_t)core_config->profiler_frames : 1);
+
+    uint64_t frame_count = profiler->frame_count;
+    if (frame_count > PROFILER_MAX_FRAMES - 1) frame_count = PROFILER_MAX_FRAMES - 1;
+    if (frame_count > wanted_frames) frame_count = wanted_frames;
+
+    if (!frame_count)
+    {
+        return;
+    }
+
+    ProfilerFrame *first_frame = &profiler->frames[(profiler->frame_count - frame_count) % PROFILER_MAX_FRAMES];
+    ProfilerFrame *last_frame  = &profiler->frames[(profiler->frame_count - 1) % PROFILER_MAX_FRAMES];
+
+    uint64_t begin_clock = first_frame->begin_clock;
+    uint64_t end_clock   = last_frame->end_clock;
+    if (end_clock <= begin_clock)
+    {
+        return;
+    }
+
+    Arena *arena = render_state->arena;
+    Slice<ProfilerZone> zones = GatherProfilerZones(arena, begin_clock, end_clock);
+
+    // NOTE: Every thread gets as many rows as its deepest zone needs
+    uint32_t thread_rows[PROFILER_MAX_THREADS] = {};
+    for (size_t i = 0; i < zones.count; i += 1)
+    {
+        ProfilerZone *zone = &zones[i];
+        if (thread_rows[zone->thread] < zone->depth + 1)
+        {
+            thread_rows[zone->thread] = zone->depth + 1;
+        }
+    }
+
+    uint32_t thread_first_row[PROFILER_MAX_THREADS] = {};
+    uint32_t row_count = 0;
+    for (uint32_t thread = 0; thread < profiler->thread_count; thread += 1)
+    {
+        thread_first_row[thread] = row_count;
+        row_count += thread_rows[thread];
+    }
+
+    Rect2i viewport = render_state->viewport;
+    int64_t max_rows = GetHeight(viewport) / 2;
+    if ((int64_t)row_count > max_rows) row_count = (uint32_t)max_rows;
+
+    if (!row_count)
+    {
+        return;
+    }
+
+    V2i metrics = editor->font_metrics;
+    int64_t chart_top = viewport.max.y - row_count;
+
+    double clocks_per_ms = GetProfilerClocksPerSecond() / 1000.0;
+    double total_ms = (double)(end_clock - begin_clock) / clocks_per_ms;
+
+    Color foreground = GetThemeColor("text_foreground"_id);
+    Color background = GetThemeColor("text_background_popup"_id);
+
+    Bitmap *chart = PushStruct(arena, Bitmap);
+    *chart = PushBitmap(arena, (int)(GetWidth(viewport)*metrics.x), (int)(row_count*metrics.y));
+    BlitRect(chart, MakeRect2iMinDim(0, 0, chart->w, chart->h), background);
+
+    double pixels_per_clock = (double)chart->w / (double)(end_clock - begin_clock);
+
+    for (uint64_t frame_index = profiler->frame_count - frame_count; frame_index < profiler->frame_count; frame_index += 1)
+    {
+        ProfilerFrame *frame = &profiler->frames[frame_index % PROFILER_MAX_FRAMES];
+        int64_t x = (int64_t)((double)(frame->begin_clock - begin_clock)*pixels_per_clock);
+        BlitRect(chart, MakeRect2iMinDim(x, 0, 1, chart->h), foreground);
+    }
+
+    RenderLayer old_layer = PushLayer(Layer_OverlayForeground);
+
+    for (size_t i = 0; i < zones.count; i += 1)
+    {
+        ProfilerZone *zone = &zones[i];
+
+        uint32_t row = thread_first_row[zone->thread] + zone->depth;
+        if (row >= row_count)
+        {
+            continue;
+        }
+
+        uint64_t zone_begin = (zone->begin_clock > begin_clock ? zone->begin_clock : begin_clock);
+        uint64_t zone_end   = Min(zone->end_clock, end_clock);
+
+        int64_t x0 = (int64_t)((double)(zone_begin - begin_clock)*pixels_per_clock);
+        int64_t x1 = (int64_t)((double)(zone_end   - begin_clock)*pixels_per_clock);
+        if (x1 <= x0) x1 = x0 + 1;
+
+        Color color = GetProfilerZoneColor(zone->name);
+        BlitRect(chart, MakeRect2iMinMax(MakeV2i(x0, row*metrics.y + 1), MakeV2i(x1, (row + 1)*metrics.y - 1)), color);
+
+        // NOTE: Only label zones that have room for the whole name
+        int64_t cell_x0 = (x0 + metrics.x - 1) / metrics.x;
+        int64_t cell_x1 = x1 / metrics.x;
+
+        double ms = (double)(zone->end_clock - zone->begin_clock) / clocks_per_ms;
+        String label = PushTempStringF("%s %.2fms", zone->name, ms);
+        if (cell_x1 - cell_x0 < (int64_t)label.size)
+        {
+            label = MakeString(strlen(zone->name), (uint8_t *)zone->name);
+        }
+
+        if (cell_x1 - cell_x0 >= (int64_t)label.size)
+        {
+            DrawText(MakeV2i(cell_x0, chart_top + row), label, MakeColor(0, 0, 0), color);
+        }
+    }
+
+    String header = PushTempStringF("profiler: %llu frames, %.2fms (%.2fms per frame), %zu zones, %u threads",
+                                    (unsigned long long)frame_count, total_ms, total_ms / (double)frame_count,
+                                    zones.count, profiler->thread_count);
+    DrawText(MakeV2i(0, chart_top - 1), header, foreground, background);
+
+    PushLayer(Layer_OverlayBackground);
+    PushBitmap(chart, MakeV2i(0, chart_top*metrics.y));
+
+    PushLayer(old_layer);
+}
+
+function String
+EscapeJsonString(Arena *arena, const char *string)
+{
+    size_t length = strlen(string);
+
+    String result = {};
+    result.data = PushArrayNoClear(arena, 2*length + 1, uint8_t);
+    for (size_t i = 0; i < length; i += 1)
+    {
+        char c = string[i];
+        if (c == '"' || c == '\\')
+        {
+            result.data[result.size++] = '\\';
+        }
+        result.data[result.size++] = (uint8_t)c;
+    }
+    result.data[result.size] = 0;
+    return result;
+}
+
+// NOTE: Writes everything still in the rings as complete ("X") events in the Chrome trace event format,
+// which chrome://tracing, Perfetto and speedscope can all open.
+function bool
+WriteProfilerTrace(String path)
+{
+    Arena arena = {};
+    defer { Release(&arena); };
+
+    Slice<ProfilerZone> zones = GatherProfilerZones(&arena, 0, UINT64_MAX);
+
+    uint64_t base_clock = UINT64_MAX;
+    for (size_t i = 0; i < zones.count; i += 1)
+    {
+        base_clock = Min(base_clock, zones[i].begin_clock);
+    }
+
+    double clocks_per_us = GetProfilerClocksPerSecond() / 1000000.0;
+
+    StringList list = MakeStringList(&arena);
+    PushF(&list, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for (uint32_t thread = 0; thread < profiler->thread_count; thread += 1)
+    {
+        PushF(&list, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}},\n",
+              thread, (thread == 0 ? "main" : "worker"), profiler->threads[thread].thread_id);
+    }
+
+    for (size_t i = 0; i < zones.count; i += 1)
+    {
+        ProfilerZone *zone = &zones[i];
+        String name = EscapeJsonString(&arena, zone->name);
+        PushF(&list, "{\"name\":\"%.*s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+              StringExpand(name), zone->thread,
+              (double)(zone->begin_clock - base_clock) / clocks_per_us,
+              (double)(zone->end_clock - zone->begin_clock) / clocks_per_us);
+    }
+
+    // NOTE: JSON doesn't allow a trailing comma, so the list ends on an empty metadata event
+    PushF(&list, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"textit\"}}\n]}\n");
+
+    String json = FlattenStringOnArena(&list, &arena);
+    bool result = platform->WriteFile(json.size, json.data, path);
+
+    if (result)
+    {
+        platform->LogPrint(PlatformLogLevel_Info, "Wrote %zu profiler zones to %.*s", zones.count, StringExpand(path));
+    }
+    else
+    {
+        platform->LogPrint(PlatformLogLevel_Warning, "Could not write profiler trace to %.*s", StringExpand(path));
+    }
+
+    return result;
+}
@@ -0,0 +1,86 @@
+#ifndef TEXTIT_PROFILER_HPP
+#define TEXTIT_PROFILER_HPP
+
+#ifndef TEXTIT_PROFILE
+#define TEXTIT_PROFILE TEXTIT_INTERNAL
+#endif
+
+#define PROFILER_MAX_THREADS       32
+#define PROFILER_EVENTS_PER_THREAD (1 << 15)
+#define PROFILER_MAX_FRAMES        64
+#define PROFILER_MAX_DEPTH         16
+
+StaticAssert(IsPow2(PROFILER_EVENTS_PER_THREAD), "Profiler rings must be a power of 2");
+
+enum ProfilerEventKind : uint32_t
+{
+    ProfilerEvent_Begin,
+    ProfilerEvent_End,
+};
+
+struct ProfilerEvent
+{
+    uint64_t clock;
+    const char *name;
+    ProfilerEventKind kind;
+};
+
+// NOTE: Each thread only ever writes into its own ring, so recording an event needs no synchronization.
+// Readers look at write_index to know how far the ring is filled.
+struct ProfilerThread
+{
+    uint32_t thread_id;
+    uint32_t lane;
+    volatile uint32_t write_index;
+    ProfilerEvent *events;
+};
+
+struct ProfilerFrame
+{
+    uint64_t begin_clock;
+    uint64_t end_clock;
+};
+
+struct ProfilerZone
+{
+    const char *name;
+    uint64_t begin_clock;
+    uint64_t end_clock;
+    uint32_t thread;
+    uint32_t depth;
+};
+
+struct Profiler
+{
+    TicketMutex thread_mutex;
+    uint32_t thread_count;
+    ProfilerThread threads[PROFILER_MAX_THREADS];
+
+    uint64_t frame_count;
+    ProfilerFrame frames[PROFILER_MAX_FRAMES];
+
+    uint64_t calibration_clock;
+    PlatformHighResTime calibration_time;
+    double clocks_per_second;
+};
+GLOBAL_STATE(Profiler, profiler);
+
+function void RecordProfilerEvent(const char *name, ProfilerEventKind kind);
+function bool WriteProfilerTrace(String path);
+
+struct ScopedTimedBlock
+{
+    const char *name;
+    ScopedTimedBlock(const char *name_) : name(name_) { RecordProfilerEvent(name, ProfilerEvent_Begin); }
+    ~ScopedTimedBlock() { RecordProfilerEvent(name, ProfilerEvent_End); }
+};
+
+#if TEXTIT_PROFILE
+#define TimedBlock(name) ScopedTimedBlock Paste(timed_block_, __LINE__)(name)
+#define TimedFunction TimedBlock(__FUNCTION__)
+#else
+#define TimedBlock(name)
+#define TimedFunction
+#endif
+
+#endif /* TEXTIT_PROFILER_HPP */
@@ -35,71 +35,74 @@ FindProjectRoot(Arena *arena, String search_start)
         }
 
         // WARNING: very lazy
-        search_path = PushTempStringF("%.*s..\\", StringExpand(search_path));
+        search_path = PushTempStringF("%.*s../", StringExpand(search_path));
     }
 
     String result = platform->PushFullPath(arena, search_path);
     return result;
 }
 
-function void
-OpenCodeFilesRecursively(String search_start, BufferFlags buffer_flags = 0)
+struct ProjectFileSearch
 {
-    Arena *temp = platform->GetTempArena();
+    String name;
+    String found_path;
+};
 
-    String search_path = SplitPath(search_start);
-    for (PlatformFileIterator *it = platform->FindFiles(temp, search_path);
-         platform->FileIteratorIsValid(it);
-         platform->FileIteratorNext(it))
-    {
-        if (AreEqual(it->info.name, "."_str) || AreEqual(it->info.name, ".."_str)) continue; // first two are always '.' and '..', not sure what to do with that yet
-        if (AreEqual(it->info.name, ".vs"_str)) continue; // no.
-        if (AreEqual(it->info.name, ".git"_str)) continue; // don't do it.
+function
+FILE_WALKER_FILTER(FindProjectFileFilter)
+{
+    ProjectFileSearch *search = (ProjectFileSearch *)walker->userdata;
 
-        if (it->info.directory)
+    if (AreEqual(name, search->name, StringMatch_CaseInsensitive))
+    {
+        BeginTicketMutex(&walker->mutex);
+        if (!search->found_path.size)
         {
-            OpenCodeFilesRecursively(PushTempStringF("%.*s%.*s\\", StringExpand(search_path), StringExpand(it->info.name)), buffer_flags);
+            search->found_path = PushString(&walker->arena, path);
         }
-        else
-        {
-            String ext;
-            SplitExtension(it->info.name, &ext);
+        EndTicketMutex(&walker->mutex);
 
-            if (GetLanguageFromExtension(ext))
-            {
-                OpenBufferFromFileAsync(platform->high_priority_queue, 
-                                        PushStringF(temp, "%.*s%.*s", StringExpand(search_path), StringExpand(it->info.name)), 
-                                        buffer_flags);
-            }
-        }
+        walker->cancel = true;
     }
+
+    return false;
 }
 
 function Buffer *
-RecursivelyFindAndOpenBuffer(String search_path, String name)
+FindAndOpenProjectFile(Project *project, String name)
 {
     Buffer *result = nullptr;
 
-    ScopedMemory temp;
-    for (PlatformFileIterator *it = platform->FindFiles(temp, search_path);
-         platform->FileIteratorIsValid(it);
-         platform->FileIteratorNext(it))
-    {
-        if (AreEqual(it->info.name, "."_str) || AreEqual(it->info.name, ".."_str)) continue; // first two are always '.' and '..', not sure what to do with that yet
-        if (AreEqual(it->info.name, ".vs"_str)) continue; // no.
-        if (AreEqual(it->info.name, ".git"_str)) continue; // don't do it.
+    // NOTE: Files the indexer already came across don't need to be searched for
+    IndexedFile *first_file = project->index.first_file;
+    READ_BARRIER;
 
-        if (it->info.directory)
-        {
-            RecursivelyFindAndOpenBuffer(PushTempStringF("%.*s%.*s\\", StringExpand(search_path), StringExpand(it->info.name)), name);
-        }
-        else if (AreEqual(it->info.name, name, StringMatch_CaseInsensitive))
+    for (IndexedFile *file = first_file; file; file = file->next)
+    {
+        if (AreEqual(file->name, name, StringMatch_CaseInsensitive))
         {
-            result = OpenBufferFromFile(PushTempStringF("%.*s%.*s", StringExpand(search_path), StringExpand(it->info.name)));
-            break;
+            result = OpenBufferFromFile(file->full_path);
+            return result;
         }
     }
 
+    ProjectFileSearch search = {};
+    search.name = name;
+
+    FileWalker walker = {};
+    walker.Filter   = FindProjectFileFilter;
+    walker.userdata = &search;
+
+    BeginFileWalk(&walker, platform->high_priority_queue, project->root, {});
+    WaitForFileWalk(&walker);
+
+    if (search.found_path.size)
+    {
+        result = OpenBufferFromFile(search.found_path);
+    }
+
+    EndFileWalk(&walker);
+
     return result;
 }
 
@@ -132,7 +135,7 @@ FindOrOpenBuffer(Project *project, String name)
 
     if (!result)
     {
-        result = RecursivelyFindAndOpenBuffer(project->root, name);
+        result = FindAndOpenProjectFile(project, name);
     }
 
     return result;
@@ -152,49 +155,8 @@ CreateProject(String search_start)
     }
     DllInsertBack(&editor->project_sentinel, project);
 
-    PlatformHighResTime start = platform->GetTime();
-
-    project->opening = true;
+    BeginIndexingProject(project);
 
-    OpenCodeFilesRecursively(project->root);
-    platform->WaitForJobs(platform->high_priority_queue);
-
-    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
-    {
-        Buffer *buffer = it.buffer;
-        if (buffer->project != project) continue;
-
-        Tags *tags = buffer->tags;
-        for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
-        {
-            Tag **slot = &project->tag_table[tag->hash.u32[0] % PROJECT_TAG_TABLE_SIZE];
-            tag->next_in_hash = *slot;
-            *slot = tag;
-        }
-    }
-
-    project->opening = false;
-
-    PlatformHighResTime end = platform->GetTime();
-
-    double total_time = platform->SecondsElapsed(start, end);
-
-    size_t total_bytes         = 0;
-    size_t total_lines_of_code = 0;
-    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
-    {
-        Buffer *buffer = it.buffer;
-        if (buffer->project != project) continue;
-
-        total_bytes         += buffer->count;
-        total_lines_of_code += GetLineCount(buffer);
-    }
-
-    platform->DebugPrint("Loaded %s worth of text representing %zu lines of code in %fms\n",
-                         FormatHumanReadableBytes(total_bytes).data,
-                         total_lines_of_code,
-                         1000.0*total_time);
-    
     return project;
 }
 
@@ -204,6 +166,8 @@ DestroyProject(Project *project)
     Assert(project);
     Assert(project != &editor->project_sentinel);
 
+    StopIndexingProject(project);
+
     for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
     {
         Buffer *buffer = it.buffer;
@@ -214,10 +178,17 @@ DestroyProject(Project *project)
     }
     Assert(project->associated_buffer_count == 0);
 
+    Release(&project->index.arena);
+    for (size_t i = 0; i < PROJECT_INDEX_SCRATCH_COUNT; i += 1)
+    {
+        Release(&project->index.scratch[i].arena);
+    }
+    Release(&project->references.arena);
+    ReleaseTagNameIndex(&project->tag_names);
     project->root = "FREE PROJECT"_str;
 
     DllRemove(project);
-    SllStackPush(project, editor->first_free_project);
+    SllStackPush(editor->first_free_project, project);
 }
 
 function void
@@ -240,24 +211,843 @@ AssociateProject(Buffer *buffer)
         project = CreateProject(buffer->full_path);
     }
 
+    buffer->project = project;
+    project->associated_buffer_count += 1;
+
+    if (IndexedFile *file = FindIndexedFile(project, buffer->full_path))
+    {
+        file->open_buffer = buffer->id;
+    }
+
+    if (IsBufferLoaded(buffer))
+    {
+        AddBufferTagsToProject(buffer);
+    }
+}
+
+function void
+AddBufferTagsToProject(Buffer *buffer)
+{
+    Project *project = buffer->project;
+    if (!project) return;
+
+    BeginTagNameBatch(&project->tag_names);
+
     Tags *tags = buffer->tags;
     for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
     {
-        uint32_t slot = tag->hash.u32[0] % ArrayCount(project->tag_table);
+        uint32_t slot = tag->hash.u32[0] % PROJECT_TAG_TABLE_SIZE;
         tag->next_in_hash = project->tag_table[slot];
         project->tag_table[slot] = tag;
+
+        ScopedMemory temp;
+        AddTagName(&project->tag_names, tag->hash, PushBufferRange(temp, buffer, MakeRangeStartLength(tag->pos, tag->length)));
     }
 
-    buffer->project = project;
-    project->associated_buffer_count += 1;
+    EndTagNameBatch(&project->tag_names);
+
+    project->tag_generation += 1;
 }
 
 function void
 RemoveProjectAssociation(Buffer *buffer)
 {
     Project *project = buffer->project;
+    if (!project) return;
+
+    IndexedFile *file = FindIndexedFile(project, buffer->full_path);
+    if (file && file->open_buffer == buffer->id)
+    {
+        file->open_buffer = {};
+    }
+
     project->associated_buffer_count -= 1;
-    project = nullptr;
+}
+
+//
+// References
+//
+
+function uint64_t
+GetReferenceAtom(String name)
+{
+    HashResult hash = HashString(name);
+    return hash.u64[0];
+}
+
+function bool
+IsReferenceTokenKind(TokenKind kind)
+{
+    return (kind == Token_Identifier ||
+            kind == Token_Function);
+}
+
+struct LineReferenceIterator
+{
+    TokenBlock *last_block;
+    TokenBlock *block;
+    int64_t     index;
+    int64_t     pos;
+    Token      *token;
+};
+
+function void
+SeekReferenceToken(LineReferenceIterator *it)
+{
+    it->token = nullptr;
+    while (it->block)
+    {
+        if (it->index >= it->block->token_count)
+        {
+            it->block = (it->block == it->last_block ? nullptr : it->block->next);
+            it->index = 0;
+            continue;
+        }
+
+        Token *token = &it->block->tokens[it->index];
+        if (IsReferenceTokenKind(token->kind))
+        {
+            it->token = token;
+            break;
+        }
+
+        it->pos   += token->length;
+        it->index += 1;
+    }
+}
+
+function LineReferenceIterator
+IterateLineReferences(LineData *data, int64_t line_start)
+{
+    LineReferenceIterator result = {};
+    result.last_block = data->last_token_block;
+    result.block      = data->first_token_block;
+    result.pos        = line_start;
+    SeekReferenceToken(&result);
+    return result;
+}
+
+function bool
+IsValid(LineReferenceIterator *it)
+{
+    return !!it->token;
+}
+
+function void
+Next(LineReferenceIterator *it)
+{
+    if (!IsValid(it)) return;
+
+    it->pos   += it->token->length;
+    it->index += 1;
+    SeekReferenceToken(it);
+}
+
+function ReferenceAtom *
+FindReferenceAtom(ReferenceIndex *index, uint64_t atom, bool create)
+{
+    if (!index->table)
+    {
+        if (!create) return nullptr;
+        index->table = PushArray(&index->arena, PROJECT_REFERENCE_TABLE_SIZE, ReferenceAtom *);
+    }
+
+    ReferenceAtom **slot = &index->table[atom % PROJECT_REFERENCE_TABLE_SIZE];
+
+    ReferenceAtom *result = *slot;
+    while (result && result->atom != atom)
+    {
+        result = result->next_in_hash;
+    }
+
+    if (!result && create)
+    {
+        result = PushStruct(&index->arena, ReferenceAtom);
+        result->atom = atom;
+        DllInit(&result->sentinel);
+
+        result->next_in_hash = *slot;
+        *slot = result;
+    }
+
+    return result;
+}
+
+function void
+AddLineReferences(Buffer *buffer, LineIndexNode *record, int64_t line_start)
+{
+    if (!buffer->references_indexed)
+    {
+        return;
+    }
+
+    Project *project = buffer->project;
+    ReferenceIndex *index = &project->references;
+
+    LineData *data = &record->data;
+    Assert(!data->first_reference);
+
+    for (LineReferenceIterator it = IterateLineReferences(data, line_start); IsValid(&it); Next(&it))
+    {
+        uint64_t atom = GetReferenceAtom(MakeString(it.token->length, buffer->text + it.pos));
+
+        // NOTE: A line only needs one entry per atom, the occurrences within the line are found when querying
+        bool already_referenced = false;
+        for (ReferenceEntry *entry = data->first_reference; entry; entry = entry->next_in_line)
+        {
+            if (entry->atom->atom == atom)
+            {
+                already_referenced = true;
+                break;
+            }
+        }
+
+        if (already_referenced)
+        {
+            continue;
+        }
+
+        ReferenceEntry *entry = index->first_free_entry;
+        if (entry)
+        {
+            index->first_free_entry = entry->next;
+        }
+        else
+        {
+            entry = PushStruct(&index->arena, ReferenceEntry);
+        }
+
+        entry->atom   = FindReferenceAtom(index, atom, true);
+        entry->record = record;
+        entry->buffer = buffer->id;
+        DllInsertBack(&entry->atom->sentinel, entry);
+        entry->atom->count += 1;
+
+        entry->next_in_line = data->first_reference;
+        data->first_reference = entry;
+
+        index->entry_count += 1;
+    }
+}
+
+function void
+RemoveLineReferences(Buffer *buffer, LineIndexNode *record)
+{
+    LineData *data = &record->data;
+    if (!data->first_reference)
+    {
+        return;
+    }
+
+    Project *project = buffer->project;
+    ReferenceIndex *index = &project->references;
+
+    while (ReferenceEntry *entry = data->first_reference)
+    {
+        data->first_reference = entry->next_in_line;
+
+        DllRemove(entry);
+        entry->atom->count -= 1;
+
+        entry->next = index->first_free_entry;
+        index->first_free_entry = entry;
+
+        index->entry_count -= 1;
+    }
+}
+
+function void
+IndexBufferReferences(Buffer *buffer)
+{
+    if (buffer->references_indexed || !buffer->project || !IsBufferLoaded(buffer) || GetLineCount(buffer) == 0)
+    {
+        return;
+    }
+
+    buffer->references_indexed = true;
+    for (LineIndexIterator it = IterateLineIndex(buffer); IsValid(&it); Next(&it))
+    {
+        AddLineReferences(buffer, it.record, it.range.start);
+    }
+}
+
+function void
+RemoveBufferReferences(Buffer *buffer)
+{
+    if (!buffer->references_indexed)
+    {
+        return;
+    }
+
+    if (GetLineCount(buffer) > 0)
+    {
+        for (LineIndexIterator it = IterateLineIndex(buffer); IsValid(&it); Next(&it))
+        {
+            RemoveLineReferences(buffer, it.record);
+        }
+    }
+    buffer->references_indexed = false;
+}
+
+function ReferenceLocation *
+PushReferences(Arena *arena, Project *project, String name, size_t *out_count)
+{
+    ReferenceLocation *first = nullptr;
+    ReferenceLocation *last  = nullptr;
+    size_t count = 0;
+
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        if (it.buffer->project == project)
+        {
+            IndexBufferReferences(it.buffer);
+        }
+    }
+
+    uint64_t atom = GetReferenceAtom(name);
+
+    //
+    // Open buffers
+    //
+
+    if (ReferenceAtom *ref_atom = FindReferenceAtom(&project->references, atom, false))
+    {
+        for (ReferenceEntry *entry = ref_atom->sentinel.next; entry != &ref_atom->sentinel; entry = entry->next)
+        {
+            Buffer *buffer = GetBuffer(entry->buffer);
+
+            LineInfo info;
+            FindLineInfoByRecord(buffer, entry->record, &info);
+
+            for (LineReferenceIterator line_it = IterateLineReferences(info.data, info.range.start);
+                 IsValid(&line_it);
+                 Next(&line_it))
+            {
+                String token_string = MakeString(line_it.token->length, buffer->text + line_it.pos);
+                if (AreEqual(token_string, name))
+                {
+                    ReferenceLocation *location = PushStruct(arena, ReferenceLocation);
+                    location->buffer = buffer->id;
+                    location->pos    = line_it.pos;
+                    location->line   = info.line;
+                    SllQueuePush(first, last, location);
+                    count += 1;
+                }
+            }
+        }
+    }
+
+    //
+    // Files that aren't open, from the project index
+    //
+
+    IndexedFile *first_file = project->index.first_file;
+    READ_BARRIER;
+
+    for (IndexedFile *file = first_file; file; file = file->next)
+    {
+        if (IsIndexedFileOpen(file)) continue;
+
+        IndexedReference *references = file->references;
+
+        // NOTE: Binary search for the first reference with this atom
+        size_t lo = 0;
+        size_t hi = file->reference_count;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (references[mid].atom < atom)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+
+        for (size_t i = lo; i < file->reference_count && references[i].atom == atom; i += 1)
+        {
+            ReferenceLocation *location = PushStruct(arena, ReferenceLocation);
+            location->file = file;
+            location->pos  = references[i].pos;
+            location->line = references[i].line;
+            SllQueuePush(first, last, location);
+            count += 1;
+        }
+    }
+
+    if (out_count) *out_count = count;
+
+    return first;
+}
+
+//
+// Project Index
+//
+
+// NOTE: The scratch buffers are never registered with the editor, they're just somewhere
+// for the tokenizer and tag parser to do their work. Tags only get copied out into the
+// index, so memory use scales with the number of tags rather than the size of the source.
+function ProjectIndexScratch *
+AcquireScratch(ProjectIndex *index)
+{
+    ProjectIndexScratch *result = nullptr;
+    for (size_t i = 0; i < PROJECT_INDEX_SCRATCH_COUNT; i += 1)
+    {
+        ProjectIndexScratch *scratch = &index->scratch[i];
+        if (!scratch->in_use && AtomicCompareExchange(&scratch->in_use, 0, 1) == 0)
+        {
+            result = scratch;
+            break;
+        }
+    }
+    // NOTE: Each thread holds at most one slot at a time, see PROJECT_INDEX_SCRATCH_COUNT
+    Assert(result);
+
+    if (!result->buffer)
+    {
+        Buffer *scratch = BootstrapPushStruct(Buffer, arena);
+        scratch->language     = &language_registry->null_language;
+        scratch->indent_rules = &editor->default_indent_rules;
+        scratch->tags         = PushStruct(&scratch->arena, Tags);
+        DllInit(&scratch->tags->sentinel);
+        AllocateTextStorage(scratch, TEXTIT_BUFFER_SIZE);
+
+        result->buffer = scratch;
+    }
+
+    return result;
+}
+
+function void
+ReleaseScratch(ProjectIndexScratch *scratch)
+{
+    WRITE_BARRIER;
+    scratch->in_use = 0;
+}
+
+function void
+ResetScratchBuffer(Buffer *scratch)
+{
+    Tags *tags = scratch->tags;
+    while (DllHasNodes(&tags->sentinel))
+    {
+        Tag *tag = tags->sentinel.next;
+        DllRemove(tag);
+        FreeTag(scratch, tag);
+    }
+
+    ClearLineIndex(scratch);
+    scratch->count = 0;
+}
+
+function size_t
+GatherIndexedReferences(Buffer *buffer, IndexedReference *references)
+{
+    size_t result = 0;
+    if (GetLineCount(buffer) == 0)
+    {
+        return result;
+    }
+
+    for (LineIndexIterator line_it = IterateLineIndex(buffer); IsValid(&line_it); Next(&line_it))
+    {
+        for (LineReferenceIterator it = IterateLineReferences(&line_it.record->data, line_it.range.start);
+             IsValid(&it);
+             Next(&it))
+        {
+            if (references)
+            {
+                IndexedReference *reference = &references[result];
+                reference->atom = GetReferenceAtom(MakeString(it.token->length, buffer->text + it.pos));
+                reference->pos  = (int32_t)it.pos;
+                reference->line = (int32_t)line_it.line;
+            }
+            result += 1;
+        }
+    }
+
+    return result;
+}
+
+function void
+IndexFile(ProjectIndex *index, ProjectIndexScratch *index_scratch, String full_path, LanguageSpec *language)
+{
+    Buffer *scratch = index_scratch->buffer;
+    ResetScratchBuffer(scratch);
+
+    size_t file_size = platform->GetFileSize(full_path);
+    EnsureSpace(scratch, file_size + 1);
+    if (platform->ReadFileInto(TEXTIT_BUFFER_SIZE, scratch->text, full_path) != file_size)
+    {
+        return;
+    }
+    scratch->count    = (int64_t)file_size;
+    scratch->language = language;
+
+    TokenizeBuffer(scratch);
+    ParseTags(scratch);
+
+    Arena *arena = &index_scratch->arena;
+
+    size_t reference_count = GatherIndexedReferences(scratch, nullptr);
+    IndexedReference *references = PushArrayNoClear(arena, reference_count, IndexedReference);
+    GatherIndexedReferences(scratch, references);
+
+    // NOTE: A big file has more references than the sort's scratch copy would fit in the thread's temp arena,
+    // so it goes on the end of the scratch arena and is popped off again before the file gets pushed
+    Sort(arena, reference_count, references, +[](const IndexedReference &a, const IndexedReference &b) { return a.atom <= b.atom; });
+
+    IndexedFile *file = PushStruct(arena, IndexedFile);
+    file->full_path = PushString(arena, full_path);
+    file->path_hash = HashPath(file->full_path);
+    file->language  = language;
+    SplitPath(file->full_path, &file->name);
+
+    file->reference_count = reference_count;
+    file->references      = references;
+
+    Tags *tags = scratch->tags;
+    for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
+    {
+        file->tag_count += 1;
+    }
+
+    file->tags = PushArray(arena, file->tag_count, IndexedTag);
+
+    size_t tag_index = 0;
+    for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
+    {
+        IndexedTag *indexed = &file->tags[tag_index++];
+        indexed->file               = file;
+        indexed->related_token_kind = tag->related_token_kind;
+        indexed->kind               = tag->kind;
+        indexed->sub_kind           = tag->sub_kind;
+        indexed->length             = tag->length;
+        indexed->hash               = tag->hash;
+        indexed->name               = PushBufferRange(arena, scratch, MakeRangeStartLength(tag->pos, tag->length));
+        indexed->pos                = tag->pos;
+    }
+
+    // NOTE: Everything has to be written out before it becomes reachable from the main thread, and other
+    // indexing jobs might be linking in their files at the same time, so the links are swapped in atomically
+    WRITE_BARRIER;
+
+    for (size_t i = 0; i < file->tag_count; i += 1)
+    {
+        IndexedTag *indexed = &file->tags[i];
+
+        IndexedTag **slot = &index->tag_table[indexed->hash.u32[0] % PROJECT_TAG_TABLE_SIZE];
+        for (;;)
+        {
+            IndexedTag *next_in_hash = *slot;
+            indexed->next_in_hash = next_in_hash;
+            WRITE_BARRIER;
+            if (AtomicCompareExchange((void *volatile *)slot, next_in_hash, indexed) == next_in_hash)
+            {
+                break;
+            }
+        }
+    }
+
+    // NOTE: The file goes in the file table before the file list, so any file that can be reached
+    // from first_file can also be found by path
+    IndexedFile **file_slot = &index->file_table[file->path_hash % PROJECT_FILE_TABLE_SIZE];
+    for (;;)
+    {
+        IndexedFile *next_in_hash = *file_slot;
+        file->next_in_hash = next_in_hash;
+        WRITE_BARRIER;
+        if (AtomicCompareExchange((void *volatile *)file_slot, next_in_hash, file) == next_in_hash)
+        {
+            break;
+        }
+    }
+
+    for (;;)
+    {
+        IndexedFile *next = index->first_file;
+        file->next = next;
+        WRITE_BARRIER;
+        if (AtomicCompareExchange((void *volatile *)&index->first_file, next, file) == next)
+        {
+            break;
+        }
+    }
+
+    AtomicIncrement(&index->file_count);
+    AtomicAdd(&index->tag_count, (uint32_t)file->tag_count);
+}
+
+function
+FILE_WALKER_FILTER(IsProjectCodeFile)
+{
+    String ext;
+    SplitExtension(name, &ext);
+
+    return !!GetLanguageFromExtension(ext);
+}
+
+function
+FILE_WALKER_VISIT(IndexProjectFile)
+{
+    Project *project = (Project *)walker->userdata;
+    ProjectIndex *index = &project->index;
+
+    String name;
+    SplitPath(path, &name);
+
+    String ext;
+    SplitExtension(name, &ext);
+
+    ProjectIndexScratch *scratch = AcquireScratch(index);
+    IndexFile(index, scratch, path, GetLanguageFromExtension(ext));
+    ReleaseScratch(scratch);
+}
+
+function
+PLATFORM_JOB(FinishIndexingProjectJob)
+{
+    Project *project = (Project *)userdata;
+    ProjectIndex *index = &project->index;
+    FileWalker *walker = &index->walker;
+
+    index->index_time = platform->SecondsElapsed(walker->start_time, platform->GetTime());
+
+    if (!walker->cancel)
+    {
+        platform->LogPrint(PlatformLogLevel_Info, "Indexed %u tags from %u files (%u files in %u directories walked, %u ignored) in %fms, %.0f files/s",
+                           index->tag_count,
+                           index->file_count,
+                           walker->file_count,
+                           walker->directory_count,
+                           walker->ignored_count,
+                           1000.0*index->index_time,
+                           GetFileWalkFilesPerSecond(walker));
+    }
+
+    for (size_t i = 0; i < PROJECT_INDEX_SCRATCH_COUNT; i += 1)
+    {
+        ProjectIndexScratch *scratch = &index->scratch[i];
+        if (scratch->buffer)
+        {
+            platform->DeallocateMemory(scratch->buffer->text);
+            Release(&scratch->buffer->arena);
+            scratch->buffer = nullptr;
+        }
+    }
+
+    EndFileWalk(walker);
+
+    WRITE_BARRIER;
+    index->running = false;
+}
+
+function String
+GetProjectIgnorePatterns(Arena *arena, Project *project)
+{
+    ScopedMemory temp;
+
+    String result = {};
+
+    // NOTE: ConfigFromFile complains about files that don't exist, and most projects don't have a project.textit
+    String path = CombinePath(temp, project->root, "project.textit"_str);
+    if (platform->GetFileSize(path) > 0)
+    {
+        String patterns;
+        Config *cfg = ConfigFromFile(path, false);
+        if (cfg && ConfigReadStringRaw(cfg, "[project]/ignore"_str, &patterns))
+        {
+            result = PushString(arena, patterns);
+        }
+    }
+
+    return result;
+}
+
+function void
+BeginIndexingProject(Project *project)
+{
+    ProjectIndex *index = &project->index;
+    Assert(!index->running);
+
+    index->file_table = PushArray(&index->arena, PROJECT_FILE_TABLE_SIZE, IndexedFile *);
+    index->tag_table  = PushArray(&index->arena, PROJECT_TAG_TABLE_SIZE, IndexedTag *);
+    index->running    = true;
+
+    ScopedMemory temp;
+
+    FileWalker *walker = &index->walker;
+    walker->Filter   = IsProjectCodeFile;
+    walker->Visit    = IndexProjectFile;
+    walker->userdata = project;
+
+    BeginFileWalk(walker, platform->low_priority_queue, project->root, GetProjectIgnorePatterns(temp, project));
+    platform->AddJobAfter(platform->low_priority_queue, &walker->jobs, &index->done, project, FinishIndexingProjectJob);
+}
+
+function void
+StopIndexingProject(Project *project)
+{
+    ProjectIndex *index = &project->index;
+    if (index->running)
+    {
+        CancelFileWalk(&index->walker);
+        platform->WaitForJobGroup(&index->done);
+    }
+    Assert(!index->running);
+}
+
+function IndexedFile *
+FindIndexedFile(Project *project, String full_path)
+{
+    ProjectIndex *index = &project->index;
+    if (!index->file_table)
+    {
+        return nullptr;
+    }
+
+    uint64_t path_hash = HashPath(full_path);
+
+    IndexedFile *file = index->file_table[path_hash % PROJECT_FILE_TABLE_SIZE];
+    READ_BARRIER;
+
+    while (file)
+    {
+        if (file->path_hash == path_hash &&
+            PathsAreEqual(file->full_path, full_path))
+        {
+            break;
+        }
+
+        file = file->next_in_hash;
+        READ_BARRIER;
+    }
+
+    return file;
+}
+
+function bool
+IsIndexedFileOpen(IndexedFile *file)
+{
+    return !IsNullBuffer(GetBuffer(file->open_buffer));
+}
+
+function void
+SyncOpenIndexedFiles(Project *project)
+{
+    ProjectIndex *index = &project->index;
+
+    IndexedFile *first_file = index->first_file;
+    READ_BARRIER;
+
+    if (first_file == project->last_opened_indexed_file)
+    {
+        return;
+    }
+
+    // NOTE: Buffers that were opened before the indexer got to their file didn't find it in AssociateProject,
+    // so they get matched up again whenever new files come in
+    for (BufferIterator it = IterateBuffers(); IsValid(&it); Next(&it))
+    {
+        Buffer *buffer = it.buffer;
+        if (buffer->project != project) continue;
+
+        if (IndexedFile *file = FindIndexedFile(project, buffer->full_path))
+        {
+            file->open_buffer = buffer->id;
+        }
+    }
+
+    project->last_opened_indexed_file = first_file;
+}
+
+function IndexedTag *
+PushIndexedTagsWithName(Arena *arena, Project *project, String name)
+{
+    ProjectIndex *index = &project->index;
+
+    IndexedTag *result = nullptr;
+    if (!index->tag_table)
+    {
+        return result;
+    }
+
+    HashResult hash = HashString(name);
+
+    IndexedTag *tag = index->tag_table[hash.u32[0] % PROJECT_TAG_TABLE_SIZE];
+    READ_BARRIER;
+
+    while (tag)
+    {
+        // NOTE: Tags from files that are open as buffers are tracked by the buffer itself,
+        // and the index might be out of date for them.
+        if (tag->hash == hash &&
+            AreEqual(name, tag->name) &&
+            !IsIndexedFileOpen(tag->file))
+        {
+            IndexedTag *new_result = PushStruct(arena, IndexedTag);
+            CopyStruct(tag, new_result);
+            new_result->next_in_hash = nullptr;
+            SllStackPush(result, new_result);
+        }
+
+        tag = tag->next_in_hash;
+        READ_BARRIER;
+    }
+
+    return result;
+}
+
+function void
+SyncIndexedTagNames(Project *project)
+{
+    ProjectIndex *index = &project->index;
+
+    IndexedFile *first_file = index->first_file;
+    READ_BARRIER;
+
+    if (first_file == project->last_synced_indexed_file)
+    {
+        return;
+    }
+
+    // NOTE: files are prepended as they get indexed, so everything new sits before the last file we saw
+    BeginTagNameBatch(&project->tag_names);
+    for (IndexedFile *file = first_file; 
+         file && file != project->last_synced_indexed_file; 
+         file = file->next)
+    {
+        for (size_t i = 0; i < file->tag_count; i += 1)
+        {
+            IndexedTag *tag = &file->tags[i];
+            AddTagName(&project->tag_names, tag->hash, tag->name);
+        }
+    }
+    EndTagNameBatch(&project->tag_names);
+
+    project->last_synced_indexed_file = first_file;
+}
+
+function Tag
+MakeTag(IndexedTag *indexed)
+{
+    Tag result = {};
+    result.related_token_kind = indexed->related_token_kind;
+    result.kind               = indexed->kind;
+    result.sub_kind           = indexed->sub_kind;
+    result.length             = indexed->length;
+    result.hash               = indexed->hash;
+    result.pos                = indexed->pos;
+    return result;
+}
+
+function Buffer *
+OpenIndexedTag(IndexedTag *tag)
+{
+    Buffer *buffer = OpenBufferFromFile(tag->file->full_path);
+    return buffer;
 }
 
 //
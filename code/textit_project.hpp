@@ -8,14 +8,154 @@ enum ProjectFlags_ENUM : ProjectFlags
 };
 
 #define PROJECT_TAG_TABLE_SIZE 4096
+#define PROJECT_FILE_TABLE_SIZE 4096
+
+struct IndexedFile;
+
+struct IndexedTag
+{
+    IndexedTag *next;
+    IndexedTag *next_in_hash;
+
+    IndexedFile *file;
+
+    TokenKind related_token_kind;
+    TagKind kind;
+    TagSubKind sub_kind;
+    int16_t length;
+
+    HashResult hash;
+    String name;
+    int64_t pos;
+};
+
+// NOTE: One entry per identifier occurrence in a file that was indexed in the background,
+// sorted by atom so that all occurrences of a name can be found with a binary search.
+struct IndexedReference
+{
+    uint64_t atom;
+    int32_t  pos;
+    int32_t  line;
+};
+
+struct IndexedFile
+{
+    IndexedFile *next;
+    IndexedFile *next_in_hash;
+
+    String full_path;
+    String name;
+    LanguageSpec *language;
+
+    uint64_t path_hash;
+    BufferID open_buffer; // NOTE: only touched by the main thread, kept up to date as buffers open and close
+
+    size_t tag_count;
+    IndexedTag *tags;
+
+    size_t reference_count;
+    IndexedReference *references;
+};
+
+// NOTE: Indexing a file never waits on other jobs, so a thread can't be in the middle of more than
+// one at a time. The job system tops out at 32 threads including the main thread, so with twice
+// that many slots there's always one free and nobody has to wait for one.
+#define PROJECT_INDEX_SCRATCH_COUNT 64
+
+// NOTE: Every file being indexed at the same time needs somewhere to tokenize and parse it, and
+// somewhere to put the results. Slots are claimed by flipping in_use, so the indexing jobs don't
+// contend on a lock just to get going.
+struct ProjectIndexScratch
+{
+    volatile uint32_t in_use;
+    Buffer *buffer;
+    Arena arena; // NOTE: the indexed files and tags, lives as long as the index
+};
+
+// NOTE: The project index holds the tags of every code file under the project root, gathered
+// in the background without opening any buffers. It is append-only while the indexer runs:
+// files are indexed in parallel by the file walker's jobs, which link their finished entries
+// in with a compare exchange after a write barrier, so nobody has to take a lock to read it.
+struct ProjectIndex
+{
+    Arena arena;
+
+    volatile bool running;
+
+    FileWalker walker;
+    PlatformJobGroup done; // NOTE: finishes once the walk is over and the index has been wrapped up
+
+    ProjectIndexScratch scratch[PROJECT_INDEX_SCRATCH_COUNT];
+
+    volatile uint32_t file_count;
+    volatile uint32_t tag_count;
+
+    double index_time;
+
+    IndexedFile *volatile first_file;
+    IndexedFile **file_table; // NOTE: keyed on HashPath(full_path)
+    IndexedTag **tag_table;
+};
+
+//
+// References
+//
+
+#define PROJECT_REFERENCE_TABLE_SIZE 4096
+
+struct ReferenceAtom;
+
+// NOTE: A reference entry records that an identifier shows up (at least once) on a given line
+// of an open buffer. The entries hang off the line's LineData, so they get removed and re-added
+// alongside the line's tokens whenever it is retokenized, and the exact positions are recovered
+// by scanning the line's tokens when the references are queried.
+struct ReferenceEntry
+{
+    ReferenceEntry *next; // NOTE: next and prev link the entries for the same atom
+    ReferenceEntry *prev;
+    ReferenceEntry *next_in_line;
+
+    ReferenceAtom *atom;
+    LineIndexNode *record;
+    BufferID       buffer;
+};
+
+struct ReferenceAtom
+{
+    ReferenceAtom *next_in_hash;
+
+    uint64_t atom;
+    int64_t  count;
+
+    ReferenceEntry sentinel;
+};
+
+struct ReferenceIndex
+{
+    Arena arena;
+
+    ReferenceAtom **table;
+    ReferenceEntry *first_free_entry;
+
+    int64_t entry_count;
+};
+
+struct ReferenceLocation
+{
+    ReferenceLocation *next;
+
+    BufferID     buffer; // NOTE: set for references in open buffers
+    IndexedFile *file;   // NOTE: set for references in files that are only in the project index
+
+    int64_t pos;
+    int64_t line;
+};
 
 struct Project
 {
     Project *next;
     Project *prev;
 
-    bool opening;
-
     int associated_buffer_count;
     ProjectFlags flags;
 
@@ -25,9 +165,19 @@ struct Project
 
     size_t tag_table_size;
     Tag **tag_table;
+    uint32_t tag_generation; // NOTE: bumped whenever tags get added to or removed from tag_table
+
+    TagNameIndex tag_names;
+
+    ProjectIndex index;
+    IndexedFile *last_synced_indexed_file;
+    IndexedFile *last_opened_indexed_file;
+
+    ReferenceIndex references;
 };
 
 function void AssociateProject(Buffer *buffer);
+function void AddBufferTagsToProject(Buffer *buffer);
 function void RemoveProjectAssociation(Buffer *buffer);
 
 function Project *CreateProject(String search_start);
@@ -36,6 +186,23 @@ function void DestroyProject(Project *project);
 function Project *GetActiveProject();
 function Buffer *FindOrOpenBuffer(Project *project, String name);
 
+function void BeginIndexingProject(Project *project);
+function void StopIndexingProject(Project *project);
+function IndexedFile *FindIndexedFile(Project *project, String full_path);
+function bool IsIndexedFileOpen(IndexedFile *file);
+function void SyncOpenIndexedFiles(Project *project);
+function IndexedTag *PushIndexedTagsWithName(Arena *arena, Project *project, String name);
+function void SyncIndexedTagNames(Project *project);
+function Tag MakeTag(IndexedTag *indexed);
+function Buffer *OpenIndexedTag(IndexedTag *tag);
+
+function uint64_t GetReferenceAtom(String name);
+function void AddLineReferences(Buffer *buffer, LineIndexNode *record, int64_t line_start);
+function void RemoveLineReferences(Buffer *buffer, LineIndexNode *record);
+function void IndexBufferReferences(Buffer *buffer);
+function void RemoveBufferReferences(Buffer *buffer);
+function ReferenceLocation *PushReferences(Arena *arena, Project *project, String name, size_t *out_count = nullptr);
+
 struct ProjectIterator
 {
     Project *project;
@@ -1,24 +1,40 @@
 function void
-RebuildGlyphCache()
+ResetGlyphCache()
 {
-    uint32_t glyph_cache_size = 2048; 
-    uint32_t glyphs_per_row   = 32; // just so I can visualize easier I am putting this as a set width
-    uint32_t glyphs_per_col   = (glyph_cache_size + glyphs_per_row - 1) / glyphs_per_row;
+    uint32_t glyphs_per_row = 32; // just so I can visualize easier I am putting this as a set width
+    uint32_t glyphs_per_col = GLYPH_CACHE_ENTRIES_PER_PAGE / glyphs_per_row;
 
-    platform->DestroyOffscreenBuffer(&render_state->glyph_texture);
-    platform->CreateOffscreenBuffer((int)(glyphs_per_row*editor->font_max_glyph_size.x),
-                                    (int)(glyphs_per_col*editor->font_max_glyph_size.y),
-                                    &render_state->glyph_texture);
-    ResizeGlyphCache(&render_state->glyph_cache, glyph_cache_size);
+    for (size_t i = 0; i < ArrayCount(render_state->glyph_pages); i += 1)
+    {
+        if (render_state->glyph_pages[i].bitmap.data)
+        {
+            platform->DestroyOffscreenBuffer(&render_state->glyph_pages[i]);
+        }
+    }
 
     render_state->glyphs_per_row = glyphs_per_row;
     render_state->glyphs_per_col = glyphs_per_col;
+
+    V2i     glyph_size = editor->font_max_glyph_size;
+    int64_t page_bytes = (int64_t)sizeof(Color)*glyphs_per_row*glyph_size.x*glyphs_per_col*glyph_size.y;
+    int64_t max_bytes  = (int64_t)core_config->glyph_cache_max_megabytes*Megabytes(1);
+
+    uint32_t max_pages = (uint32_t)Clamp(max_bytes / page_bytes, (int64_t)1, (int64_t)GLYPH_CACHE_MAX_PAGES);
+    InitGlyphCache(&render_state->glyph_cache, GLYPH_CACHE_ENTRIES_PER_PAGE, max_pages);
+}
+
+function void
+RebuildGlyphCache()
+{
+    ResetGlyphCache();
+    LoadGlyphCacheFile();
 }
 
 function void
 InitializeRenderState(Arena *arena, Bitmap *target)
 {
     render_state->target = target;
+    render_state->blit_kernel_set = GetBestBlitKernelSet();
 
     render_state->cb_size = Megabytes(4); // random choice
     render_state->command_buffer = PushArrayNoClear(arena, render_state->cb_size, char);
@@ -121,17 +137,20 @@ ClearBitmap(Bitmap *bitmap)
 function void
 BlitRect(Bitmap *bitmap, Rect2i rect, Color color)
 {
+    BlitKernels *kernels = GetBlitKernels(render_state->blit_kernel_set);
+
     rect = Intersect(rect, MakeRect2iMinMax(MakeV2i(0, 0), MakeV2i(bitmap->w, bitmap->h)));
     for (int64_t y = rect.min.y; y < rect.max.y; ++y)
-    for (int64_t x = rect.min.x; x < rect.max.x; ++x)
     {
-        bitmap->data[y*bitmap->pitch + x] = color;
+        kernels->FillRow(bitmap->data + y*bitmap->pitch + rect.min.x, rect.max.x - rect.min.x, color);
     }
 }
 
 function void
 BlitBitmap(Bitmap *dest, Bitmap *source, V2i p)
 {
+    BlitKernels *kernels = GetBlitKernels(render_state->blit_kernel_set);
+
     int64_t source_min_x = Max(0, -p.x);
     int64_t source_min_y = Max(0, -p.y);
     int64_t source_max_x = Min(source->w, dest->w - p.x);
@@ -142,23 +161,20 @@ BlitBitmap(Bitmap *dest, Bitmap *source, V2i p)
     p = Clamp(p, MakeV2i(0, 0), MakeV2i(dest->w, dest->h));
 
     Color *source_row = source->data + source_min_y*source->pitch + source_min_x;
-    Color *dest_row = dest->data + p.y*dest->pitch + p.x;
+    Color *dest_row   = dest->data + p.y*dest->pitch + p.x;
     for (int64_t y = 0; y < source_adjusted_h; ++y)
     {
-        Color *source_pixel = source_row;
-        Color *dest_pixel = dest_row;
-        for (int64_t x = 0; x < source_adjusted_w; ++x)
-        {
-            *dest_pixel++ = *source_pixel++;
-        }
+        kernels->CopyRow(dest_row, source_row, source_adjusted_w);
         source_row += source->pitch;
-        dest_row += dest->pitch;
+        dest_row   += dest->pitch;
     }
 }
 
 function void
 BlitBitmapAlphaMasked(Bitmap *dest, Bitmap *source, V2i p)
 {
+    BlitKernels *kernels = GetBlitKernels(render_state->blit_kernel_set);
+
     int64_t source_min_x = Max(0, -p.x);
     int64_t source_min_y = Max(0, -p.y);
     int64_t source_max_x = Min(source->w, dest->w - p.x);
@@ -172,20 +188,7 @@ BlitBitmapAlphaMasked(Bitmap *dest, Bitmap *source, V2i p)
     Color *dest_row   = dest->data + p.y*dest->pitch + p.x;
     for (int64_t y = 0; y < source_adjusted_h; ++y)
     {
-        Color *source_pixel = source_row;
-        Color *dest_pixel   = dest_row;
-        for (int64_t x = 0; x < source_adjusted_w; ++x)
-        {
-            Color source_color = *source_pixel++;
-            if (source_color.a)
-            {
-                *dest_pixel++ = source_color;
-            }
-            else
-            {
-                dest_pixel++;
-            }
-        }
+        kernels->AlphaMaskedRow(dest_row, source_row, source_adjusted_w);
         source_row += source->pitch;
         dest_row   += dest->pitch;
     }
@@ -194,6 +197,8 @@ BlitBitmapAlphaMasked(Bitmap *dest, Bitmap *source, V2i p)
 function void
 BlitBitmapSubpixelBlend(Bitmap *dest, Bitmap *source, V2i p, Color blend_color)
 {
+    BlitKernels *kernels = GetBlitKernels(render_state->blit_kernel_set);
+
     int64_t source_min_x = Max(0, -p.x);
     int64_t source_min_y = Max(0, -p.y);
     int64_t source_max_x = Min(source->w, dest->w - p.x);
@@ -203,36 +208,11 @@ BlitBitmapSubpixelBlend(Bitmap *dest, Bitmap *source, V2i p, Color blend_color)
 
     p = Clamp(p, MakeV2i(0, 0), MakeV2i(dest->w, dest->h));
 
-    float blend_r = (1.0f / 255.0f)*blend_color.r;
-    float blend_g = (1.0f / 255.0f)*blend_color.g;
-    float blend_b = (1.0f / 255.0f)*blend_color.b;
-
     Color *source_row = source->data + source_min_y*source->pitch + source_min_x;
     Color *dest_row   = dest->data + p.y*dest->pitch + p.x;
     for (int64_t y = 0; y < source_adjusted_h; ++y)
     {
-        Color *source_pixel = source_row;
-        Color *dest_pixel   = dest_row;
-        for (int64_t x = 0; x < source_adjusted_w; ++x)
-        {
-            Color source_color = *source_pixel++;
-            Color dest_color   = *dest_pixel;
-
-            float source_r = 1.0f - (1.0f / 255.0f)*source_color.r;
-            float source_g = 1.0f - (1.0f / 255.0f)*source_color.g;
-            float source_b = 1.0f - (1.0f / 255.0f)*source_color.b;
-
-            float dest_r = (1.0f / 255.0f)*dest_color.r;
-            float dest_g = (1.0f / 255.0f)*dest_color.g;
-            float dest_b = (1.0f / 255.0f)*dest_color.b;
-
-            Color blend;
-            blend.r = (uint8_t)(255.0f*((1.0f - source_r)*dest_r + source_r*blend_r));
-            blend.g = (uint8_t)(255.0f*((1.0f - source_g)*dest_g + source_g*blend_g));
-            blend.b = (uint8_t)(255.0f*((1.0f - source_b)*dest_b + source_b*blend_b));
-
-            *dest_pixel++ = blend;
-        }
+        kernels->SubpixelBlendRow(dest_row, source_row, source_adjusted_w, blend_color);
         source_row += source->pitch;
         dest_row   += dest->pitch;
     }
@@ -241,6 +221,8 @@ BlitBitmapSubpixelBlend(Bitmap *dest, Bitmap *source, V2i p, Color blend_color)
 function void
 BlitBitmapMask(Bitmap *dest, Bitmap *source, V2i p, Color foreground, Color background)
 {
+    BlitKernels *kernels = GetBlitKernels(render_state->blit_kernel_set);
+
     int64_t source_min_x = Max(0, -p.x);
     int64_t source_min_y = Max(0, -p.y);
     int64_t source_max_x = Min(source->w, dest->w - p.x);
@@ -251,26 +233,12 @@ BlitBitmapMask(Bitmap *dest, Bitmap *source, V2i p, Color foreground, Color back
     p = Clamp(p, MakeV2i(0, 0), MakeV2i(dest->w, dest->h));
 
     Color *source_row = source->data + source_min_y*source->pitch + source_min_x;
-    Color *dest_row = dest->data + p.y*dest->pitch + p.x;
+    Color *dest_row   = dest->data + p.y*dest->pitch + p.x;
     for (int64_t y = 0; y < source_adjusted_h; ++y)
     {
-        Color *source_pixel = source_row;
-        Color *dest_pixel = dest_row;
-        for (int64_t x = 0; x < source_adjusted_w; ++x)
-        {
-            Color color = *source_pixel++;
-            if (color.a)
-            {
-                *dest_pixel = foreground;
-            }
-            else
-            {
-                *dest_pixel = background;
-            }
-            ++dest_pixel;
-        }
+        kernels->MaskRow(dest_row, source_row, source_adjusted_w, foreground, background);
         source_row += source->pitch;
-        dest_row += dest->pitch;
+        dest_row   += dest->pitch;
     }
 }
 
@@ -287,6 +255,199 @@ MakeBitmapView(Bitmap *source, Rect2i rect)
     return result;
 }
 
+// NOTE: Pages get their texture the first time an entry in them is looked at
+function PlatformOffscreenBuffer *
+GetGlyphCachePage(uint32_t index)
+{
+    uint32_t page_index = index / render_state->glyph_cache.entries_per_page;
+    Assert(page_index < ArrayCount(render_state->glyph_pages));
+
+    PlatformOffscreenBuffer *result = &render_state->glyph_pages[page_index];
+    if (!result->bitmap.data)
+    {
+        platform->CreateOffscreenBuffer((int)(render_state->glyphs_per_row*editor->font_max_glyph_size.x),
+                                        (int)(render_state->glyphs_per_col*editor->font_max_glyph_size.y),
+                                        result);
+    }
+    return result;
+}
+
+// NOTE: The rect in the entry's page
+function Rect2i
+GetGlyphCacheRect(uint32_t index)
+{
+    uint32_t slot = index % render_state->glyph_cache.entries_per_page;
+
+    V2i glyph_size = editor->font_max_glyph_size;
+    V2i glyph_p    = MakeV2i(glyph_size.x*(slot % render_state->glyphs_per_row),
+                             glyph_size.y*(slot / render_state->glyphs_per_row));
+    Rect2i result = MakeRect2iMinDim(glyph_p, glyph_size);
+    return result;
+}
+
+function Bitmap
+GetGlyphCacheBitmap(uint32_t index)
+{
+    PlatformOffscreenBuffer *page = GetGlyphCachePage(index);
+    Bitmap result = MakeBitmapView(&page->bitmap, GetGlyphCacheRect(index));
+    return result;
+}
+
+//
+// Glyph Cache File
+//
+
+// NOTE: Everything that changes what a glyph rasterizes to. The glyph hashes themselves only
+// cover the text, colors and style, so they're only meaningful against the same key.
+function uint64_t
+GetGlyphCacheFileKey()
+{
+    HashResult hash = HashIntegers(GLYPH_CACHE_FILE_VERSION, (uint64_t)editor->font_size);
+    hash = HashIntegers(hash, (uint64_t)editor->font_quality, (uint64_t)core_config->use_cached_cleartype_blend);
+    hash = HashIntegers(hash, (uint64_t)editor->font_max_glyph_size.x, (uint64_t)editor->font_max_glyph_size.y);
+    hash = HashString(hash, editor->font_name.as_string);
+    return hash.u64[0];
+}
+
+function String
+GetGlyphCacheFilePath(Arena *arena, uint64_t key)
+{
+    String file_name = PushTempStringF("glyph_cache_%016llX.bin", key);
+    String result = CombinePath(arena, platform->GetExeDirectory(), file_name);
+    return result;
+}
+
+function void
+SaveGlyphCacheFile()
+{
+    GlyphCache *cache = &render_state->glyph_cache;
+
+    if (!cache->size || !render_state->glyph_cache_dirty)
+    {
+        return;
+    }
+
+    ScopedMemory temp;
+
+    V2i      glyph_size       = editor->font_max_glyph_size;
+    size_t   pixels_per_glyph = (size_t)(glyph_size.x*glyph_size.y);
+    uint32_t filled_count     = GetEntryCount(cache, GlyphState_Filled);
+
+    size_t file_size = (sizeof(GlyphCacheFileHeader) +
+                        filled_count*sizeof(HashResult) +
+                        filled_count*pixels_per_glyph*sizeof(Color));
+    char *file = PushArrayNoClear(temp, file_size, char);
+
+    GlyphCacheFileHeader *header = (GlyphCacheFileHeader *)file;
+    HashResult           *hashes = (HashResult *)(header + 1);
+    Color                *pixels = (Color *)(hashes + filled_count);
+
+    ZeroStruct(header);
+    header->magic   = GLYPH_CACHE_FILE_MAGIC;
+    header->version = GLYPH_CACHE_FILE_VERSION;
+    header->key     = GetGlyphCacheFileKey();
+    header->glyph_w = (int32_t)glyph_size.x;
+    header->glyph_h = (int32_t)glyph_size.y;
+
+    // NOTE: Written oldest first, so that loading them back in order rebuilds the same LRU order
+    for (uint32_t index = cache->entries[0].next_lru; index; index = cache->entries[index].next_lru)
+    {
+        GlyphEntry *entry = &cache->entries[index];
+        if (entry->state != GlyphState_Filled)
+        {
+            continue;
+        }
+
+        CopyStruct(&entry->hash, &hashes[header->entry_count]);
+
+        Bitmap glyph = GetGlyphCacheBitmap(entry->index);
+        Color *dest  = pixels + header->entry_count*pixels_per_glyph;
+        for (int64_t y = 0; y < glyph_size.y; y += 1)
+        {
+            CopyArray(glyph_size.x, glyph.data + y*glyph.pitch, dest + y*glyph_size.x);
+        }
+
+        header->entry_count += 1;
+    }
+
+    String path = GetGlyphCacheFilePath(temp, header->key);
+    if (platform->WriteFile(file_size, file, path))
+    {
+        render_state->glyph_cache_dirty = false;
+    }
+    else
+    {
+        platform->LogPrint(PlatformLogLevel_Warning, "Failed to write glyph cache file '%.*s'", StringExpand(path));
+    }
+}
+
+function void
+LoadGlyphCacheFile()
+{
+    GlyphCache *cache = &render_state->glyph_cache;
+
+    render_state->glyph_cache_dirty = false;
+
+    ScopedMemory temp;
+
+    uint64_t key  = GetGlyphCacheFileKey();
+    String   path = GetGlyphCacheFilePath(temp, key);
+    String   file = platform->ReadFile(temp, path);
+
+    if (file.size < sizeof(GlyphCacheFileHeader))
+    {
+        return;
+    }
+
+    V2i    glyph_size       = editor->font_max_glyph_size;
+    size_t pixels_per_glyph = (size_t)(glyph_size.x*glyph_size.y);
+
+    GlyphCacheFileHeader *header = (GlyphCacheFileHeader *)file.data;
+    if (header->magic   != GLYPH_CACHE_FILE_MAGIC   ||
+        header->version != GLYPH_CACHE_FILE_VERSION ||
+        header->key     != key                      ||
+        header->glyph_w != glyph_size.x             ||
+        header->glyph_h != glyph_size.y)
+    {
+        return;
+    }
+
+    size_t expected_size = (sizeof(GlyphCacheFileHeader) +
+                            header->entry_count*sizeof(HashResult) +
+                            header->entry_count*pixels_per_glyph*sizeof(Color));
+    if (file.size != expected_size)
+    {
+        platform->LogPrint(PlatformLogLevel_Warning, "Glyph cache file '%.*s' is truncated, ignoring it", StringExpand(path));
+        return;
+    }
+
+    HashResult *hashes = (HashResult *)(header + 1);
+    Color      *pixels = (Color *)(hashes + header->entry_count);
+
+    // NOTE: Entry 0 is the sentinel. If the file holds more than fits, keep the most recently used.
+    uint32_t capacity = cache->max_size - 1;
+    uint32_t first    = (header->entry_count > capacity ? header->entry_count - capacity : 0);
+
+    for (uint32_t i = first; i < header->entry_count; i += 1)
+    {
+        HashResult hash;
+        CopyStruct(&hashes[i], &hash);
+
+        GlyphEntry *entry = GetGlyphEntry(cache, hash);
+
+        Bitmap glyph  = GetGlyphCacheBitmap(entry->index);
+        Color *source = pixels + i*pixels_per_glyph;
+        for (int64_t y = 0; y < glyph_size.y; y += 1)
+        {
+            CopyArray(glyph_size.x, source + y*glyph_size.x, glyph.data + y*glyph.pitch);
+        }
+
+        entry->state = GlyphState_Filled;
+    }
+
+    platform->LogPrint(PlatformLogLevel_Info, "Loaded %u glyphs from glyph cache file '%.*s'", header->entry_count - first, StringExpand(path));
+}
+
 function Rect2i
 GetGlyphRect(Font *font, Glyph glyph)
 {
@@ -327,8 +488,10 @@ RenderLine(Bitmap *bitmap, V2i start, V2i end, Color color)
 
     for (;;)
     {
-        V2i p = MakeV2i(x, y);
-        bitmap->data[y*bitmap->pitch + x] = color;
+        if (x >= 0 && y >= 0 && x < bitmap->w && y < bitmap->h)
+        {
+            bitmap->data[y*bitmap->pitch + x] = color;
+        }
 
         if (x == x1 && y == y1)
         {
@@ -405,9 +568,18 @@ HashRenderCommandInternal(RenderCommand *command, View *view, Rect2i overlapping
 
     for (int64_t line = min_line; line < max_line; line += 1)
     {
+        // NOTE: Hash positions relative to the line, so a line that just moved up or down
+        // still hashes the same and ScrollViewByBlit can find it
+        int64_t line_y = view->viewport.min.y + line;
+
+        RenderCommand relative = to_hash;
+        relative.p.y        -= line_y;
+        relative.rect.min.y -= line_y;
+        relative.rect.max.y -= line_y;
+
         HashResult hash = {};
         hash.u64[0] = view->line_hashes[line];
-        hash = HashData(hash, sizeof(to_hash), &to_hash);
+        hash = HashData(hash, sizeof(relative), &relative);
         hash = HashString(hash, command->utf8);
         view->line_hashes[line] = hash.u64[0];
     }
@@ -455,6 +627,7 @@ PushTile(V2i tile_p, Sprite sprite, TextStyleFlags flags = 0)
     RenderCommand *command = PushRenderCommand(RenderCommand_Sprite);
     command->p          = tile_p;
     command->font       = editor->fonts[flags];
+    command->font_style = flags;
     command->glyph      = sprite.glyph;
     command->foreground = sprite.foreground;
     command->background = sprite.background;
@@ -469,6 +642,7 @@ PushUnicode(V2i tile_p, String utf8, Color foreground, Color background, TextSty
     RenderCommand *command = PushRenderCommand(RenderCommand_Unicode);
     command->p          = tile_p;
     command->font       = editor->fonts[flags];
+    command->font_style = flags;
     command->utf8       = utf8;
     command->foreground = foreground;
     command->background = background;
@@ -568,6 +742,8 @@ BeginRender(void)
     render_state->cb_command_at = 0;
     render_state->cb_sort_key_at = render_state->cb_size;
 
+    RollGlyphCacheStats(&render_state->glyph_cache);
+
     render_state->clip_rect_count = 0;
     Rect2i clip_rect = render_state->viewport;
     clip_rect.max.x += 1;
@@ -657,13 +833,409 @@ RasterizeTextCachedCleartypeBlend(PlatformOffscreenBuffer *buffer, Rect2i rect,
     }
 }
 
+//
+// Blit Benchmark
+//
+
+enum BlitBenchmarkMode
+{
+    BlitBenchmark_AlphaMasked,
+    BlitBenchmark_SubpixelBlend,
+    BlitBenchmark_Mask,
+    BlitBenchmark_Rect,
+    BlitBenchmark_Bitmap,
+    BlitBenchmark_COUNT,
+};
+
+static const char *blit_benchmark_mode_names[BlitBenchmark_COUNT] =
+{
+    "AlphaMasked",
+    "SubpixelBlend",
+    "Mask",
+    "Rect",
+    "Bitmap",
+};
+
+// NOTE: Blits a full screen of glyphs that are already in the glyph cache into an offscreen
+// bitmap with every kernel set this CPU supports, and logs the throughput. Nothing gets presented.
+function void
+RunBlitBenchmark(int passes)
+{
+    ScopedMemory temp;
+
+    Bitmap *target = render_state->target;
+    Bitmap dest = PushBitmap(temp, target->w, target->h);
+
+    V2i metrics = editor->font_metrics;
+    V2i glyph_size = editor->font_max_glyph_size;
+
+    GlyphCache *cache = &render_state->glyph_cache;
+
+    uint32_t *glyphs = PushArray(temp, cache->size, uint32_t);
+    uint32_t glyph_count = 0;
+    for (uint32_t i = 1; i < cache->size; i += 1)
+    {
+        if (cache->entries[i].state == GlyphState_Filled)
+        {
+            glyphs[glyph_count++] = i;
+        }
+    }
+
+    if (!glyph_count)
+    {
+        // still measures the blits, just on an empty cell
+        glyphs[glyph_count++] = 1;
+    }
+
+    int64_t cells_x = target->w / metrics.x;
+    int64_t cells_y = target->h / metrics.y;
+
+    int64_t pixels_per_pass = 0;
+    for (int64_t y = 0; y < cells_y; y += 1)
+    for (int64_t x = 0; x < cells_x; x += 1)
+    {
+        Rect2i rect = Intersect(MakeRect2iMinDim(MakeV2i(x, y)*metrics, glyph_size), 0, 0, target->w, target->h);
+        pixels_per_pass += GetWidth(rect)*GetHeight(rect);
+    }
+
+    platform->LogPrint(PlatformLogLevel_Info, "Blit benchmark: %dx%d target, %lld glyphs per pass (%u distinct), %d passes",
+                       target->w, target->h, cells_x*cells_y, glyph_count, passes);
+
+    BlitKernelSet old_set  = render_state->blit_kernel_set;
+    BlitKernelSet best_set = GetBestBlitKernelSet();
+
+    for (int set = 0; set <= best_set; set += 1)
+    {
+        render_state->blit_kernel_set = (BlitKernelSet)set;
+
+        for (int mode = 0; mode < BlitBenchmark_COUNT; mode += 1)
+        {
+            PlatformHighResTime start = platform->GetTime();
+
+            for (int pass = 0; pass < passes; pass += 1)
+            {
+                uint32_t glyph_at = 0;
+                for (int64_t y = 0; y < cells_y; y += 1)
+                for (int64_t x = 0; x < cells_x; x += 1)
+                {
+                    uint32_t index = glyphs[glyph_at];
+                    glyph_at = (glyph_at + 1 < glyph_count ? glyph_at + 1 : 0);
+
+                    Bitmap glyph_bitmap = GetGlyphCacheBitmap(index);
+
+                    V2i p = MakeV2i(x, y)*metrics;
+                    switch (mode)
+                    {
+                        case BlitBenchmark_AlphaMasked:   BlitBitmapAlphaMasked(&dest, &glyph_bitmap, p); break;
+                        case BlitBenchmark_SubpixelBlend: BlitBitmapSubpixelBlend(&dest, &glyph_bitmap, p, COLOR_WHITE); break;
+                        case BlitBenchmark_Mask:          BlitBitmapMask(&dest, &glyph_bitmap, p, COLOR_WHITE, COLOR_BLACK); break;
+                        case BlitBenchmark_Rect:          BlitRect(&dest, MakeRect2iMinDim(p, glyph_size), COLOR_WHITE); break;
+                        case BlitBenchmark_Bitmap:        BlitBitmap(&dest, &glyph_bitmap, p); break;
+                    }
+                }
+            }
+
+            double seconds = platform->SecondsElapsed(start, platform->GetTime());
+            double pixels_per_second = (double)(pixels_per_pass*passes) / (seconds > 0.0 ? seconds : 1.0e-9);
+
+            platform->LogPrint(PlatformLogLevel_Info, "    %-6.*s %-13s %9.1f Mpx/s",
+                               StringExpand(GetBlitKernels((BlitKernelSet)set)->name),
+                               blit_benchmark_mode_names[mode],
+                               pixels_per_second / 1.0e6);
+        }
+    }
+
+    render_state->blit_kernel_set = old_set;
+}
+
+function void
+RasterizeItems(Bitmap *target, Rect2i band, uint32_t item_count, uint32_t *items, RasterItem *item_data)
+{
+    for (uint32_t i = 0; i < item_count; i += 1)
+    {
+        RasterItem *item = &item_data[items[i]];
+
+        Rect2i clip = Intersect(item->clip, band);
+        if (clip.min.x >= clip.max.x || clip.min.y >= clip.max.y)
+        {
+            continue;
+        }
+
+        Bitmap dest   = MakeBitmapView(target, clip);
+        Rect2i rect   = Offset(item->rect, item->clip.min - clip.min);
+
+        switch (item->kind)
+        {
+            case RasterItem_Glyph:
+            {
+                Bitmap glyph_bitmap = MakeBitmapView(item->bitmap, item->source);
+                if (item->cached_cleartype)
+                {
+                    BlitBitmapAlphaMasked(&dest, &glyph_bitmap, rect.min);
+                }
+                else
+                {
+                    BlitBitmapSubpixelBlend(&dest, &glyph_bitmap, rect.min, item->color);
+                }
+            } break;
+
+            case RasterItem_Rect:
+            {
+                BlitRect(&dest, rect, item->color);
+            } break;
+
+            case RasterItem_Bitmap:
+            {
+                BlitBitmap(&dest, item->bitmap, rect.min);
+            } break;
+
+            case RasterItem_Line:
+            {
+                RenderLine(&dest, rect.min, rect.max, item->color);
+            } break;
+        }
+    }
+}
+
+function PLATFORM_JOB(RasterizeBandJob)
+{
+    TimedFunction;
+
+    RenderBand *band = (RenderBand *)userdata;
+    RasterizeItems(band->target, band->rect, band->item_count, band->items, band->item_data);
+}
+
+// NOTE: Splits the target into horizontal bands and draws them in parallel. Every band gets the
+// items touching it in command order, so layering within a band is the same as drawing serially.
+function void
+FlushRasterItems(uint32_t item_count, RasterItem *item_data)
+{
+    TimedFunction;
+
+    if (!item_count)
+    {
+        return;
+    }
+
+    Bitmap *target = render_state->target;
+
+    int64_t band_h = (target->h + RENDER_BAND_COUNT - 1) / RENDER_BAND_COUNT;
+    band_h = editor->font_metrics.y*((band_h + editor->font_metrics.y - 1) / editor->font_metrics.y);
+    if (band_h <= 0)
+    {
+        return;
+    }
+
+    int band_count = (int)((target->h + band_h - 1) / band_h);
+    Assert(band_count <= RENDER_BAND_COUNT);
+
+    RenderBand *bands = PushArray(render_state->arena, band_count, RenderBand);
+    for (int band_index = 0; band_index < band_count; band_index += 1)
+    {
+        RenderBand *band = &bands[band_index];
+        band->target    = target;
+        band->rect      = MakeRect2iMinMax(0, band_index*band_h, target->w, Min((band_index + 1)*band_h, (int64_t)target->h));
+        band->item_data = item_data;
+    }
+
+    // count, then fill
+    for (uint32_t i = 0; i < item_count; i += 1)
+    {
+        RasterItem *item = &item_data[i];
+
+        int64_t first_band = Clamp(item->bounds.min.y / band_h,       0, band_count - 1);
+        int64_t last_band  = Clamp((item->bounds.max.y - 1) / band_h, 0, band_count - 1);
+        for (int64_t band_index = first_band; band_index <= last_band; band_index += 1)
+        {
+            bands[band_index].item_count += 1;
+        }
+    }
+
+    for (int band_index = 0; band_index < band_count; band_index += 1)
+    {
+        RenderBand *band = &bands[band_index];
+        band->items      = PushArrayNoClear(render_state->arena, band->item_count, uint32_t);
+        band->item_count = 0;
+    }
+
+    for (uint32_t i = 0; i < item_count; i += 1)
+    {
+        RasterItem *item = &item_data[i];
+
+        int64_t first_band = Clamp(item->bounds.min.y / band_h,       0, band_count - 1);
+        int64_t last_band  = Clamp((item->bounds.max.y - 1) / band_h, 0, band_count - 1);
+        for (int64_t band_index = first_band; band_index <= last_band; band_index += 1)
+        {
+            RenderBand *band = &bands[band_index];
+            band->items[band->item_count++] = i;
+        }
+    }
+
+    if (item_count < RENDER_MIN_ITEMS_FOR_JOBS)
+    {
+        // not worth waking up the job threads for
+        for (int band_index = 0; band_index < band_count; band_index += 1)
+        {
+            RasterizeBandJob(&bands[band_index]);
+        }
+    }
+    else
+    {
+        // NOTE: Buffer loads and file walks share the high priority queue, so the bands get their own
+        // group to avoid waiting for any of those to finish before the frame can go out
+        PlatformJobGroup band_jobs = {};
+        for (int band_index = 0; band_index < band_count; band_index += 1)
+        {
+            if (bands[band_index].item_count)
+            {
+                platform->AddJobToGroup(platform->high_priority_queue, &band_jobs, &bands[band_index], RasterizeBandJob);
+            }
+        }
+        platform->WaitForJobGroup(&band_jobs);
+    }
+}
+
+//
+// Scroll By Blit
+//
+
+// NOTE: When a view scrolls, every line hash changes even though most of the lines are still on
+// screen, just somewhere else. This looks for the shift that lines up the most lines with what was
+// drawn last frame, moves those pixels into place in the backbuffer and fixes up prev_line_hashes
+// to describe what's on screen now, so only the lines that actually changed get redrawn.
+function void
+ScrollViewByBlit(View *view)
+{
+    int64_t line_count = GetHeight(view->viewport);
+    uint64_t *line_hashes      = view->line_hashes;
+    uint64_t *prev_line_hashes = view->prev_line_hashes;
+
+    int64_t best_shift   = 0;
+    int64_t best_matches = 0;
+    for (int64_t line = 0; line < line_count; line += 1)
+    {
+        if (line_hashes[line] == prev_line_hashes[line])
+        {
+            best_matches += 1;
+        }
+    }
+
+    if (2*best_matches >= line_count)
+    {
+        // mostly unchanged in place, nothing to gain
+        return;
+    }
+
+    for (int64_t shift = -(line_count - 1); shift < line_count; shift += 1)
+    {
+        int64_t first_line = Max(0, -shift);
+        int64_t last_line  = Min(line_count, line_count - shift);
+        if (shift == 0 || last_line - first_line <= best_matches)
+        {
+            continue;
+        }
+
+        int64_t matches = 0;
+        for (int64_t line = first_line; line < last_line; line += 1)
+        {
+            if (line_hashes[line] == prev_line_hashes[line + shift])
+            {
+                matches += 1;
+            }
+        }
+
+        if (matches > best_matches)
+        {
+            best_shift   = shift;
+            best_matches = matches;
+        }
+    }
+
+    if (!best_shift)
+    {
+        return;
+    }
+
+    //
+    // Move the pixels
+    //
+
+    Bitmap *target = render_state->target;
+    V2i metrics = editor->font_metrics;
+
+    Rect2i pixel_rect = Intersect(Scale(view->viewport, metrics), 0, 0, target->w, target->h);
+    int64_t row_width = GetWidth(pixel_rect);
+    if (row_width <= 0)
+    {
+        return;
+    }
+
+    int64_t first_line = Max(0, -best_shift);
+    int64_t last_line  = Min(line_count, line_count - best_shift);
+
+    int64_t min_y = Max(pixel_rect.min.y + first_line*metrics.y, pixel_rect.min.y);
+    int64_t max_y = Min(pixel_rect.min.y + last_line*metrics.y,  pixel_rect.max.y);
+
+    int64_t shift_y = best_shift*metrics.y;
+    min_y = Max(min_y, pixel_rect.min.y - shift_y);
+    max_y = Min(max_y, pixel_rect.max.y - shift_y);
+
+    if (best_shift > 0)
+    {
+        for (int64_t y = min_y; y < max_y; y += 1)
+        {
+            Color *dest   = target->data + y*target->pitch + pixel_rect.min.x;
+            Color *source = dest + shift_y*target->pitch;
+            CopyArray(row_width, source, dest);
+        }
+    }
+    else
+    {
+        for (int64_t y = max_y - 1; y >= min_y; y -= 1)
+        {
+            Color *dest   = target->data + y*target->pitch + pixel_rect.min.x;
+            Color *source = dest + shift_y*target->pitch;
+            CopyArray(row_width, source, dest);
+        }
+    }
+
+    //
+    // Describe what's on screen now
+    //
+
+    uint64_t *shifted_hashes = PushArrayNoClear(render_state->arena, line_count, uint64_t);
+    for (int64_t line = 0; line < line_count; line += 1)
+    {
+        int64_t source_line = line + best_shift;
+        if (source_line >= 0 && source_line < line_count)
+        {
+            shifted_hashes[line] = prev_line_hashes[source_line];
+        }
+        else
+        {
+            // nothing got moved here, make sure it gets drawn
+            shifted_hashes[line] = ~line_hashes[line];
+        }
+    }
+    CopyArray(line_count, shifted_hashes, prev_line_hashes);
+}
+
 function void
 RenderCommandsToBitmap(void)
 {
+    TimedFunction;
+
     uint32_t sort_key_count = (render_state->cb_size - render_state->cb_sort_key_at) / sizeof(RenderSortKey);
     RenderSortKey *sort_keys = (RenderSortKey *)(render_state->command_buffer + render_state->cb_sort_key_at);
     RenderSortKey *sort_scratch = PushArrayNoClear(render_state->arena, sort_key_count, RenderSortKey);
-    RadixSort(sort_key_count, &sort_keys->u32, &sort_scratch->u32);
+
+    {
+        TimedBlock("RadixSort");
+
+        PlatformHighResTime sort_start = platform->GetTime();
+        RadixSort(sort_key_count, &sort_keys->u32, &sort_scratch->u32);
+        platform->frame_timings.sort = platform->SecondsElapsed(sort_start, platform->GetTime());
+    }
 
 #if TEXTIT_SLOW
     for (size_t i = 1; i < sort_key_count; ++i)
@@ -672,8 +1244,33 @@ RenderCommandsToBitmap(void)
     }
 #endif
 
+    for (size_t i = 0; i < render_state->clip_rect_count; i += 1)
+    {
+        RenderClipRect *clip_rect = render_state->clip_rects[i];
+        if (!clip_rect->view)
+        {
+            continue;
+        }
+
+        // NOTE: A view can have more than one clip rect, only shift it once
+        bool already_shifted = false;
+        for (size_t j = 0; j < i; j += 1)
+        {
+            if (render_state->clip_rects[j]->view == clip_rect->view)
+            {
+                already_shifted = true;
+                break;
+            }
+        }
+
+        if (!already_shifted)
+        {
+            ScrollViewByBlit(GetView(clip_rect->view));
+        }
+    }
+
     V2i metrics = editor->font_metrics;
-    int32_t glyphs_per_row = render_state->glyphs_per_row;
+    V2i glyph_size = editor->font_max_glyph_size;
 
     int glyph_fills = 0;
 
@@ -683,8 +1280,23 @@ RenderCommandsToBitmap(void)
     int64_t        line_count        = 0;
     uint64_t       *line_hashes      = nullptr;
     uint64_t       *prev_line_hashes = nullptr;
+    V2i            clip_offset       = {};
 
-    Bitmap target = *render_state->target;
+    //
+    // Resolve the commands into raster items. Anything that touches the glyph cache or rasterizes
+    // text through the platform happens here, serially, so the band jobs only ever read the glyph
+    // texture.
+    //
+
+    GlyphCache *glyph_cache = &render_state->glyph_cache;
+
+    RasterItem *items = PushArrayNoClear(render_state->arena, sort_key_count, RasterItem);
+    uint32_t item_count = 0;
+
+    // NOTE: If a batch references more distinct glyphs than fit in the cache, entries queued up
+    // earlier in the batch could get evicted before they're drawn, so the batch gets flushed first.
+    render_state->raster_batch += 1;
+    uint32_t batch_glyph_count = 0;
 
     RenderSortKey *end = (RenderSortKey *)(render_state->command_buffer + render_state->cb_size);
     for (RenderSortKey *at = sort_keys; at < end; at += 1)
@@ -704,7 +1316,7 @@ RenderCommandsToBitmap(void)
             line_hashes      = view->line_hashes;
             prev_line_hashes = view->prev_line_hashes;
 
-            target = MakeBitmapView(render_state->target, clip_rect->rect);
+            clip_offset = MakeV2i(-clip_rect->rect.min.x, -clip_rect->rect.min.y);
         }
 
         if (clip_rect->view)
@@ -731,6 +1343,8 @@ RenderCommandsToBitmap(void)
             }
         }
 
+        RasterItem *item = nullptr;
+
         switch (command->kind)
         {
             case RenderCommand_Sprite:
@@ -744,9 +1358,6 @@ RenderCommandsToBitmap(void)
 
                     PlatformFontHandle font = command->font;
 
-                    glyph_rect.min -= clip_rect->rect.min;
-                    glyph_rect.max -= clip_rect->rect.min;
-
                     if (text.size == 1 && text.data[0] == ' ')
                     {
                         // nothing lol
@@ -758,38 +1369,55 @@ RenderCommandsToBitmap(void)
                         {
                             hash = HashIntegers(command->foreground.u32, command->background.u32);
                         }
-                        hash = HashIntegers(hash, (uint64_t)font);
+                        // NOTE: The style rather than the font handle, so the hash means the same thing
+                        // across runs and the glyph cache file stays valid
+                        hash = HashIntegers(hash, (uint64_t)command->font_style);
                         hash = HashString(hash, text);
 
-                        GlyphEntry *entry = GetGlyphEntry(&render_state->glyph_cache, hash);
+                        if (batch_glyph_count + 1 >= glyph_cache->max_size)
+                        {
+                            FlushRasterItems(item_count, items);
+                            item_count = 0;
+
+                            render_state->raster_batch += 1;
+                            batch_glyph_count = 0;
+                        }
+
+                        GlyphEntry *entry = GetGlyphEntry(glyph_cache, hash);
+                        if (entry->last_used_batch != render_state->raster_batch)
+                        {
+                            entry->last_used_batch = render_state->raster_batch;
+                            batch_glyph_count += 1;
+                        }
 
-                        V2i glyph_p = MakeV2i(editor->font_max_glyph_size.x*(entry->index % glyphs_per_row),
-                                              editor->font_max_glyph_size.y*(entry->index / glyphs_per_row));
+                        PlatformOffscreenBuffer *page = GetGlyphCachePage(entry->index);
 
-                        Rect2i rasterize_rect = MakeRect2iMinDim(glyph_p, editor->font_max_glyph_size);
-                        Bitmap glyph_bitmap = MakeBitmapView(&render_state->glyph_texture.bitmap, rasterize_rect);
+                        Rect2i rasterize_rect = GetGlyphCacheRect(entry->index);
                         if (entry->state == GlyphState_Empty)
                         {
                             if (core_config->use_cached_cleartype_blend)
                             {
-                                RasterizeTextCachedCleartypeBlend(&render_state->glyph_texture, rasterize_rect, font, text, command->foreground, command->background);
+                                RasterizeTextCachedCleartypeBlend(page, rasterize_rect, font, text, command->foreground, command->background);
                             }
                             else
                             {
-                                BlitRect(&render_state->glyph_texture.bitmap, rasterize_rect, COLOR_WHITE);
-                                RasterizeText(&render_state->glyph_texture, rasterize_rect, font, text, COLOR_BLACK, COLOR_WHITE);
+                                BlitRect(&page->bitmap, rasterize_rect, COLOR_WHITE);
+                                RasterizeText(page, rasterize_rect, font, text, COLOR_BLACK, COLOR_WHITE);
                             }
                             entry->state = GlyphState_Filled;
                             glyph_fills += 1;
+
+                            render_state->glyph_cache_dirty = true;
                         }
-                        if (core_config->use_cached_cleartype_blend)
-                        {
-                            BlitBitmapAlphaMasked(&target, &glyph_bitmap, glyph_rect.min);
-                        }
-                        else
-                        {
-                            BlitBitmapSubpixelBlend(&target, &glyph_bitmap, glyph_rect.min, command->foreground);
-                        }
+
+                        item = &items[item_count++];
+                        item->kind             = RasterItem_Glyph;
+                        item->cached_cleartype = core_config->use_cached_cleartype_blend;
+                        item->color            = command->foreground;
+                        item->bounds           = MakeRect2iMinDim(glyph_rect.min, glyph_size);
+                        item->rect             = Offset(glyph_rect, clip_offset);
+                        item->source           = rasterize_rect;
+                        item->bitmap           = &page->bitmap;
                     }
                 }
             } break;
@@ -803,10 +1431,11 @@ RenderCommandsToBitmap(void)
 
                 if (RectanglesOverlap(clip_rect->rect, rect))
                 {
-                    rect.min -= clip_rect->rect.min;
-                    rect.max -= clip_rect->rect.min;
-
-                    BlitRect(&target, rect, command->foreground);
+                    item = &items[item_count++];
+                    item->kind   = RasterItem_Rect;
+                    item->color  = command->foreground;
+                    item->bounds = rect;
+                    item->rect   = Offset(rect, clip_offset);
                 }
             } break;
 
@@ -816,10 +1445,11 @@ RenderCommandsToBitmap(void)
 
                 if (RectanglesOverlap(clip_rect->rect, rect))
                 {
-                    rect.min -= clip_rect->rect.min;
-                    rect.max -= clip_rect->rect.min;
-
-                    BlitBitmap(&target, command->bitmap, p);
+                    item = &items[item_count++];
+                    item->kind   = RasterItem_Bitmap;
+                    item->bitmap = command->bitmap;
+                    item->bounds = MakeRect2iMinDim(clip_rect->rect.min + p, MakeV2i(command->bitmap->w, command->bitmap->h));
+                    item->rect   = MakeRect2iMinDim(p, MakeV2i(command->bitmap->w, command->bitmap->h));
                 }
             } break;
 
@@ -834,15 +1464,42 @@ RenderCommandsToBitmap(void)
                     rect.min *= metrics;
                     rect.max *= metrics;
 
-                    RenderLine(&target, rect.min, rect.max, command->foreground);
+                    V2i start = clip_rect->rect.min + rect.min;
+                    V2i end   = clip_rect->rect.min + rect.max;
+
+                    item = &items[item_count++];
+                    item->kind   = RasterItem_Line;
+                    item->color  = command->foreground;
+                    item->bounds = MakeRect2iMinMax(Min(start, end), Max(start, end) + MakeV2i(1, 1));
+                    item->rect   = rect;
                 }
             } break;
         }
+
+        if (item)
+        {
+            item->clip   = clip_rect->rect;
+            item->bounds = Intersect(item->bounds, clip_rect->rect);
+            if (item->bounds.min.x >= item->bounds.max.x ||
+                item->bounds.min.y >= item->bounds.max.y)
+            {
+                item_count -= 1;
+            }
+        }
     }
+
+    FlushRasterItems(item_count, items);
 }
 
 static void
 EndRender(void)
 {
+    TimedFunction;
+
+    PlatformHighResTime start = platform->GetTime();
     RenderCommandsToBitmap();
+
+    // NOTE: Everything that isn't sorting the render commands counts as rasterization
+    double total = platform->SecondsElapsed(start, platform->GetTime());
+    platform->frame_timings.rasterize = total - platform->frame_timings.sort;
 }
@@ -163,6 +163,7 @@ struct RenderCommand
 
     bool cached_cleartype;
     PlatformFontHandle font;
+    TextStyleFlags font_style;
 
     String utf8;
     Glyph glyph;
@@ -175,6 +176,62 @@ struct RenderClipRect
     Rect2i rect;
 };
 
+#define RENDER_BAND_COUNT 16
+#define RENDER_MIN_ITEMS_FOR_JOBS 512
+
+enum RasterItemKind : uint16_t
+{
+    RasterItem_Glyph,
+    RasterItem_Rect,
+    RasterItem_Bitmap,
+    RasterItem_Line,
+};
+
+// NOTE: A render command after culling and glyph cache lookup, so it can be drawn by any thread
+// without touching anything but the glyph texture. rect is relative to the clip rect (or holds the
+// start and end points for lines), bounds is the screen space area it can touch.
+struct RasterItem
+{
+    RasterItemKind kind;
+    bool cached_cleartype;
+
+    Color color;
+
+    Rect2i clip;
+    Rect2i bounds;
+    Rect2i rect;
+    Rect2i source;
+
+    Bitmap *bitmap; // the glyph cache page for glyphs
+};
+
+struct RenderBand
+{
+    Bitmap *target;
+    Rect2i rect;
+
+    RasterItem *item_data;
+    uint32_t item_count;
+    uint32_t *items;
+};
+
+#define GLYPH_CACHE_FILE_MAGIC   0x46434754 // "TGCF"
+#define GLYPH_CACHE_FILE_VERSION 1
+
+struct GlyphCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    int32_t  glyph_w, glyph_h;
+    uint32_t entry_count;
+    uint32_t pad;
+
+    // followed by:
+    // HashResult hashes[entry_count];
+    // Color      pixels[entry_count][glyph_h][glyph_w];
+};
+
 struct RenderState
 {
     int arena_index;
@@ -182,10 +239,14 @@ struct RenderState
     Arena *arena;
 
     Bitmap *target;
+    BlitKernelSet blit_kernel_set;
 
     GlyphCache glyph_cache;
-    uint32_t glyphs_per_row, glyphs_per_col;
-    PlatformOffscreenBuffer glyph_texture;
+    uint32_t raster_batch;
+    uint32_t glyphs_per_row, glyphs_per_col; // per page
+    PlatformOffscreenBuffer glyph_pages[GLYPH_CACHE_MAX_PAGES];
+
+    bool glyph_cache_dirty;
 
     RenderLayer current_layer;
 
@@ -209,6 +270,8 @@ struct RenderState
 };
 GLOBAL_STATE(RenderState, render_state);
 
+function void SaveGlyphCacheFile();
+function void LoadGlyphCacheFile();
 function uint16_t PushClipRect(Rect2i rect, ViewID view = {});
 
 struct ScopedClipRect
@@ -59,10 +59,9 @@ SetMemory(size_t size, void *data_init, char value)
 #if COMPILER_MSVC
     __stosb(data, value, size);
 #else
-    size_t size = size_init;
     while (size--)
     {
-        *data++ = 0;
+        *data++ = (unsigned char)value;
     }
 #endif
 }
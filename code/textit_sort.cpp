@@ -38,15 +38,29 @@ MergeSortInternal(size_t count, T *a, T *b, SortComparator<T> comparator)
 
 template <typename T>
 function void
-MergeSort(size_t count, T *a, SortComparator<T> comparator)
+MergeSort(Arena *arena, size_t count, T *a, SortComparator<T> comparator)
 {
-    ScopedMemory temp;
+    ScopedMemory temp(arena);
     T *b = PushArrayNoClear(temp, count, T);
 
     CopyArray(count, a, b);
     MergeSortInternal(count, a, b, comparator);
 }
 
+template <typename T>
+function void
+MergeSort(size_t count, T *a, SortComparator<T> comparator)
+{
+    MergeSort(platform->GetTempArena(), count, a, comparator);
+}
+
+template <typename T>
+function void
+Sort(Arena *arena, size_t count, T *a, SortComparator<T> comparator)
+{
+    MergeSort(arena, count, a, comparator);
+}
+
 template <typename T>
 function void
 Sort(size_t count, T *a, SortComparator<T> comparator)
@@ -127,3 +141,75 @@ RadixSort(size_t count, SortKey *data, SortKey *temp)
         Swap(dest, source);
     }
 }
+
+//
+// TopK
+//
+
+function TopK
+MakeTopK(Arena *arena, uint32_t capacity)
+{
+    TopK result = {};
+    result.capacity = capacity;
+    result.heap     = PushArrayNoClear(arena, capacity, SortKey);
+    return result;
+}
+
+function void
+SiftDown(TopK *top_k, uint32_t at)
+{
+    SortKey *heap = top_k->heap;
+    for (;;)
+    {
+        uint32_t largest = at;
+        uint32_t l = 2*at + 1;
+        uint32_t r = 2*at + 2;
+        if (l < top_k->count && heap[l].key > heap[largest].key) largest = l;
+        if (r < top_k->count && heap[r].key > heap[largest].key) largest = r;
+        if (largest == at) break;
+        Swap(heap[at], heap[largest]);
+        at = largest;
+    }
+}
+
+function bool
+Push(TopK *top_k, uint32_t key, uint32_t index)
+{
+    SortKey *heap = top_k->heap;
+
+    if (top_k->count < top_k->capacity)
+    {
+        uint32_t at = top_k->count++;
+        heap[at].key   = key;
+        heap[at].index = index;
+
+        while (at > 0)
+        {
+            uint32_t parent = (at - 1) / 2;
+            if (heap[parent].key >= heap[at].key) break;
+            Swap(heap[parent], heap[at]);
+            at = parent;
+        }
+        return true;
+    }
+    else if (top_k->capacity > 0 && key < heap[0].key)
+    {
+        heap[0].key   = key;
+        heap[0].index = index;
+        SiftDown(top_k, 0);
+        return true;
+    }
+
+    return false;
+}
+
+function Slice<SortKey>
+SortTopK(TopK *top_k)
+{
+    ScopedMemory temp;
+    SortKey *temp_keys = PushArrayNoClear(temp, top_k->count, SortKey);
+    RadixSort(top_k->count, top_k->heap, temp_keys);
+
+    Slice<SortKey> result = MakeSlice(top_k->count, top_k->heap);
+    return result;
+}
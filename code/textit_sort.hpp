@@ -10,15 +10,29 @@ struct SortKey
 template <typename T>
 using SortComparator = bool (*)(const T &a, const T &b);
 
-// general purpose sort 
+// general purpose sort, scratch space comes from the thread's temp arena unless an arena is passed in
 template <typename T> function void Sort(size_t count, T *data, SortComparator<T> comparator);
+template <typename T> function void Sort(Arena *arena, size_t count, T *data, SortComparator<T> comparator);
 
 // merge sort
 template <typename T> function void MergeSortInternal(size_t count, T *a, T *b, SortComparator<T> comparator);
 template <typename T> function void MergeSort(size_t count, T *data, SortComparator<T> comparator);
+template <typename T> function void MergeSort(Arena *arena, size_t count, T *data, SortComparator<T> comparator);
 
 // radix sort
 function void RadixSort(size_t count, uint32_t *data, uint32_t *temp);
 function void RadixSort(size_t count, SortKey *data, SortKey *temp);
 
+// bounded top-k selection, keeps the `capacity` entries with the lowest keys
+struct TopK
+{
+    uint32_t capacity;
+    uint32_t count;
+    SortKey *heap; // max-heap, so the worst entry that made the cut is at the top
+};
+
+function TopK MakeTopK(Arena *arena, uint32_t capacity);
+function bool Push(TopK *top_k, uint32_t key, uint32_t index);
+function Slice<SortKey> SortTopK(TopK *top_k);
+
 #endif /* TEXTIT_SORT_HPP */
@@ -289,6 +289,28 @@ PathsAreEqual(String a, String b, StringMatchFlags flags = StringMatch_CaseInsen
     return result;
 }
 
+// NOTE: Hashes a path the way PathsAreEqual compares them, so paths that compare equal hash the same
+function uint64_t
+HashPath(String path)
+{
+    HashResult result = {};
+
+    char chunk[256];
+    for (size_t start = 0; start < path.size; start += sizeof(chunk))
+    {
+        size_t count = Min(sizeof(chunk), path.size - start);
+        for (size_t i = 0; i < count; i += 1)
+        {
+            char c = ToLowerAscii(path.data[start + i]);
+            if (c == '\\') c = '/';
+            chunk[i] = c;
+        }
+        result = HashData(result, count, chunk);
+    }
+
+    return result.u64[0];
+}
+
 function String
 SplitExtension(String string, String *right)
 {
@@ -613,7 +635,7 @@ SplitAroundChar(String string, uint8_t c, String *rhs = nullptr)
 }
 
 function bool
-MatchPrefix(String string, String prefix, StringMatchFlags flags = 0)
+MatchPrefix(String string, String prefix, StringMatchFlags flags)
 {
     if (prefix.size > string.size) return false;
     if (string.size > prefix.size) string.size = prefix.size;
@@ -705,6 +727,136 @@ FindSubstringBackward(String text, String pattern, StringMatchFlags flags = 0)
     return text.size;
 }
 
+function size_t
+FindByteCaseInsensitive(String text, size_t start, uint8_t c)
+{
+    uint8_t lower = ToLowerAscii(c);
+    uint8_t upper = ToUpperAscii(c);
+
+    __m128i lower_wide = _mm_set1_epi8((char)lower);
+    __m128i upper_wide = _mm_set1_epi8((char)upper);
+
+    size_t i = start;
+    for (; i + 16 <= text.size; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((__m128i *)(text.data + i));
+        __m128i match = _mm_or_si128(_mm_cmpeq_epi8(chunk, lower_wide),
+                                     _mm_cmpeq_epi8(chunk, upper_wide));
+
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(match);
+        if (mask)
+        {
+            return i + FindLeastSignificantSetBit(mask).index;
+        }
+    }
+
+    for (; i < text.size; i += 1)
+    {
+        if (ToLowerAscii(text.data[i]) == lower)
+        {
+            return i;
+        }
+    }
+
+    return text.size;
+}
+
+function bool
+IsWordStart(String text, size_t pos)
+{
+    if (pos == 0) return true;
+
+    uint8_t prev = text.data[pos - 1];
+    uint8_t curr = text.data[pos];
+    if (!IsAlphanumericAscii(prev)) return true;
+    if (IsAlphabeticAscii(prev) && prev == ToLowerAscii(prev) && curr != ToLowerAscii(curr)) return true; // camelCase hump
+    return false;
+}
+
+// NOTE: Case insensitive subsequence match. Returns 0 if the pattern doesn't match, otherwise a score
+// that is higher for better matches: runs of consecutive characters and characters at the start of
+// words are rewarded, gaps between matched characters are penalized.
+function int
+FuzzyMatch(String text, String pattern)
+{
+    if (pattern.size == 0) return 1;
+    if (pattern.size > text.size) return 0;
+
+    // forward pass: find the earliest position at which the whole pattern has matched
+    size_t end = 0;
+    for (size_t i = 0; i < pattern.size; i += 1)
+    {
+        end = FindByteCaseInsensitive(text, end, pattern.data[i]);
+        if (end == text.size)
+        {
+            return 0;
+        }
+        end += 1;
+    }
+
+    // backward pass: from there, find the latest start so we score the tightest window
+    size_t start = end;
+    for (size_t i = pattern.size; i > 0; i -= 1)
+    {
+        uint8_t c = ToLowerAscii(pattern.data[i - 1]);
+        do
+        {
+            start -= 1;
+        }
+        while (ToLowerAscii(text.data[start]) != c);
+    }
+
+    int score = 0;
+    int run   = 0;
+
+    size_t prev = start;
+    size_t at   = start;
+    for (size_t i = 0; i < pattern.size; i += 1)
+    {
+        at = FindByteCaseInsensitive(text, at, pattern.data[i]);
+
+        score += 16;
+
+        if (i > 0 && at == prev + 1)
+        {
+            run   += 1;
+            score += 8*run;
+        }
+        else
+        {
+            run = 0;
+            if (i > 0) score -= 2*(int)Min(at - prev - 1, (size_t)8);
+        }
+
+        if (IsWordStart(text, at))
+        {
+            score += 24;
+        }
+
+        if (text.data[at] == pattern.data[i])
+        {
+            score += 1;
+        }
+
+        prev = at;
+        at  += 1;
+    }
+
+    score -= (int)Min(start, (size_t)16);
+    score -= (int)Min(text.size - pattern.size, (size_t)32) / 4;
+
+    if (score < 1) score = 1;
+
+    return score;
+}
+
+// NOTE: For sorting fuzzy matches in ascending order, best match first
+function uint32_t
+FuzzyMatchSortKey(int score)
+{
+    return (uint32_t)(INT32_MAX - score);
+}
+
 function int
 CalculateEditDistance(String s, String t)
 {
@@ -39,4 +39,8 @@ enum LineEndKind
     LineEnd_CRLF,
 };
 
+// NOTE: Declared up front for FindMember, templates need their non-dependent calls declared
+// before use on anything but MSVC
+function bool MatchPrefix(String string, String prefix, StringMatchFlags flags = 0);
+
 #endif /* TEXTIT_STRING_HPP */
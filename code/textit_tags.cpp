@@ -43,14 +43,25 @@ AddTagInternal(Buffer *buffer, String name)
     HashResult hash = HashString(name);
     result->hash = hash;
 
-    if (!project->opening)
+    // NOTE: buffers without a project (like the project indexer's scratch buffer) keep their tags to themselves,
+    // and buffers still loading get theirs linked in by the app thread once they're done
+    if (project && IsBufferLoaded(buffer))
     {
         Tag **slot = &project->tag_table[hash.u32[0] % PROJECT_TAG_TABLE_SIZE];
         result->next_in_hash = *slot;
         *slot = result;
+
+        AddTagName(&project->tag_names, hash, name);
+
+        if (!tags->reparsing) project->tag_generation += 1;
     }
 
     DllInsertBack(&tags->sentinel, result);
+    if (!tags->reparsing)
+    {
+        tags->generation += 1;
+        tags->key = HashResult{};
+    }
 
     result->buffer = buffer->id;
 
@@ -74,20 +85,49 @@ FreeAllTags(Buffer *buffer)
 {
     Project *project = buffer->project;
 
+    // NOTE: Freed back to front, so a reparse that finds the same tags gets the same Tag structs back in
+    // the same order and anything pointing at them stays good
     Tags *tags = buffer->tags;
     while (DllHasNodes(&tags->sentinel))
     {
-        Tag *tag = tags->sentinel.next;
+        Tag *tag = tags->sentinel.prev;
+
+        if (project && IsBufferLoaded(buffer))
+        {
+            Tag **slot = GetTagSlot(project, tag);
+            Assert(*slot == tag);
+            *slot = tag->next_in_hash;
+
+            RemoveTagName(&project->tag_names, tag->hash);
 
-        Tag **slot = GetTagSlot(project, tag);
-        Assert(*slot == tag);
-        *slot = tag->next_in_hash;
+            if (!tags->reparsing) project->tag_generation += 1;
+        }
 
         DllRemove(tag);
         tag->next = tag->prev = nullptr;
 
         FreeTag(buffer, tag);
+
+        if (!tags->reparsing)
+        {
+            tags->generation += 1;
+            tags->key = HashResult{};
+        }
+    }
+}
+
+function HashResult
+GetTagsKey(Tags *tags)
+{
+    // NOTE: Seeded with something, so the key is never zero, which is what a Tags that got changed outside
+    // of a reparse has
+    HashResult result = HashIntegers((uint64_t)1);
+    for (Tag *tag = tags->sentinel.next; tag != &tags->sentinel; tag = tag->next)
+    {
+        result = HashIntegers(result, tag->hash.u64[0], tag->hash.u64[1]);
+        result = HashIntegers(result, (uint32_t)tag->kind, (uint32_t)tag->sub_kind, (uint32_t)tag->related_token_kind, (uint32_t)(tag->parent != nullptr));
     }
+    return result;
 }
 
 function Tag *
@@ -123,6 +163,285 @@ PushTagsWithName(Arena *arena, Project *project, String name)
     return result;
 }
 
+//
+// Tag Name Index
+//
+
+function int
+CompareTagNames(String a, String b)
+{
+    size_t count = Min(a.size, b.size);
+    for (size_t i = 0; i < count; i += 1)
+    {
+        uint8_t ca = ToLowerAscii(a.data[i]);
+        uint8_t cb = ToLowerAscii(b.data[i]);
+        if (ca != cb)
+        {
+            return (ca < cb ? -1 : 1);
+        }
+    }
+    if (a.size != b.size)
+    {
+        return (a.size < b.size ? -1 : 1);
+    }
+    // NOTE: break ties between names that only differ in case so the order is stable
+    return memcmp(a.data, b.data, a.size);
+}
+
+function size_t
+FindTagNameInsertionPoint(TagNameIndex *index, String name)
+{
+    size_t lo = 0;
+    size_t hi = (index->batching ? index->batch_start : index->sorted_count);
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (CompareTagNames(index->sorted[mid]->name, name) < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+function TagName **
+GetTagNameSlot(TagNameIndex *index, HashResult hash)
+{
+    TagName **result = &index->table[hash.u32[0] % TAG_NAME_TABLE_SIZE];
+    while (*result && !((*result)->hash == hash))
+    {
+        result = &(*result)->next_in_hash;
+    }
+    return result;
+}
+
+function void
+EnsureTagNameCapacity(TagNameIndex *index, size_t count)
+{
+    if (count > index->sorted_capacity)
+    {
+        size_t new_capacity = (index->sorted_capacity ? 2*index->sorted_capacity : 256);
+        if (new_capacity < count) new_capacity = count;
+
+        TagName **new_sorted = (TagName **)SizeClassAlloc(index->heap, new_capacity*sizeof(TagName *));
+        if (index->sorted)
+        {
+            CopyArray(index->sorted_count, index->sorted, new_sorted);
+            SizeClassFree(index->heap, index->sorted);
+        }
+
+        index->sorted          = new_sorted;
+        index->sorted_capacity = new_capacity;
+    }
+}
+
+function void
+AddTagName(TagNameIndex *index, HashResult hash, String name)
+{
+    if (!index->table)
+    {
+        index->table = PushArray(&index->arena, TAG_NAME_TABLE_SIZE, TagName *);
+        index->heap  = CreateSizeClassHeap(LOCATION_STRING("Tag Index Heap"));
+    }
+
+    TagName **slot = GetTagNameSlot(index, hash);
+    if (TagName *existing = *slot)
+    {
+        if (existing->ref_count == 0)
+        {
+            Assert(index->batching);
+            index->dead_count -= 1;
+        }
+        existing->ref_count += 1;
+        return;
+    }
+
+    if (!index->first_free_name)
+    {
+        index->first_free_name = PushStructNoClear(&index->arena, TagName);
+        index->first_free_name->next_in_hash = nullptr;
+    }
+    TagName *entry = index->first_free_name;
+    index->first_free_name = entry->next_in_hash;
+
+    ZeroStruct(entry);
+    entry->hash      = hash;
+    entry->ref_count = 1;
+    entry->name      = MakeString(name.size, (uint8_t *)SizeClassAlloc(index->heap, name.size));
+    CopySize(name.size, name.data, entry->name.data);
+
+    *slot = entry;
+
+    EnsureTagNameCapacity(index, index->sorted_count + 1);
+
+    if (index->batching)
+    {
+        index->sorted[index->sorted_count++] = entry;
+    }
+    else
+    {
+        size_t insert_at = FindTagNameInsertionPoint(index, entry->name);
+        MoveArray(index->sorted + insert_at, index->sorted + index->sorted_count, index->sorted + insert_at + 1);
+        index->sorted[insert_at] = entry;
+        index->sorted_count += 1;
+    }
+}
+
+function void
+FreeTagName(TagNameIndex *index, TagName *entry)
+{
+    SizeClassFree(index->heap, entry->name.data);
+    entry->name = {};
+
+    entry->next_in_hash = index->first_free_name;
+    index->first_free_name = entry;
+}
+
+function void
+BeginTagNameBatch(TagNameIndex *index)
+{
+    Assert(!index->batching);
+    index->batching    = true;
+    index->batch_start = index->sorted_count;
+}
+
+function void
+EndTagNameBatch(TagNameIndex *index)
+{
+    Assert(index->batching);
+    index->batching = false;
+
+    size_t old_count = index->batch_start;
+
+    if (index->dead_count > 0)
+    {
+        size_t kept_count     = 0;
+        size_t kept_old_count = 0;
+        for (size_t i = 0; i < index->sorted_count; i += 1)
+        {
+            TagName *entry = index->sorted[i];
+            if (entry->ref_count > 0)
+            {
+                index->sorted[kept_count++] = entry;
+                if (i < old_count) kept_old_count += 1;
+            }
+            else
+            {
+                *GetTagNameSlot(index, entry->hash) = entry->next_in_hash;
+                FreeTagName(index, entry);
+            }
+        }
+        index->sorted_count = kept_count;
+        index->dead_count   = 0;
+        old_count           = kept_old_count;
+    }
+
+    size_t new_count = index->sorted_count - old_count;
+    if (new_count == 0)
+    {
+        return;
+    }
+
+    TagName **names   = index->sorted;
+    TagName **added   = names + old_count;
+    TagName **scratch = (TagName **)SizeClassAlloc(index->heap, new_count*sizeof(TagName *));
+
+    // NOTE: The merge sort wants both arrays to start out with the same contents, and leaves the sorted
+    // result in the first one
+    CopyArray(new_count, added, scratch);
+    MergeSortInternal<TagName *>(new_count, scratch, added, [](TagName *const &a, TagName *const &b)
+    {
+        return CompareTagNames(a->name, b->name) < 0;
+    });
+
+    // NOTE: Merge from the back, so the names that were already there can stay where they are until
+    // they get moved to their final spot
+    size_t old_at = old_count;
+    size_t new_at = new_count;
+    size_t out_at = old_count + new_count;
+    while (new_at > 0)
+    {
+        if (old_at > 0 && CompareTagNames(names[old_at - 1]->name, scratch[new_at - 1]->name) > 0)
+        {
+            names[--out_at] = names[--old_at];
+        }
+        else
+        {
+            names[--out_at] = scratch[--new_at];
+        }
+    }
+
+    SizeClassFree(index->heap, scratch);
+}
+
+function void
+RemoveTagName(TagNameIndex *index, HashResult hash)
+{
+    if (!index->table) return;
+
+    TagName **slot = GetTagNameSlot(index, hash);
+    TagName *entry = *slot;
+    if (!entry) return;
+
+    entry->ref_count -= 1;
+    if (entry->ref_count <= 0)
+    {
+        if (index->batching)
+        {
+            // NOTE: It might come right back before the batch is over, if not it gets swept out at the end
+            index->dead_count += 1;
+            return;
+        }
+
+        size_t remove_at = FindTagNameInsertionPoint(index, entry->name);
+        Assert(index->sorted[remove_at] == entry);
+
+        MoveArray(index->sorted + remove_at + 1, index->sorted + index->sorted_count, index->sorted + remove_at);
+        index->sorted_count -= 1;
+
+        *slot = entry->next_in_hash;
+        FreeTagName(index, entry);
+    }
+}
+
+function Slice<TagName *>
+FindTagNamesWithPrefix(TagNameIndex *index, String prefix)
+{
+    Assert(!index->batching);
+
+    Slice<TagName *> result = {};
+
+    size_t first = FindTagNameInsertionPoint(index, prefix);
+
+    size_t last = first;
+    while (last < index->sorted_count &&
+           MatchPrefix(index->sorted[last]->name, prefix, StringMatch_CaseInsensitive))
+    {
+        last += 1;
+    }
+
+    result.data  = index->sorted + first;
+    result.count = last - first;
+
+    return result;
+}
+
+function void
+ReleaseTagNameIndex(TagNameIndex *index)
+{
+    // NOTE: The sorted array comes from the heap, so it goes with it
+    if (index->heap)
+    {
+        DestroySizeClassHeap(index->heap);
+    }
+    Release(&index->arena);
+    ZeroStruct(index);
+}
+
 //
 // Tag Parser
 //
@@ -315,11 +634,40 @@ ConsumeUpToAndIncluding(TagParser *parser, TokenKind kind)
 function void
 ParseTags(Buffer *buffer)
 {
+    TimedFunction;
+
+    Tags *tags = buffer->tags;
+    Project *project = buffer->project;
+
+    // NOTE: Tags only go into the project once the buffer is loaded, see AddTagInternal
+    bool in_project = (project && IsBufferLoaded(buffer));
+
+    // NOTE: Every edit reparses the whole buffer, which mostly hands back the tags that were already
+    // there, so the names are batched and nobody gets told unless something actually changed
+    tags->reparsing = true;
+    if (in_project) BeginTagNameBatch(&project->tag_names);
+
+    // NOTE: The tag parsers walk the tokens through the line index, which an empty buffer doesn't have
     LanguageSpec *lang = buffer->language;
-    if (lang->ParseTags)
+    if (GetLineCount(buffer) == 0)
+    {
+        FreeAllTags(buffer);
+    }
+    else if (lang->ParseTags)
     {
         lang->ParseTags(buffer);
     }
+
+    if (in_project) EndTagNameBatch(&project->tag_names);
+    tags->reparsing = false;
+
+    HashResult key = GetTagsKey(tags);
+    if (!(key == tags->key))
+    {
+        tags->key = key;
+        tags->generation += 1;
+        if (in_project) project->tag_generation += 1;
+    }
 }
 
 function void
@@ -34,8 +34,57 @@ struct Tag
 struct Tags
 {
     Tag sentinel;
+    uint32_t generation; // NOTE: bumped whenever the tags change, for anything holding on to Tag pointers
+
+    // NOTE: A reparse mostly hands back the tags that were already there, in the same Tag structs, so
+    // the generations only get bumped if the names and kinds it came up with hash differently
+    bool reparsing;
+    HashResult key;
+};
+
+struct TagName
+{
+    TagName *next_in_hash;
+
+    HashResult hash;
+    String name;
+
+    int32_t ref_count;
 };
 
+#define TAG_NAME_TABLE_SIZE 4096
+
+// NOTE: Every distinct tag name in a project, reference counted by the tags using it and kept
+// sorted case insensitively, so that completion can find all names starting with a prefix with
+// a binary search instead of walking every tag. Adding lots of names at once (like all the tags of
+// freshly indexed files) should happen in a batch: new names get appended as they come and are
+// sorted and merged in with one pass at the end, rather than each being inserted on its own.
+// Names that lose their last reference during a batch stay put until the end, so a reparse that
+// removes and re-adds the same names doesn't touch the sorted array at all.
+struct TagNameIndex
+{
+    Arena arena;
+    SizeClassHeap *heap;
+
+    TagName *first_free_name;
+    TagName **table;
+
+    bool batching;
+    size_t batch_start; // NOTE: everything past this was added during the batch and isn't sorted yet
+    size_t dead_count;  // NOTE: names that dropped to no references during the batch
+
+    size_t sorted_count;
+    size_t sorted_capacity;
+    TagName **sorted;
+};
+
+function void AddTagName(TagNameIndex *index, HashResult hash, String name);
+function void BeginTagNameBatch(TagNameIndex *index);
+function void EndTagNameBatch(TagNameIndex *index);
+function void RemoveTagName(TagNameIndex *index, HashResult hash);
+function Slice<TagName *> FindTagNamesWithPrefix(TagNameIndex *index, String prefix);
+function void ReleaseTagNameIndex(TagNameIndex *index);
+
 function void ParseTags(Buffer *buffer);
 function void FreeAllTags(Buffer *buffer);
 function Tag *PushTagsWithName(Arena *arena, Project *project, String name);
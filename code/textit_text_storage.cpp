@@ -8,6 +8,31 @@ AllocateTextStorage(TextStorage *storage, int64_t capacity)
     storage->text = (uint8_t *)platform->ReserveMemory((int64_t)storage->capacity, 0, LOCATION_STRING("text storage"));
 }
 
+function void
+UpdateMemoryStats(TextStorage *storage)
+{
+    PlatformMemoryStats *stats = platform->GetMemoryStats(storage->text);
+    stats->committed = (size_t)storage->committed;
+    stats->used      = (size_t)storage->count;
+}
+
+function void
+TrimTextStorage(TextStorage *storage)
+{
+    int64_t page_size = (int64_t)platform->page_size;
+    int64_t keep = AlignPow2(storage->count + TEXT_STORAGE_DECOMMIT_SLACK, page_size);
+    if (storage->committed >= keep + TEXT_STORAGE_DECOMMIT_THRESHOLD)
+    {
+        int64_t decommit_size = storage->committed - keep;
+        platform->DecommitMemory(storage->text + keep, (size_t)decommit_size);
+        storage->committed = keep;
+
+        PlatformMemoryStats *stats = platform->GetMemoryStats(storage->text);
+        stats->decommit_count += 1;
+        stats->decommitted    += (size_t)decommit_size;
+    }
+}
+
 function void
 EnsureSpace(TextStorage *storage, int64_t append_size)
 {
@@ -19,21 +44,21 @@ EnsureSpace(TextStorage *storage, int64_t append_size)
         platform->CommitMemory(storage->text + storage->committed, to_commit);
         storage->committed += to_commit;
         Assert(storage->committed >= (storage->count + append_size));
+
+        UpdateMemoryStats(storage);
     }
 }
 
 function int64_t
 TextStorageReplaceRange(TextStorage *storage, Range range, String text)
 {
-    range = ClampRange(range, MakeRange(0, storage->count));
+    TimedFunction;
 
-    PlatformHighResTime start = platform->GetTime();
+    range = ClampRange(range, MakeRange(0, storage->count));
 
     int64_t delta = range.start - range.end + (int64_t)text.size;
     EnsureSpace(storage, delta);
-    // TODO: Decommit behaviour
 
-    int64_t total_moved = 0;
     if (delta != 0)
     {
         uint8_t *source = (delta > 0
@@ -43,9 +68,14 @@ TextStorageReplaceRange(TextStorage *storage, Range range, String text)
         uint8_t *end    = storage->text + storage->count;
         memmove(dest, source, end - source);
 
-        total_moved = end - source;
-
         storage->count += delta;
+
+        if (delta < 0)
+        {
+            TrimTextStorage(storage);
+        }
+
+        UpdateMemoryStats(storage);
     }
     memcpy(storage->text + range.start, text.data, text.size);
 
@@ -55,11 +85,5 @@ TextStorageReplaceRange(TextStorage *storage, Range range, String text)
         edit_end += delta;
     }
 
-    PlatformHighResTime end = platform->GetTime();
-    if (total_moved != 0 || text.size != 0)
-    {
-        editor->debug.buffer_edit_timing += platform->SecondsElapsed(start, end);
-    }
-
     return edit_end;
 }
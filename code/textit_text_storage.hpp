@@ -1,6 +1,12 @@
 #ifndef TEXTIT_TEXT_STORAGE_HPP
 #define TEXTIT_TEXT_STORAGE_HPP
 
+// NOTE: Once more than TEXT_STORAGE_DECOMMIT_THRESHOLD past the end of the text is committed, everything
+// but TEXT_STORAGE_DECOMMIT_SLACK of it is decommitted again. The gap between the two keeps edits
+// around the boundary from committing and decommitting over and over.
+#define TEXT_STORAGE_DECOMMIT_THRESHOLD Megabytes(8)
+#define TEXT_STORAGE_DECOMMIT_SLACK     Megabytes(1)
+
 struct TextStorage
 {
     int64_t count;
@@ -1,6 +1,60 @@
+function ThemeColorIndex
+GetThemeColorIndex(StringID key)
+{
+    ThemePalette *palette = &editor->theme_palette;
+
+    ThemeColorIndex result = 0;
+    for (size_t i = 0; i < THEME_PALETTE_LOOKUP_SIZE; i += 1)
+    {
+        size_t slot_index = (key + i) % THEME_PALETTE_LOOKUP_SIZE;
+        ThemeColorIndex index = palette->lookup[slot_index];
+        if (!index)
+        {
+            break;
+        }
+        if (palette->keys[index] == key)
+        {
+            result = index;
+            break;
+        }
+    }
+    return result;
+}
+
+function ThemeColorIndex
+RegisterThemeColor(StringID key)
+{
+    ThemePalette *palette = &editor->theme_palette;
+
+    ThemeColorIndex result = GetThemeColorIndex(key);
+    if (!result)
+    {
+        Assert(palette->key_count < MAX_THEME_COLORS);
+        result = (ThemeColorIndex)(++palette->key_count);
+        palette->keys[result] = key;
+
+        // NOTE: Until the next compile, a freshly registered key looks the same as a missing one
+        palette->colors[result] = palette->colors[0];
+        palette->styles[result] = palette->styles[0];
+
+        for (size_t i = 0; i < THEME_PALETTE_LOOKUP_SIZE; i += 1)
+        {
+            size_t slot_index = (key + i) % THEME_PALETTE_LOOKUP_SIZE;
+            if (!palette->lookup[slot_index])
+            {
+                palette->lookup[slot_index] = result;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
 function void
 SetThemeColor(Theme *theme, StringID key, Color color, TextStyleFlags style = 0)
 {
+    RegisterThemeColor(key);
+
     for (size_t i = 0; i < MAX_THEME_COLORS; i += 1)
     {
         size_t slot_index = (key + i) % MAX_THEME_COLORS;
@@ -35,31 +89,87 @@ GetThemeColorInternal(Theme *theme, StringID key)
     return result;
 }
 
-function Color
-GetThemeColor(StringID key)
+function void
+CompileLanguageThemeIndices(LanguageSpec *spec)
+{
+    for (size_t i = 0; i < ArrayCount(spec->sub_token_kind_to_theme_index); i += 1)
+    {
+        StringID id = spec->sub_token_kind_to_theme_id[i];
+        spec->sub_token_kind_to_theme_index[i] = (id ? GetThemeColorIndex(id) : 0);
+    }
+
+    for (size_t i = 0; i < ArrayCount(spec->sub_tag_kind_to_theme_index); i += 1)
+    {
+        StringID id = spec->sub_tag_kind_to_theme_id[i];
+        spec->sub_tag_kind_to_theme_index[i] = (id ? GetThemeColorIndex(id) : 0);
+    }
+}
+
+// NOTE: Resolves the active theme into the palette and rebuilds every table that stores palette
+// indices. Needs to happen whenever the theme changes, and after a hot reload since the language
+// specs are registered anew by the fresh dll.
+function void
+CompileThemePalette()
 {
-    Color result = MakeColor(255, 0, 255);
+    ThemePalette *palette = &editor->theme_palette;
+    Theme        *theme   = editor->theme;
+
+    palette->colors[0] = MakeColor(255, 0, 255);
+    palette->styles[0] = 0;
+
+    for (size_t index = 1; index <= palette->key_count; index += 1)
+    {
+        ThemeColor *slot = (theme ? GetThemeColorInternal(theme, palette->keys[index]) : nullptr);
+        palette->colors[index] = (slot ? slot->color : palette->colors[0]);
+        palette->styles[index] = (slot ? slot->style : palette->styles[0]);
+    }
+
+    for (size_t kind = 0; kind < ArrayCount(palette->token_kind_to_theme_index); kind += 1)
+    {
+        palette->token_kind_to_theme_index[kind] = GetThemeColorIndex(GetBaseTokenThemeID((TokenKind)kind));
+    }
+
+    for (size_t kind = 0; kind < ArrayCount(palette->tag_kind_to_theme_index); kind += 1)
+    {
+        StringID id = (kind == Tag_CommentAnnotation ? "text_comment_annotation"_id : "text_foreground"_id);
+        palette->tag_kind_to_theme_index[kind] = GetThemeColorIndex(id);
+    }
 
-    ThemeColor *slot = GetThemeColorInternal(editor->theme, key);
-    if (slot)
+    for (LanguageSpec *spec = language_registry->first_language; spec; spec = spec->next)
     {
-        result = slot->color;
+        CompileLanguageThemeIndices(spec);
     }
 
+    palette->generation += 1;
+}
+
+function Color
+GetThemeColor(StringID key)
+{
+    ThemePalette *palette = &editor->theme_palette;
+    Color result = palette->colors[GetThemeColorIndex(key)];
     return result;
 }
 
 function TextStyleFlags
 GetThemeStyle(StringID key)
 {
-    TextStyleFlags result = 0;
+    ThemePalette *palette = &editor->theme_palette;
+    TextStyleFlags result = palette->styles[GetThemeColorIndex(key)];
+    return result;
+}
 
-    ThemeColor *slot = GetThemeColorInternal(editor->theme, key);
-    if (slot)
-    {
-        result = slot->style;
-    }
+function Color
+GetPaletteColor(ThemeColorIndex index)
+{
+    Color result = editor->theme_palette.colors[index];
+    return result;
+}
 
+function TextStyleFlags
+GetPaletteStyle(ThemeColorIndex index)
+{
+    TextStyleFlags result = editor->theme_palette.styles[index];
     return result;
 }
 
@@ -80,6 +190,7 @@ SetEditorTheme(String name)
         if (AreEqual(name, theme->name, StringMatch_CaseInsensitive))
         {
             editor->theme = theme;
+            CompileThemePalette();
             break;
         }
     }
@@ -204,4 +315,5 @@ LoadDefaultThemes()
     LoadDefaultDarkTheme();
     LoadDefaultLightTheme();
     editor->theme = editor->first_theme;
+    CompileThemePalette();
 }
@@ -16,8 +16,32 @@ struct Theme
     ThemeColor map[MAX_THEME_COLORS];
 };
 
+// NOTE: Every key any theme sets gets a small index the first time it's seen, shared by all themes.
+// The active theme is compiled into flat arrays by that index, so hot code (the styled line builder)
+// can store indices and resolve a color with a plain array read instead of probing the theme's map.
+// Index 0 is reserved for keys nobody has set.
+typedef uint16_t ThemeColorIndex;
+
+#define THEME_PALETTE_LOOKUP_SIZE (2*MAX_THEME_COLORS)
+struct ThemePalette
+{
+    uint32_t generation; // bumped on every compile, for anything that caches resolved colors
+
+    uint32_t key_count;
+    StringID keys[MAX_THEME_COLORS + 1];
+    ThemeColorIndex lookup[THEME_PALETTE_LOOKUP_SIZE];
+
+    Color          colors[MAX_THEME_COLORS + 1];
+    TextStyleFlags styles[MAX_THEME_COLORS + 1];
+
+    ThemeColorIndex token_kind_to_theme_index[256];
+    ThemeColorIndex tag_kind_to_theme_index[256];
+};
+
 function void LoadDefaultTheme();
 function Color GetThemeColor(StringID key);
 function TextStyleFlags GetThemeStyle(StringID key);
+function ThemeColorIndex GetThemeColorIndex(StringID key);
+function void CompileThemePalette();
 
 #endif /* TEXTIT_THEME_HPP */
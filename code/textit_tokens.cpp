@@ -60,6 +60,11 @@ ValidateTokenLocatorIntegrity(TokenLocator locator, bool include_whitespace)
     }
 
     Buffer *buffer = DEBUG_FindWhichBufferThisMemoryBelongsTo(locator.block);
+    if (!buffer)
+    {
+        // NOTE: Scratch buffers, like the ones the project indexer uses, aren't registered with the editor
+        return true;
+    }
 
     LineInfo info;
     FindLineInfoByPos(buffer, locator.pos, &info);
@@ -249,4 +249,37 @@ GetOtherNestTokenKind(TokenKind kind)
     return Token_None;
 }
 
+// NOTE: Each kind of nest has its own depth in the line index, so matching brackets can be found
+// by descending the tree instead of walking every token in between
+enum NestKind
+{
+    NestKind_None = -1,
+    NestKind_Paren,
+    NestKind_Scope,
+    NestKind_Bracket,
+    NestKind_COUNT,
+};
+
+function NestKind
+GetNestKind(TokenKind t)
+{
+    switch (t)
+    {
+        case Token_LeftParen:  case Token_RightParen: return NestKind_Paren;
+        case Token_LeftScope:  case Token_RightScope: return NestKind_Scope;
+        case '{':              case '}':              return NestKind_Scope;
+        case '[':              case ']':              return NestKind_Bracket;
+        INCOMPLETE_SWITCH;
+    }
+    return NestKind_None;
+}
+
+function int
+GetNestDelta(const Token *t, NestKind kind)
+{
+    if (t->flags & (TokenFlag_IsComment|TokenFlag_PartOfString)) return 0;
+    if (GetNestKind(t->kind) != kind)                            return 0;
+    return (IsNestOpener(t->kind) ? 1 : -1);
+}
+
 #endif /* TEXTIT_TOKENS_HPP */
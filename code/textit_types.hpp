@@ -7,6 +7,8 @@
 
 #include "textit_math_types.hpp"
 
+struct PlatformMemoryStats;
+
 struct Arena
 {
     size_t capacity;
@@ -14,6 +16,11 @@ struct Arena
     size_t used;
     char *base;
     uint32_t temp_count;
+    const char *tag;
+    PlatformMemoryStats *stats;
+
+    uint32_t idle_resets;
+    size_t recent_peak;
 };
 
 struct String
@@ -35,7 +42,7 @@ struct String
     }
 };
 
-constexpr String
+function String
 operator ""_str(const char *data, size_t size)
 {
     String result = {};
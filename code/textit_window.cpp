@@ -222,6 +222,7 @@ DrawWindows(Window *window)
             estimated_viewport_line_height = Max(0, view->viewport.max.y - view->viewport.min.y - 1);
         }
 
+        if (IsBufferLoaded(buffer, BufferLoad_Tokenized))
         {
             int64_t top = Max(0, view->scroll_at + core_config->view_autoscroll_margin);
             int64_t bot = Max(0, view->scroll_at + estimated_viewport_line_height - 2 - core_config->view_autoscroll_margin);
@@ -1,5 +1,6 @@
 #include "win32_textit.hpp"
 #include "textit_string.cpp"
+#include "textit_jobs.cpp"
 
 #include <d3d11_1.h>
 #include <d3dcompiler.h>
@@ -141,7 +142,11 @@ Win32_Reserve(size_t size, uint32_t flags, const char *tag)
     header->size = total_size;
     header->base = (char *)header + page_size;
     header->flags = flags;
-    header->tag = tag;
+
+    // NOTE: The tag is copied because it may live in the app dll, which gets hot reloaded away
+    snprintf(header->tag, sizeof(header->tag), "%s", tag);
+    header->stats.tag      = header->tag;
+    header->stats.reserved = size;
 
     BeginTicketMutex(&win32_state.allocation_mutex);
     header->next = &win32_state.allocation_sentinel;
@@ -167,6 +172,10 @@ Win32_Allocate(size_t Size, uint32_t Flags, const char *Tag)
     if (Result)
     {
         Result = Win32_Commit(Result, Size);
+
+        Win32AllocationHeader *Header = (Win32AllocationHeader *)((char *)Result - platform->page_size);
+        Header->stats.committed = Size;
+        Header->stats.used      = Size;
     }
     return Result;
 }
@@ -194,6 +203,41 @@ Win32_Deallocate(void *pointer)
     }
 }
 
+static PlatformMemoryStats *
+Win32_GetMemoryStats(void *pointer)
+{
+    Win32AllocationHeader *header = (Win32AllocationHeader *)((char *)pointer - platform->page_size);
+    return &header->stats;
+}
+
+static size_t
+Win32_GatherMemoryStats(size_t max_count, PlatformMemoryStats *out_stats)
+{
+    size_t count = 0;
+
+    BeginTicketMutex(&win32_state.allocation_mutex);
+
+    for (Win32AllocationHeader *header = win32_state.allocation_sentinel.next;
+         header != &win32_state.allocation_sentinel;
+         header = header->next)
+    {
+        if (count < max_count) out_stats[count] = header->stats;
+        count += 1;
+    }
+
+    for (Win32Heap *heap = win32_state.heap_sentinel.next;
+         heap != &win32_state.heap_sentinel;
+         heap = heap->next)
+    {
+        if (count < max_count) out_stats[count] = heap->stats;
+        count += 1;
+    }
+
+    EndTicketMutex(&win32_state.allocation_mutex);
+
+    return count;
+}
+
 function wchar_t *
 Win32_FormatError(HRESULT error)
 {
@@ -1474,7 +1518,7 @@ Win32_GetLastWriteTime(wchar_t *path)
 
      ULARGE_INTEGER thanks;
      thanks.LowPart  = last_write_time.dwLowDateTime;
-     thanks.HighPart = last_write_time.dwLowDateTime;
+     thanks.HighPart = last_write_time.dwHighDateTime;
 
     return thanks.QuadPart;
 }
@@ -1548,6 +1592,9 @@ Win32_InitializeTLSForThread(ThreadLocalContext *context)
 
     SetCapacity(context->temp_arena, Megabytes(4));
     SetCapacity(context->prev_temp_arena, Megabytes(4));
+    const char *temp_arena_tag = LOCATION_STRING("Thread Temp Arena");
+    SetTag(context->temp_arena, temp_arena_tag);
+    SetTag(context->prev_temp_arena, temp_arena_tag);
 }
 
 static ThreadLocalContext *
@@ -1587,7 +1634,7 @@ Win32_GetTempArena(void)
 struct Win32JobThreadParams
 {
     ThreadLocalContext *context;
-    PlatformJobQueue *queue;
+    JobWorker *worker;
     HANDLE ready;
 };
 
@@ -1597,44 +1644,10 @@ Win32_JobThreadProc(LPVOID userdata)
     Win32JobThreadParams *params = (Win32JobThreadParams *)userdata;
 
     Win32_InitializeTLSForThread(params->context);
-    PlatformJobQueue *queue = params->queue;
+    JobWorker *worker = params->worker;
     SetEvent(params->ready);
 
-    for (;;)
-    {
-        uint32_t entry_index = queue->next_read;
-        if (entry_index != queue->next_write)
-        {
-            uint32_t next_entry_index = entry_index + 1;
-            uint32_t exchanged_index = InterlockedCompareExchange(&queue->next_read, next_entry_index, entry_index);
-
-            if (entry_index == exchanged_index)
-            {
-                // TODO: Double buffered temp arenas are less useful in this context, not sure what the right design is,
-                // not that important for now though.
-                ThreadLocalContext *context = platform->GetThreadLocalContext();
-                Swap(context->temp_arena, context->prev_temp_arena);
-                Clear(context->temp_arena);
-
-                PlatformJobEntry *job = &queue->jobs[entry_index % ArrayCount(queue->jobs)];
-                job->proc(job->params);
-
-                uint32_t jobs_count = InterlockedDecrement(&queue->jobs_in_flight);
-                if (jobs_count == 0)
-                {
-                    SetEvent(queue->done);
-                }
-            }
-        }
-        else
-        {
-            HANDLE handles[] = { queue->stop, queue->run };
-            if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0)
-            {
-                break;
-            }
-        }
-    }
+    RunJobWorker(worker);
 
     Win32_DestroyThreadLocalContext();
 
@@ -1642,29 +1655,31 @@ Win32_JobThreadProc(LPVOID userdata)
 }
 
 static void
-Win32_InitializeJobQueue(PlatformJobQueue *queue, int thread_count)
+Win32_InitializeJobScheduler(uint32_t thread_count)
 {
-    queue->stop = CreateEventA(NULL, TRUE, FALSE, NULL);
-    queue->done = CreateEventA(NULL, TRUE, TRUE, NULL);
-    queue->run = CreateSemaphoreA(NULL, 0, thread_count, NULL);
-
-    queue->tls = PushArray(&win32_state.arena, thread_count, ThreadLocalContext);
+    JobScheduler *scheduler = &win32_state.job_scheduler;
+    InitializeJobScheduler(scheduler, &win32_state.arena, thread_count);
 
-    queue->thread_count = thread_count;
-    queue->threads = PushArray(&win32_state.arena, thread_count, HANDLE);
+    thread_count = scheduler->worker_count - 1;
+    win32_state.job_thread_count    = thread_count;
+    win32_state.job_threads         = PushArray(&win32_state.arena, thread_count, HANDLE);
+    win32_state.job_thread_contexts = PushArray(&win32_state.arena, thread_count, ThreadLocalContext);
 
     HANDLE ready = CreateEventA(NULL, FALSE, FALSE, NULL);
-    for (int i = 0; i < thread_count; ++i)
+    for (uint32_t i = 0; i < thread_count; i += 1)
     {
         Win32JobThreadParams params = {};
-        params.context = &queue->tls[i];
-        params.queue = queue;
-        params.ready = ready;
+        params.context = &win32_state.job_thread_contexts[i];
+        params.worker  = &scheduler->workers[i + 1];
+        params.ready   = ready;
 
-        queue->threads[i] = CreateThread(NULL, 0, Win32_JobThreadProc, &params, 0, NULL);
+        win32_state.job_threads[i] = CreateThread(NULL, 0, Win32_JobThreadProc, &params, 0, NULL);
         WaitForSingleObject(ready, INFINITE);
     }
     CloseHandle(ready);
+
+    platform->high_priority_queue = &scheduler->queues[JobPriority_High];
+    platform->low_priority_queue  = &scheduler->queues[JobPriority_Low];
 }
 
 static void
@@ -1674,45 +1689,18 @@ Win32_SleepThread(int milliseconds)
 }
 
 static void
-Win32_AddJob(PlatformJobQueue *queue, void *params, PlatformJobProc *proc)
+Win32_CloseJobScheduler(void)
 {
-    uint32_t new_next_write = queue->next_write + 1;
-
-    PlatformJobEntry *entry = &queue->jobs[queue->next_write % ArrayCount(queue->jobs)];
-    entry->proc = proc;
-    entry->params = params;
-
-    MemoryBarrier();
+    JobScheduler *scheduler = &win32_state.job_scheduler;
+    StopJobScheduler(scheduler);
 
-    queue->next_write = new_next_write;
-
-    InterlockedIncrement(&queue->jobs_in_flight);
-    ResetEvent(queue->done);
-
-    ReleaseSemaphore(queue->run, 1, NULL);
-}
-
-static void
-Win32_WaitForJobs(PlatformJobQueue *queue)
-{
-    if (queue->jobs_in_flight > 0)
+    for (uint32_t i = 0; i < win32_state.job_thread_count; i += 1)
     {
-        WaitForSingleObject(queue->done, INFINITE);
+        WaitForSingleObject(win32_state.job_threads[i], INFINITE);
+        CloseHandle(win32_state.job_threads[i]);
     }
-}
 
-static void
-Win32_CloseJobQueue(PlatformJobQueue *queue)
-{
-    SetEvent(queue->stop);
-    for (int i = 0; i < queue->thread_count; ++i)
-    {
-        WaitForSingleObject(queue->threads[i], INFINITE);
-        CloseHandle(queue->threads[i]);
-    }
-    CloseHandle(queue->stop);
-    CloseHandle(queue->run);
-    CloseHandle(queue->done);
+    ReleaseJobScheduler(scheduler);
 }
 
 static uint8_t codepage_437_utf8[] =
@@ -2156,45 +2144,97 @@ Win32_GetExeDirectory()
     return win32_state.exe_folder_utf8;
 }
 
+// NOTE: Heaps are wrapped so they can be tagged and counted. HeapSize is what we count, because the
+// OS heap doesn't cheaply tell us what it has committed.
+
 static Heap *
-Win32_CreateHeap(size_t initial_size, size_t max_size)
+Win32_CreateHeap(size_t initial_size, size_t max_size, const char *tag)
 {
-    Heap *result = (Heap *)HeapCreate(HEAP_NO_SERIALIZE, initial_size, max_size);
+    Win32Heap *heap = (Win32Heap *)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(Win32Heap));
+    heap->handle = HeapCreate(HEAP_NO_SERIALIZE, initial_size, max_size);
+
+    snprintf(heap->tag, sizeof(heap->tag), "%s", tag);
+    heap->stats.tag     = heap->tag;
+    heap->stats.is_heap = true;
+
+    BeginTicketMutex(&win32_state.allocation_mutex);
+    DllInsertBack(&win32_state.heap_sentinel, heap);
+    EndTicketMutex(&win32_state.allocation_mutex);
+
+    Heap *result = (Heap *)heap;
     return result;
 };
 
 static void
-Win32_DestroyHeap(Heap *heap)
+Win32_DestroyHeap(Heap *heap_)
 {
-    BOOL result = HeapDestroy((HANDLE)heap);
+    Win32Heap *heap = (Win32Heap *)heap_;
+
+    BOOL result = HeapDestroy(heap->handle);
     Assert(result);
+
+    BeginTicketMutex(&win32_state.allocation_mutex);
+    DllRemove(heap);
+    EndTicketMutex(&win32_state.allocation_mutex);
+
+    HeapFree(GetProcessHeap(), 0, heap);
 }
 
 static void *
-Win32_HeapAlloc(Heap *heap, size_t size)
+Win32_HeapAlloc(Heap *heap_, size_t size)
 {
-    void *result = HeapAlloc((HANDLE)heap, NULL, size);
+    Win32Heap *heap = (Win32Heap *)heap_;
+
+    void *result = HeapAlloc(heap->handle, NULL, size);
+    if (result)
+    {
+        heap->stats.used      += HeapSize(heap->handle, NULL, result);
+        heap->stats.committed  = heap->stats.used;
+    }
     return result;
 }
 
 static size_t
-Win32_HeapGetAllocSize(Heap *heap, void *data)
+Win32_HeapGetAllocSize(Heap *heap_, void *data)
 {
-    size_t result = HeapSize((HANDLE)heap, NULL, data);
+    Win32Heap *heap = (Win32Heap *)heap_;
+
+    size_t result = HeapSize(heap->handle, NULL, data);
     return result;
 }
 
 static void *
-Win32_HeapReAlloc(Heap *heap, void *data, size_t size)
+Win32_HeapReAlloc(Heap *heap_, void *data, size_t size)
 {
-    void *result = HeapReAlloc((HANDLE)heap, NULL, data, size);
+    Win32Heap *heap = (Win32Heap *)heap_;
+
+    void *result = nullptr;
+    if (!data)
+    {
+        result = Win32_HeapAlloc(heap_, size);
+    }
+    else
+    {
+        size_t old_size = HeapSize(heap->handle, NULL, data);
+        result = HeapReAlloc(heap->handle, NULL, data, size);
+        if (result)
+        {
+            heap->stats.used      += HeapSize(heap->handle, NULL, result) - old_size;
+            heap->stats.committed  = heap->stats.used;
+        }
+    }
     return result;
 }
 
 static void
-Win32_HeapFree(Heap *heap, void *data)
+Win32_HeapFree(Heap *heap_, void *data)
 {
-    BOOL result = HeapFree((HANDLE)heap, NULL, data);
+    Win32Heap *heap = (Win32Heap *)heap_;
+
+    heap->stats.used      -= HeapSize(heap->handle, NULL, data);
+    heap->stats.committed  = heap->stats.used;
+
+    BOOL result = HeapFree(heap->handle, NULL, data);
     Assert(result);
 }
 
@@ -2208,6 +2248,8 @@ Win32_AppThread(LPVOID userdata)
     ThreadLocalContext tls_context = {};
     Win32_InitializeTLSForThread(&tls_context);
 
+    AttachJobSchedulerThread(&win32_state.job_scheduler);
+
     win32_state.exe_folder = FindExeFolderLikeAMonkeyInAMonkeySuit();
     win32_state.dll_path   = FormatWString(&win32_state.arena, L"\\\\?\\%s\\textit.dll", win32_state.exe_folder);
 
@@ -2337,6 +2379,7 @@ Win32_AppThread(LPVOID userdata)
             }
         }
         PlatformHighResTime post_vsync_time = Win32_GetTime();
+        platform->present_time = post_vsync_time;
         double vsync_wait = Win32_SecondsElapsed(pre_vsync_time, post_vsync_time);
 
         if (win32_state.late_latching &&
@@ -2455,9 +2498,8 @@ main(int, char **)
 
     win32_state.allocation_sentinel.next = &win32_state.allocation_sentinel;
     win32_state.allocation_sentinel.prev = &win32_state.allocation_sentinel;
+    DllInit(&win32_state.heap_sentinel);
 
-    PlatformJobQueue high_priority_queue = {};
-    PlatformJobQueue  low_priority_queue = {};
 
     win32_state.late_latching = false;
 
@@ -2472,8 +2514,6 @@ main(int, char **)
     platform->GetNextLogLine         = Win32_GetNextLogLine;
     platform->GetPrevLogLine         = Win32_GetPrevLogLine;
 
-    platform->high_priority_queue    = &high_priority_queue;
-    platform->low_priority_queue     = &low_priority_queue;
 
     platform->page_size              = system_info.dwPageSize;
     platform->allocation_granularity = system_info.dwAllocationGranularity;
@@ -2483,6 +2523,8 @@ main(int, char **)
     platform->CommitMemory           = Win32_Commit;
     platform->DecommitMemory         = Win32_Decommit;
     platform->DeallocateMemory       = Win32_Deallocate;
+    platform->GetMemoryStats         = Win32_GetMemoryStats;
+    platform->GatherMemoryStats      = Win32_GatherMemoryStats;
 
     platform->CreateHeap             = Win32_CreateHeap;
     platform->DestroyHeap            = Win32_DestroyHeap;
@@ -2508,8 +2550,11 @@ main(int, char **)
     platform->GetThreadLocalContext  = Win32_GetThreadLocalContext;
     platform->GetTempArena           = Win32_GetTempArena;
 
-    platform->AddJob                 = Win32_AddJob;
-    platform->WaitForJobs            = Win32_WaitForJobs;
+    platform->AddJob                 = Jobs_AddJob;
+    platform->WaitForJobs            = Jobs_WaitForJobs;
+    platform->AddJobToGroup          = Jobs_AddJobToGroup;
+    platform->AddJobAfter            = Jobs_AddJobAfter;
+    platform->WaitForJobGroup        = Jobs_WaitForJobGroup;
 
     platform->GetExeDirectory        = Win32_GetExeDirectory;
     platform->SetWorkingDirectory    = Win32_SetWorkingDirectory;
@@ -2545,8 +2590,9 @@ main(int, char **)
     ThreadLocalContext tls_context = {};
     Win32_InitializeTLSForThread(&tls_context);
 
-    Win32_InitializeJobQueue(&high_priority_queue, 8);
-    Win32_InitializeJobQueue(&low_priority_queue, 4);
+    // NOTE: One worker per core, the app thread being workers[0] and the job threads the rest
+    DWORD core_count = system_info.dwNumberOfProcessors;
+    Win32_InitializeJobScheduler(core_count > 3 ? core_count - 1 : 2);
 
     platform->window_resize_snap_w = 1;
     platform->window_resize_snap_h = 1;
@@ -2761,8 +2807,7 @@ main(int, char **)
         }
     }
 
-    Win32_CloseJobQueue(platform->high_priority_queue);
-    Win32_CloseJobQueue(platform->low_priority_queue);
+    Win32_CloseJobScheduler();
 
     if (!g_use_d3d)
     {
@@ -2776,7 +2821,7 @@ main(int, char **)
     {
         Win32_DebugPrint("Allocated Block, Size: %llu, Tag: %s, NoLeakCheck: %s\n",
                          header->size,
-                         header->tag,
+                         header->stats.tag,
                          (header->flags & PlatformMemFlag_NoLeakCheck ? "true" : "false"));
         if (!(header->flags & PlatformMemFlag_NoLeakCheck))
         {
@@ -13,6 +13,7 @@
 #include "textit_memory.hpp"
 #include "textit_string.hpp"
 #include "textit_math.hpp"
+#include "textit_jobs.hpp"
 
 struct Win32AllocationHeader
 {
@@ -20,7 +21,16 @@ struct Win32AllocationHeader
     size_t size;
     char *base;
     uint32_t flags;
-    const char *tag;
+    PlatformMemoryStats stats;
+    char tag[PLATFORM_MEMORY_TAG_SIZE];
+};
+
+struct Win32Heap
+{
+    Win32Heap *next, *prev;
+    HANDLE handle;
+    PlatformMemoryStats stats;
+    char tag[PLATFORM_MEMORY_TAG_SIZE];
 };
 
 struct Win32AppCode
@@ -33,30 +43,6 @@ struct Win32AppCode
     AppUpdateAndRenderType *UpdateAndRender;
 };
 
-struct PlatformJobEntry
-{
-    PlatformJobProc *proc;
-    void *params;
-};
-
-struct PlatformJobQueue
-{
-    HANDLE stop;
-    HANDLE done;
-    HANDLE run;
-
-    int thread_count;
-    HANDLE *threads;
-    ThreadLocalContext *tls;
-
-    volatile uint32_t jobs_in_flight;
-    volatile uint32_t next_write;
-    volatile uint32_t next_read;
-    PlatformJobEntry jobs[256];
-
-    StaticAssert(IsPow2(ArrayCount(jobs)), "Jobs array must be a power of 2");
-};
-
 struct ThreadLocalContext
 {
     ThreadLocalContext *next;
@@ -95,8 +81,14 @@ struct Win32State
 
     DWORD thread_local_index;
 
+    JobScheduler job_scheduler;
+    uint32_t job_thread_count;
+    HANDLE *job_threads;
+    ThreadLocalContext *job_thread_contexts;
+
     TicketMutex allocation_mutex;
     Win32AllocationHeader allocation_sentinel;
+    Win32Heap heap_sentinel;
 
     TicketMutex log_mutex;
     int log_line_count;